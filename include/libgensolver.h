@@ -62,6 +62,7 @@ namespace GenFloat
 
 		public:
 			double randFunction( double minRand, double maxRand );
+			double randFunction( double minRand, double maxRand, RandStream &stream );
 
 	};
 
@@ -92,6 +93,7 @@ namespace GenInt
 	{
 		public:
 			int randFunction( int minRand, int maxRand );
+			int randFunction( int minRand, int maxRand, RandStream &stream );
 	};
 
 	class GenerationClass : public GenBase::GenerationClass<int,ChromosomeClass>
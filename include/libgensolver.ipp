@@ -78,6 +78,7 @@
  *       {
  *               public:
  *                       int randFunction(int minRand, int maxRand);
+ *                       int randFunction(int minRand, int maxRand, RandStream &stream);
  *       };
  *
  *       class GenerationClass : public GenBase::GenerationClass<ChromosomeClass>
@@ -98,6 +99,12 @@
  *       {
  *               return randInt(minRand,maxRand );
  *       }
+ *
+ *       // used by the breeding threads, must not call rand()
+ *       int ChromosomeClass::randFunction(int minRand, int maxRand, RandStream &stream )
+ *       {
+ *               return stream.randInt(minRand,maxRand );
+ *       }
  * }
  
  * //-----------------------------------------------------------------------------
@@ -179,9 +186,18 @@
 #include <vector>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <climits>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <librand.h>
 #include <genutil.h>
+#include <libtextreader.h>
 
 using namespace std;
 
@@ -250,6 +266,57 @@ namespace GenBase
 			 */
 			void setFitness( double value );
 
+			/**
+			 *                      Returns true if setFitness() has been called since the
+			 *			last call of invalidateFitness().
+			 */
+			const bool evaluated() const;
+
+			/**
+			 *                      Resets the fitness and the objective values.
+			 *
+			 *			Called by PopulationClass::createNewGeneration() for each new
+			 *			chromosome, as its fitness is not known yet.
+			 */
+			void invalidateFitness();
+
+			//Multi-objective fitness
+			/**
+			 *                      Sets the objective values of the chromosome.
+			 *
+			 *			Only used if multi-objective optimization is enabled (see
+			 *			PopulationClass::enableMultiObjective()). All objectives are
+			 *			maximized, i.e. higher values are better (as with fitness()).
+			 * @param values 	The objective values.
+			 */
+			void setObjectives( const vector <double> &values );
+
+			/**
+			 *                      Returns the objective values of the chromosome.
+			 */
+			const vector <double>& objectives() const;
+
+			/**
+			 *                      Returns true if this chromosome dominates the specified one.
+			 *
+			 *			A chromosome dominates another one if it is not worse in all
+			 *			objectives and better in at least one objective.
+			 * @param other 	The chromosome to compare with.
+			 */
+			bool dominates( const ChromosomeClass<T> &other ) const;
+
+			/**
+			 *                      Returns the index of the non-dominated front (0 is the pareto front).
+			 */
+			const unsigned int paretoRank() const;
+			void setParetoRank( unsigned int value );
+
+			/**
+			 *                      Returns the crowding distance inside of the front.
+			 */
+			const double crowdingDistance() const;
+			void setCrowdingDistance( double value );
+
 			/**
 			 * 			Prints the chromosome vector.
 			 *
@@ -288,6 +355,19 @@ namespace GenBase
 			 */
 			void mutate( unsigned int i , T minRandValue, T maxRandValue );
 
+			/**
+			 *                      Randomly changes a bit of the chromosome.
+			 *
+			 *			Behaves like the above method, except that the random value is
+			 *			taken from the specified stream instead of rand(). This version is
+			 *			used by PopulationClass::createNewGeneration().
+			 * @param i 		The bit index.
+			 * @param minRandValue 	Minimum random value.
+			 * @param maxRandValue 	Maximum random value.
+			 * @param stream 	The random stream.
+			 */
+			void mutate( unsigned int i , T minRandValue, T maxRandValue, RandStream &stream );
+
 			const unsigned int numberOfGenes() const;
 			
 			//Variables
@@ -324,10 +404,31 @@ namespace GenBase
 			 */
 			virtual T randFunction( T minRand, T maxRand );
 
+			/**
+			 *			Random function.
+			 *
+			 *                      This function is the random function that will be used by the
+			 * 			stream based mutate() function, i.e. by the breeding threads
+			 *			(see PopulationClass::setNumberOfThreads()). The default
+			 *			implementation calls the method above, inside of a parallel
+			 *			region one thread at a time. Then the values depend on the order
+			 *			of the threads, i.e. derived classes that breed with more than one
+			 *			thread should override this method as well and only use the
+			 *			stream (no rand()), like GenInt and GenFloat.
+			 * @param minRand	Minimum random value.
+			 * @param maxRand	Maximum random value.
+			 * @param stream	The random stream.
+			 * @return		The random value.
+			 */
+			virtual T randFunction( T minRand, T maxRand, RandStream &stream );
+
 			//Variables
 			double _fitness;
+			bool _evaluated;
 
-
+			vector <double> _objectives;
+			unsigned int _paretoRank;
+			double _crowdingDistance;
 	};
 
 
@@ -421,7 +522,17 @@ namespace GenBase
 			/**
 			 *                      Loads a generation from file.
 			 *
-			 *			This function can be used to load a generation stored in a text file.
+			 *			This function can be used to load a generation stored in a text file:
+			 * @code
+			 * <header> GenSolver-File 0.1 </header>
+			 * <data>
+			 * <chromosome> 1 0 1 1 </chromosome>
+			 * <chromosome> 0 0 1 </chromosome>
+			 * </data>
+			 * @endcode
+			 *			The file is parsed in one pass (see TextReader). Each chromosome
+			 *			consists of one sub gene. The generation is replaced by the
+			 *			chromosomes of the file, it is not changed if the file is invalid.
 			 * @param fileName 	Filename with path.
 			 * @return 		Returns true if loading was successful and false otherwise.
 			 */
@@ -429,8 +540,8 @@ namespace GenBase
 
 
 		private:
-			bool readHeaderSection( ifstream &f, vector <string> &headerList );
-			bool readDataSection( ifstream &f, vector <string> &dataList );
+			bool readHeaderSection( TextReader &reader );
+			bool readDataSection( TextReader &reader, vector <ChromosomeTemplate*> &chromosomes );
 	};
 
 	/**
@@ -444,6 +555,8 @@ namespace GenBase
 	class PopulationClass
 	{
 		public:
+			typedef ChromosomeTemplate chromosome_type;
+
 			//Initialization
 			PopulationClass();
 			virtual ~PopulationClass();
@@ -558,6 +671,48 @@ namespace GenBase
 			 * @param value 
 			 */
 			void enableCloneParents( bool value );
+
+			/**
+			 *                      Sets the number of threads used by createNewGeneration().
+			 *
+			 *			Breeding is parallelized over child pairs if the library has been
+			 *			compiled with OpenMP support. Each pair uses its own random stream
+			 *			that is derived from #srandValue, the generation and the pair index.
+			 *			Therefore the result does not depend on the number of threads.
+			 *
+			 *			By default only one thread is used. More threads require that
+			 *			overrides of mutate() and ChromosomeClass::randFunction() are
+			 *			thread safe, i.e. they must use the random stream instead of rand().
+			 *			Chromosome classes that only override randFunction( minRand, maxRand )
+			 *			still get their distribution, but the calls are serialized and their
+			 *			order depends on the threads (see ChromosomeClass::randFunction()).
+			 * @param value 	Number of threads (0 means: let OpenMP decide, default 1).
+			 */
+			void setNumberOfThreads( unsigned int value );
+
+			/**
+			 *                      Enables multi-objective optimization (NSGA-II).
+			 *
+			 *			If enabled, the fitness function has to assign a vector of objective
+			 *			values to each chromosome (see ChromosomeClass::setObjectives()).
+			 *			Instead of fitness proportional selection, parents are chosen by
+			 *			binary tournaments that compare pareto rank and crowding distance.
+			 *			The evaluated generation and the survivors of the previous generation
+			 *			are merged and the best chromosomes survive (elitism).
+			 * @param value 
+			 */
+			void enableMultiObjective( bool value );
+
+			/**
+			 *                      Returns the non-dominated chromosomes found so far.
+			 *
+			 *			Ranks the survivors together with the chromosomes of #newGeneration
+			 *			that have objective values, i.e. a generation that was stopped by the
+			 *			time or evaluation budget (see GenSolver::startSolvingTime()) is
+			 *			included. Only useful if multi-objective optimization is enabled.
+			 * @return 		Pointers to all chromosomes of the pareto front.
+			 */
+			vector <const ChromosomeTemplate*> paretoFront();
 			//Variables
 			GenerationTemplate *newGeneration;
 
@@ -593,6 +748,70 @@ namespace GenBase
 			 */
 			const unsigned int grabChromosome( const GenerationTemplate& generation );
 
+			/**
+			 * 			Returns the index of a randomly (chance dependant on its fitness) chosen chromosome.
+			 *
+			 *			Behaves like the above method but uses the selection table created by
+			 *			buildSelectionTable() and the specified random stream. The selection
+			 *			table is only read. Therefore this method may be called concurrently.
+			 *			Complexity is O(log n) instead of O(n).
+			 * @param stream 	The random stream.
+			 * @return 		Index of the chosen chromosome.
+			 */
+			const unsigned int grabChromosome( RandStream &stream ) const;
+
+			/**
+			 *			Creates the selection table for grabChromosome().
+			 *
+			 *			Stores the accumulated fitness values of all chromosomes of the
+			 *			specified generation in #cumulativeFitness.
+			 * @param generation	The generation of that the chromosomes shall be chosen.
+			 */
+			void buildSelectionTable( const GenerationTemplate& generation );
+
+			/**
+			 *			Non-dominated sorting.
+			 *
+			 *			Assigns pareto rank and crowding distance to all specified chromosomes.
+			 *			The chromosomes are sorted lexicographically and each one is inserted
+			 *			into the first front that does not dominate it (binary search over the
+			 *			fronts). For two objectives only the last member of a front has to be
+			 *			checked, which gives O(n log n). For more objectives the members of the
+			 *			front are checked in reverse order.
+			 * @param pool		The chromosomes (will be reordered).
+			 */
+			void sortNonDominated( vector <ChromosomeTemplate*> &pool ) const;
+
+			/**
+			 *			Assigns the crowding distance to all chromosomes of a front.
+			 * @param front		Chromosomes of one non-dominated front.
+			 */
+			void assignCrowdingDistance( vector <ChromosomeTemplate*> &front ) const;
+
+			/**
+			 *			NSGA-II survivor selection.
+			 *
+			 *			Merges #eliteGeneration and #oldGeneration, ranks all chromosomes and
+			 *			keeps the best half in #eliteGeneration. Only the pointers are
+			 *			exchanged, chromosomes are not copied.
+			 */
+			void selectSurvivors();
+
+			/**
+			 *			Crowded comparison operator.
+			 *
+			 * @return		True if a has a lower rank than b or the same rank and a
+			 *			higher crowding distance.
+			 */
+			static bool crowdedGreater( const ChromosomeTemplate* a, const ChromosomeTemplate* b );
+
+			/**
+			 *			Lexicographic comparison of the objectives.
+			 *
+			 * @return		True if the objectives of a are lexicographically greater.
+			 */
+			static bool objectivesGreater( const ChromosomeTemplate* a, const ChromosomeTemplate* b );
+
 			/**
 			 *                      Selects two parents for crossOver() method.
 			 *
@@ -602,6 +821,17 @@ namespace GenBase
 			 */
 			void selectParents( const GenerationTemplate& generation );
 
+			/**
+			 *                      Selects two parents.
+			 *
+			 *			Reentrant version of the above method. It does not touch #parent1 and
+			 *			#parent2 but returns the indices of the chosen chromosomes.
+			 * @param stream	The random stream.
+			 * @param index1	Index of the first parent.
+			 * @param index2	Index of the second parent.
+			 */
+			void selectParents( RandStream &stream, unsigned int &index1, unsigned int &index2 ) const;
+
 			/**
 			 * 			Creates two babies from two parents.
 			 *
@@ -633,21 +863,56 @@ namespace GenBase
 			void crossOver( const GenerationTemplate& generation, ChromosomeTemplate& baby1,
 			                ChromosomeTemplate& baby2 );
 
+			/**
+			 * 			Creates two babies from two parents.
+			 *
+			 *			Behaves like the above method, except that the parents are specified
+			 *			directly and that the random values are taken from the specified stream.
+			 *			This method is reentrant. It is used by createNewGeneration() and can be
+			 *			overridden for chromosomes with a special structure (see NetSolver).
+			 * @param p1	 	First parent.
+			 * @param p2	 	Second parent.
+			 * @param baby1 	First baby.
+			 * @param baby2 	Second baby.
+			 * @param stream 	The random stream.
+			 */
+			virtual void crossOver( const ChromosomeTemplate& p1, const ChromosomeTemplate& p2,
+			                        ChromosomeTemplate& baby1, ChromosomeTemplate& baby2, RandStream &stream ) const;
+
 			/**
 			 * 			Mutates a chromosome depending on #mutationRate.
 			 *
-			 *			It calls ChromosomeClass::mutate().
+			 *			It calls ChromosomeClass::mutate(). createNewGeneration() calls
+			 *			this method (through the method below), i.e. overrides are used
+			 *			by the breeding threads (see setNumberOfThreads()). If it is
+			 *			called by the stream based method below, the default implementation
+			 *			takes the random values from that stream. An override that calls
+			 *			rand() is only safe and deterministic with one thread.
 			 * @param chromosome 	The chromosome that shall be mutated.
 			 */
 			virtual void mutate( ChromosomeTemplate* chromosome );
 
+			/**
+			 * 			Mutates a chromosome depending on #mutationRate.
+			 *
+			 *			Reentrant version of the above method that is used by
+			 *			createNewGeneration(). The default implementation makes stream
+			 *			the random stream of the calling thread and calls the above
+			 *			method, so overrides of either method are used.
+			 * @param chromosome 	The chromosome that shall be mutated.
+			 * @param stream 	The random stream.
+			 */
+			virtual void mutate( ChromosomeTemplate* chromosome, RandStream &stream );
+
 			/**
 			 * 			Creates a new generation.
 			 *
 			 *			To create a new generation it calls crossOver() until a hole new generation
-			 *			is created. The size of a generation is constant.
+			 *			is created. The size of a generation is constant. Child pairs are
+			 *			created in parallel (see setNumberOfThreads()). Derived classes may
+			 *			override it to finish the new generation serially.
 			 */
-			void createNewGeneration();
+			virtual void createNewGeneration();
 
 			//Variables
 			bool initialized;
@@ -700,6 +965,79 @@ namespace GenBase
 			const ChromosomeTemplate *parent2;
 
 			GenerationTemplate *oldGeneration;
+
+			/**
+			 *			Accumulated fitness values of #oldGeneration (see buildSelectionTable()).
+			 */
+			vector <long double> cumulativeFitness;
+
+			/**
+			 *			Number of threads used by createNewGeneration().
+			 */
+			unsigned int numberOfThreads;
+
+			/**
+			 *			Master stream, provides one seed per generation.
+			 */
+			RandStream breedStream;
+
+			/**
+			 *			Random stream of the mutation of each thread (see mutate()).
+			 */
+			vector <RandStream*> mutationStreams;
+
+			/**
+			 *			Entry of mutationStreams of the calling thread (NULL if there is none).
+			 */
+			RandStream **mutationStream();
+
+			/**
+			 *			Generation used by grabChromosome() (see buildSelectionTable()).
+			 */
+			const GenerationTemplate *selectionGeneration;
+
+			/**
+			 *			multiObjective
+			 */
+			bool multiObjective;
+
+			/**
+			 *			Survivors of the multi-objective optimization.
+			 */
+			GenerationTemplate *eliteGeneration;
+	};
+
+	/**
+	 * Interface for surrogate models (approximated fitness functions).
+	 *
+	 * A surrogate is trained with chromosomes that have already been evaluated by
+	 * the real fitness function and predicts the fitness of new chromosomes.
+	 * It is used by GenSolver::setSurrogate() to pre-screen offspring.
+	 */
+	template <typename T>
+	class Surrogate
+	{
+		public:
+			virtual ~Surrogate() {}
+
+			/**
+			 *			Adds a training sample.
+			 * @param genes		The chromosome.
+			 * @param fitness	Its real fitness.
+			 */
+			virtual void addSample( const vector <T> &genes, double fitness ) = 0;
+
+			/**
+			 *			Trains the model with all samples added so far.
+			 */
+			virtual void train() = 0;
+
+			/**
+			 *			Predicts the fitness of a chromosome.
+			 * @param genes		The chromosome.
+			 * @return		The predicted fitness.
+			 */
+			virtual double predict( const vector <T> &genes ) = 0;
 	};
 
 	/**
@@ -734,6 +1072,70 @@ namespace GenBase
 			 */
 			void startSolving( unsigned int maxGenerations );
 
+			/**
+			 * 			Anytime version of startSolving().
+			 *
+			 *			Stops as soon as the specified time has passed. If
+			 *			parseChromosomes() checks evaluationAllowed() before each
+			 *			evaluation (as NetSolver does), solving stops in the middle of
+			 *			a generation. Otherwise the current generation is finished first.
+			 *			In both cases no new generation is created after the deadline,
+			 *			so #newGeneration contains the last evaluated chromosomes.
+			 * @param seconds	Wall-clock time budget in seconds.
+			 * @param maxGenerations Maximum number of generations.
+			 */
+			void startSolvingTime( double seconds, unsigned int maxGenerations = UINT_MAX );
+
+			/**
+			 * 			Anytime version of startSolving().
+			 *
+			 *			Behaves like startSolvingTime(), except that the budget is
+			 *			the number of fitness evaluations.
+			 * @param maxEvaluations Maximum number of fitness evaluations.
+			 * @param maxGenerations Maximum number of generations.
+			 */
+			void startSolvingEvaluations( unsigned long maxEvaluations, unsigned int maxGenerations = UINT_MAX );
+
+			/**
+			 * 			Returns the fitness of the best chromosome found so far.
+			 *
+			 *			Updated whenever parseChromosomes() calls evaluationAllowed()
+			 *			(i.e. during a generation, as soon as the chromosomes before
+			 *			the next one are evaluated) and after each (possibly interrupted)
+			 *			generation. Only chromosomes that have really been evaluated
+			 *			are considered.
+			 */
+			const double bestFitness() const;
+
+			/**
+			 * 			Returns a copy of the best chromosome found so far (see bestFitness()).
+			 */
+			const typename T::chromosome_type& bestChromosome() const;
+
+			/**
+			 * 			Returns the number of fitness evaluations so far.
+			 */
+			const unsigned long numberOfEvaluations() const;
+
+			/**
+			 * 			Enables surrogate-assisted pre-screening.
+			 *
+			 *			Before parseChromosomes() is called, the surrogate predicts the
+			 *			fitness of all chromosomes of #newGeneration. Only the most promising
+			 *			fraction is passed to parseChromosomes() (#newGeneration is
+			 *			temporarily reduced to these chromosomes). The remaining chromosomes
+			 *			get the predicted fitness, limited to the lowest real fitness of
+			 *			the generation. All real evaluations are used to train the surrogate.
+			 *			Pre-screening only works with the single-objective fitness().
+			 * @param model		The surrogate (not deleted by GenSolver). NULL disables
+			 *			pre-screening.
+			 * @param fraction	Fraction of chromosomes that are really evaluated ( 0 < fraction <= 1 ).
+			 * @param warmUpGenerations Number of generations that are completely evaluated
+			 *			before the surrogate is used.
+			 */
+			void setSurrogate( Surrogate <typename T::chromosome_type::value_type> *model, double fraction,
+			                   unsigned int warmUpGenerations = 2 );
+
 		protected:
 
 			/**
@@ -756,12 +1158,98 @@ namespace GenBase
 			 * If this method is called, startSolving will stop.
 			 */
 			void foundSolution();
+
+			/**
+			 *			Budget check for fitness functions.
+			 *
+			 *			Should be called in parseChromosomes() before each
+			 *			evaluation. Returns false if the time or evaluation
+			 *			budget of startSolvingTime() or startSolvingEvaluations()
+			 *			is exhausted (the loop should be stopped then). Otherwise
+			 *			the evaluation is counted and true is returned. The best
+			 *			chromosome is updated with the chromosomes evaluated so far
+			 *			(see bestFitness()).
+			 */
+			bool evaluationAllowed();
 			
 			bool _solution;
 			
 		private:
+			/**
+			 *			Solving loop used by all startSolving methods.
+			 */
+			void solve( unsigned int maxGenerations, double seconds, unsigned long maxEvaluations );
+
+			/**
+			 *			Returns true if time or evaluation budget is exhausted.
+			 */
+			bool budgetExhausted() const;
+
+			/**
+			 *			Counts the evaluated chromosomes of #newGeneration and
+			 *			updates the best chromosome.
+			 */
+			void updateBestChromosome();
+
+			/**
+			 *			Updates the best chromosome with the evaluated chromosomes
+			 *			of #newGeneration from #_bestScan up to the first chromosome
+			 *			that is not evaluated yet.
+			 */
+			void scanBestChromosome();
+
+			/**
+			 *			Returns monotonic time in seconds.
+			 */
+			static double currentTime();
+
+			/**
+			 *			Moves the chromosomes that are not worth evaluating out of #newGeneration.
+			 */
+			void screenChromosomes();
+
+			/**
+			 *			Trains the surrogate with the evaluated chromosomes and moves the
+			 *			screened chromosomes back to #newGeneration.
+			 */
+			void restoreChromosomes();
+
 			unsigned int _currentGeneration;
-			
+
+			Surrogate <typename T::chromosome_type::value_type> *surrogate;
+			double surrogateFraction;
+			unsigned int surrogateWarmUp;
+
+			/**
+			 *			Number of generations the surrogate has been trained with.
+			 */
+			unsigned int surrogateGenerations;
+
+			/**
+			 *			Chromosomes that have been removed by screenChromosomes().
+			 */
+			vector <typename T::chromosome_type*> screenedChromosomes;
+
+			/**
+			 *			Budget of the current run.
+			 */
+			double deadline;
+			unsigned long maxEvaluations;
+
+			/**
+			 *			Evaluations of completed generations and evaluations of the
+			 *			current generation counted by evaluationAllowed().
+			 */
+			unsigned long _evaluations;
+			unsigned long _generationEvaluations;
+
+			typename T::chromosome_type _bestChromosome;
+			double _bestFitness;
+
+			/**
+			 *			Position of scanBestChromosome() in #newGeneration.
+			 */
+			unsigned int _bestScan;
 	};
 }
 
@@ -803,6 +1291,9 @@ namespace GenBase
 	ChromosomeClass<T>::ChromosomeClass() : vector <T> ( 0 )
 	{
 		_fitness = 0;
+		_evaluated = false;
+		_paretoRank = 0;
+		_crowdingDistance = 0;
 	}
 
 	/*-----------------------------------------------------------------------------
@@ -892,78 +1383,217 @@ namespace GenBase
 	void ChromosomeClass<T>::setFitness( double value )
 	{
 		_fitness = value;
+		_evaluated = true;
 	}
 
 	/*-----------------------------------------------------------------------------
 
 		Class:		ChromosomeClass
 
-		Member:		operator
+		Member:		evaluated / invalidateFitness
 
 		Description:	-
 
-		Input:		index of vector entry
+		Input:		-
 
-		Output:		vector entry
+		Output:		-
 	-----------------------------------------------------------------------------*/
 	template <typename T>
-	const T ChromosomeClass<T>::operator() ( unsigned int i ) const
+	const bool ChromosomeClass<T>::evaluated() const
 	{
-		assert( i>=0 );
-		assert( i < this->size() );
-		return ( *this ) [ i ];
+		return _evaluated;
+	}
+
+	template <typename T>
+	void ChromosomeClass<T>::invalidateFitness()
+	{
+		_fitness = 0;
+		_evaluated = false;
+		_objectives.clear();
 	}
 
 	/*-----------------------------------------------------------------------------
 
 		Class:		ChromosomeClass
 
-		Member:		operator
+		Member:		setObjectives
 
-		Description:	-
+		Description:	sets the objective values
 
-		Input:		index of vector entry
+		Input:		objective values
 
-		Output:		reference to vector entry
+		Output:		-
 	-----------------------------------------------------------------------------*/
 	template <typename T>
-	T& ChromosomeClass<T>::operator() ( unsigned int i )
+	void ChromosomeClass<T>::setObjectives( const vector <double> &values )
 	{
-		assert( i>=0 );
-		assert( i < this->size() );
-		return ( *this ) [ i ];
+		_objectives = values;
 	}
 
 	/*-----------------------------------------------------------------------------
 
 		Class:		ChromosomeClass
 
-		Member:		print
+		Member:		objectives
 
-		Description:	prints the chromosome vector
+		Description:	-
 
 		Input:		-
 
-		Output:		-
+		Output:		objective values of chromosome
 	-----------------------------------------------------------------------------*/
 	template <typename T>
-	void ChromosomeClass<T>::print()
+	const vector <double>& ChromosomeClass<T>::objectives() const
 	{
-		cout << "\tFitness: " << this->fitness() << " ";
-		cout << "\tDecode:\t";
+		return _objectives;
+	}
 
-		for ( int k = 0; k < this->subGeneSizes.size(); k++ )
-		{
-			vector <T> tmp = this->getSubGene( k );
-			for ( int j = 0;j < tmp.size();j++ ) cout << tmp[ j ];
-			cout << ",";
-		}
-		cout << endl << "\t\t\t\t\t";
+	/*-----------------------------------------------------------------------------
 
-		for ( int k = 0; k < this->numberOfGenes(); k++ )
-		{
-			cout << "(";
-			vector <T> tmp = this->getSubGene( k, 0 );
+		Class:		ChromosomeClass
+
+		Member:		dominates
+
+		Description:	checks pareto dominance (all objectives are maximized)
+
+		Input:		other chromosome
+
+		Output:		true if this chromosome dominates the other one
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	bool ChromosomeClass<T>::dominates( const ChromosomeClass<T> &other ) const
+	{
+		assert( _objectives.size() == other._objectives.size() );
+
+		bool better = false;
+
+		for ( unsigned int i = 0; i < _objectives.size(); i++ )
+		{
+			if ( _objectives[ i ] < other._objectives[ i ] ) return false;
+			if ( _objectives[ i ] > other._objectives[ i ] ) better = true;
+		}
+
+		return better;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		paretoRank / setParetoRank
+
+		Description:	index of the non-dominated front
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	const unsigned int ChromosomeClass<T>::paretoRank() const
+	{
+		return _paretoRank;
+	}
+
+	template <typename T>
+	void ChromosomeClass<T>::setParetoRank( unsigned int value )
+	{
+		_paretoRank = value;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		crowdingDistance / setCrowdingDistance
+
+		Description:	crowding distance inside of the front
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	const double ChromosomeClass<T>::crowdingDistance() const
+	{
+		return _crowdingDistance;
+	}
+
+	template <typename T>
+	void ChromosomeClass<T>::setCrowdingDistance( double value )
+	{
+		_crowdingDistance = value;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		operator
+
+		Description:	-
+
+		Input:		index of vector entry
+
+		Output:		vector entry
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	const T ChromosomeClass<T>::operator() ( unsigned int i ) const
+	{
+		assert( i>=0 );
+		assert( i < this->size() );
+		return ( *this ) [ i ];
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		operator
+
+		Description:	-
+
+		Input:		index of vector entry
+
+		Output:		reference to vector entry
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	T& ChromosomeClass<T>::operator() ( unsigned int i )
+	{
+		assert( i>=0 );
+		assert( i < this->size() );
+		return ( *this ) [ i ];
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		print
+
+		Description:	prints the chromosome vector
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	void ChromosomeClass<T>::print()
+	{
+		cout << "\tFitness: " << this->fitness() << " ";
+		cout << "\tDecode:\t";
+
+		for ( int k = 0; k < this->subGeneSizes.size(); k++ )
+		{
+			vector <T> tmp = this->getSubGene( k );
+			for ( int j = 0;j < tmp.size();j++ ) cout << tmp[ j ];
+			cout << ",";
+		}
+		cout << endl << "\t\t\t\t\t";
+
+		for ( int k = 0; k < this->numberOfGenes(); k++ )
+		{
+			cout << "(";
+			vector <T> tmp = this->getSubGene( k, 0 );
 			for ( int j = 0;j < tmp.size();j++ ) cout << tmp[ j ];
 			cout << "->";
 			tmp = this->getSubGene( k, 1 );
@@ -1217,6 +1847,55 @@ namespace GenBase
 		( *this ) ( i ) = randFunction( minRandValue, maxRandValue );
 	}
 
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		randFunction
+
+		Description:	stream based random function, calls the method
+				above if not overridden (serialized, as it may
+				use rand())
+
+		Input:		minimum random value, maximum random value, random
+				stream
+
+		Output:		random value
+	-----------------------------------------------------------------------------*/
+
+	template <typename T>
+	T ChromosomeClass<T>::randFunction( T minRand, T maxRand, RandStream &stream )
+	{
+		// virtual
+		T value;
+
+		#pragma omp critical ( chromosomeRandFunction )
+		value = randFunction( minRand, maxRand );
+
+		return value;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		ChromosomeClass
+
+		Member:		mutate
+
+		Description:	randomly changes bit i of the chromosome, the random
+				value is taken from the specified stream
+
+		Input:		index of bit, minimum random value, maximum random
+				value, random stream
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+
+	template <typename T>
+	void ChromosomeClass<T>::mutate( unsigned int i, T minRandValue, T maxRandValue, RandStream &stream )
+	{
+		( *this ) ( i ) = randFunction( minRandValue, maxRandValue, stream );
+	}
+
 	/*-----------------------------------------------------------------------------
 		Class:		GenerationClass
 
@@ -1596,6 +2275,34 @@ namespace GenBase
 	}
 
 
+	/*-----------------------------------------------------------------------------
+
+		Description:	converts the current token of a TextReader to a gene
+				value (integer genes are parsed as integers, everything
+				else as floating point numbers)
+
+		Input:		reader, value
+
+		Output:		true if the token is a valid number
+	-----------------------------------------------------------------------------*/
+
+	inline bool readGeneValue( const TextReader &reader, int &value )
+	{
+		return reader.toInt( value );
+	}
+
+	template <typename T>
+	inline bool readGeneValue( const TextReader &reader, T &value )
+	{
+		double tmpVal = 0;
+
+		if ( !reader.toDouble( tmpVal ) ) return false;
+
+		value = ( T ) tmpVal;
+
+		return true;
+	}
+
 	/*-----------------------------------------------------------------------------
 
 		Class:		GenerationClass
@@ -1612,29 +2319,40 @@ namespace GenBase
 	template <class T, class ChromosomeTemplate>
 	bool GenerationClass<T, ChromosomeTemplate>::loadGeneration( string fileName )
 	{
-		// List with header informations
-		vector <string> headerList;
+		// The file
+		TextReader reader;
 
-		// The file stream
-		ifstream f( fileName.c_str() );
-
-		if ( !f )
+		if ( !reader.open( fileName ) )
 		{
 			cerr << "Error: File doesn't exist!" << endl;
 			return false;
 		};
 
-		if ( !this->readHeaderSection( f, headerList ) ) return false;
+		if ( !this->readHeaderSection( reader ) ) return false;
+
+		vector <ChromosomeTemplate*> chromosomes;
+
+		if ( !this->readDataSection( reader, chromosomes ) )
+		{
+			for ( unsigned int i = 0; i < chromosomes.size(); i++ )
+			{
+				delete chromosomes[ i ];
+			}
+			return false;
+		}
 
-		if ( !this->readDataSection( f ) ) return false;
+		reader.close();
 
-		// 		if ( !this->readOutputSection( f ) ) return false;
-		//
-		// 		if ( !this->readConnectionSection( f ) ) return false;
+		/*-----------------------------------------
+			Replace the chromosomes
+		------------------------------------------*/
 
-		f.close();
+		for ( unsigned int i = 0; i < this->size(); i++ )
+		{
+			delete ( *this ) [ i ];
+		}
 
-		// 		generateNet( inputList, outputList, connectionList );
+		this->assign( chromosomes.begin(), chromosomes.end() );
 
 		return true;
 	}
@@ -1647,62 +2365,52 @@ namespace GenBase
 
 		Description:	reads header section and verifies version
 
-		Input:		ifstream to the corresponding file, string list
+		Input:		reader of the corresponding file
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
 
 	template <class T, class ChromosomeTemplate>
-	bool GenerationClass<T, ChromosomeTemplate>::readHeaderSection( ifstream &f, vector <string> &headerList )
+	bool GenerationClass<T, ChromosomeTemplate>::readHeaderSection( TextReader &reader )
 	{
 		/*-----------------------------------------
 			  Read Header Information
 		------------------------------------------*/
 
-		while ( !f.eof() )
-		{
-			string tmpStr;
-			f >> tmpStr;
-			headerList.push_back( tmpStr );
-			if ( tmpStr == "</header>" ) break;
-		}
-
-		/*-----------------------------------------
-		   Error Handling for Header Information
-		------------------------------------------*/
-
-		if ( headerList[ 0 ] != "<header>" )
+		if ( !reader.next() || !reader.is( "<header>" ) )
 		{
 			cerr << "Error: Unknown file format!" << endl;
 			return false;
 		}
 
-		if ( headerList[ headerList.size() - 1 ] != "</header>" )
+		if ( !reader.next() || !reader.is( "GenSolver-File" ) )
 		{
-			cerr << "Error: Missing </header>!" << endl;
+			cerr << "Error: Unknown file format!" << endl;
 			return false;
 		}
 
-		if ( headerList[ 1 ] != "GenSolver-File" )
+		double version = 0;
+
+		if ( !reader.next() || !reader.toDouble( version ) || version == 0 )
 		{
-			cerr << "Error: Unknown file format!" << endl;
+			cerr << "Error: Can't verify version of file format!" << endl;
 			return false;
 		}
 
-		if ( atof( headerList[ 2 ].c_str() ) == 0 )
+		if ( version > 0.1 )
 		{
-			cerr << "Error: Can't verify version of file format!" << endl;
+			cerr << "Error: File is made by newer version of this program!" << endl;
 			return false;
 		}
-		else
+
+		// skip unknown entries
+		while ( reader.next() )
 		{
-			if ( atof( headerList[ 2 ].c_str() ) > 0.1 )
-			{
-				cerr << "Error: File is made by newer version of this program!" << endl;
-				return false;
-			}
+			if ( reader.is( "</header>" ) ) return true;
 		}
-		return true;
+
+		cerr << "Error: Missing </header>!" << endl;
+		return false;
 	};
 
 	/*-----------------------------------------------------------------------------
@@ -1711,53 +2419,71 @@ namespace GenBase
 
 		Member:		readDataSection
 
-		Description:	reads chromosomes and stores them in a string list
+		Description:	reads chromosomes directly into new chromosome objects
 
-		Input:		ifstream to the corresponding file, string list
+		Input:		reader of the corresponding file, chromosome list
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
 
 	template <class T, class ChromosomeTemplate>
-	bool GenerationClass<T, ChromosomeTemplate>::readDataSection( ifstream &f, vector <string> &dataList )
+	bool GenerationClass<T, ChromosomeTemplate>::readDataSection( TextReader &reader,
+	        vector <ChromosomeTemplate*> &chromosomes )
 	{
-		vector <string> inputStrList;
+		if ( !reader.next() || !reader.is( "<data>" ) )
+		{
+			cerr << "Error: Data section missing!" << endl;
+			return false;
+		}
+
 		/*-----------------------------------------
-			   Read Input-Cell Indices
+			   Read Chromosomes
 		------------------------------------------*/
 
-		while ( !f.eof() )
+		while ( reader.next() )
 		{
-			string tmpStr;
-			f >> tmpStr;
-			inputStrList.push_back( tmpStr );
-			if ( tmpStr == "</data>" ) break;
-		}
+			if ( reader.is( "</data>" ) ) return true;
 
+			if ( !reader.is( "<chromosome>" ) )
+			{
+				cerr << "Error: Entry " << chromosomes.size() + 1 << " in \"<data> </data>\" - Section is not a chromosome!" << endl;
+				return false;
+			}
 
-		if ( inputStrList[ 0 ] != "<data>" )
-		{
-			cerr << "Error: Data section missing!" << endl;
-			return false;
-		}
-		if ( inputStrList[ inputStrList.size() - 1 ] != "</data>" )
-		{
-			cerr << "Error: Missing </data>!" << endl;
-			return false;
-		}
+			ChromosomeTemplate *chromosome = new ChromosomeTemplate();
+			chromosomes.push_back( chromosome );
 
-// 		for ( unsigned int i = 1;i < inputStrList.size() - 1;i++ )
-// 		{
-// 			int tmpVal = atoi( inputStrList[ i ].c_str() );
-// 			if ( ( inputStrList[ i ] != "0" ) && ( tmpVal == 0 ) )
-// 			{
-// 				cerr << "Error: Entry " << i << " in \"<inputs> </inputs>\" - Section is not a valid integer number!" << endl;
-// 				return 1;
-// 			}
-// 			inputList.push_back( tmpVal );
-// 		}
+			bool complete = false;
 
-		return true;
+			for ( unsigned int i = 1; reader.next(); i++ )
+			{
+				if ( reader.is( "</chromosome>" ) )
+				{
+					complete = true;
+					break;
+				}
+
+				T tmpVal;
+				if ( !readGeneValue( reader, tmpVal ) )
+				{
+					cerr << "Error: Entry " << i << " of chromosome " << chromosomes.size()
+					<< " in \"<data> </data>\" - Section is not a valid number!" << endl;
+					return false;
+				}
+				chromosome->push_back( tmpVal );
+			}
+
+			if ( !complete )
+			{
+				cerr << "Error: Missing </chromosome>!" << endl;
+				return false;
+			}
+
+			if ( chromosome->size() > 0 ) chromosome->subGeneSizes.push_back( chromosome->size() );
+		}
+
+		cerr << "Error: Missing </data>!" << endl;
+		return false;
 	};
 
 
@@ -1798,6 +2524,13 @@ namespace GenBase
 		
 		parent1 = NULL;
 		parent2 = NULL;
+
+		numberOfThreads = 1;
+		mutationStreams.resize( 1, NULL );
+
+		selectionGeneration = NULL;
+		multiObjective = false;
+		eliteGeneration = NULL;
 	}
 
 	/*-----------------------------------------------------------------------------
@@ -1826,6 +2559,12 @@ namespace GenBase
 			delete oldGeneration;
 			oldGeneration = NULL;
 		}
+
+		if( eliteGeneration!= NULL)
+		{
+			delete eliteGeneration;
+			eliteGeneration = NULL;
+		}
 		
 // 		if( parent1!= NULL)
 // 		{
@@ -1878,6 +2617,7 @@ namespace GenBase
 		cout << "srand constant: " << this->srandValue << endl;
 
 		srand( this->srandValue );
+		breedStream.seed( this->srandValue );
 
 		newGeneration = new GenerationTemplate( generationSize );
 		oldGeneration = new GenerationTemplate( generationSize );
@@ -1973,54 +2713,140 @@ namespace GenBase
 
 		Class:		PopulationClass
 
-		Member:		setCrossOverRate
+		Member:		setNumberOfThreads()
 
 		Description:	-
 
-		Input:		crossover rate (usually something like 0.8)
+		Input:		number of threads (0 means automatic, default 1)
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
 	template <class T, class GenerationTemplate, class ChromosomeTemplate>
-	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::setCrossOverRate( double rate )
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::setNumberOfThreads( unsigned int value )
 	{
-		crossOverRate = rate;
+		numberOfThreads = value;
 	}
 
 	/*-----------------------------------------------------------------------------
 
 		Class:		PopulationClass
 
-		Member:		setMutationRate
+		Member:		enableMultiObjective()
 
 		Description:	-
 
-		Input:		mutation rate (usually something like 0.02)
+		Input:		value
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
 	template <class T, class GenerationTemplate, class ChromosomeTemplate>
-	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::setMutationRate( double rate )
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::enableMultiObjective( bool value )
 	{
-		mutationRate = rate;
+		multiObjective = value;
 	}
 
 	/*-----------------------------------------------------------------------------
 
 		Class:		PopulationClass
 
-		Member:		setCrossPointRange
+		Member:		paretoFront()
 
-		Description:	Defines a range within the crosspoints are randomly
-				chosen. If you like your chromosomes to be of
-				different sizes than you may choose values like
-				10 % as minimum and 90 % as maximum.Values like 50 %
-				as minimum and 50 % as maximum ensure that the size
-				of chromosomes is not changed by crossover method.
-	 			But this is only true if sub gene sizes are constant!
+		Description:	returns all chromosomes with pareto rank 0 among
+				the survivors and the chromosomes of newGeneration
+				that have objective values (newGeneration may have
+				been evaluated after the last survivor selection,
+				e.g. if the budget stopped the solver)
 
-		Input:		minimum cross point position, maximum cross point
-				position (in percent)
+		Input:		-
+
+		Output:		pointers to the chromosomes of the pareto front
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	vector <const ChromosomeTemplate*> PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::paretoFront()
+	{
+		vector <const ChromosomeTemplate*> front;
+
+		vector <ChromosomeTemplate*> pool;
+
+		if ( eliteGeneration != NULL )
+		{
+			pool.assign( eliteGeneration->begin(), eliteGeneration->end() );
+		}
+
+		// bred but not evaluated chromosomes have no objectives (see invalidateFitness())
+		for ( unsigned int i = 0; i < newGeneration->size(); i++ )
+		{
+			if ( !( *newGeneration ) ( i ) ->objectives().empty() )
+			{
+				pool.push_back( ( *newGeneration ) ( i ) );
+			}
+		}
+
+		sortNonDominated( pool );
+
+		for ( unsigned int i = 0; i < pool.size(); i++ )
+		{
+			if ( pool[ i ] ->paretoRank() == 0 )
+			{
+				front.push_back( pool[ i ] );
+			}
+		}
+
+		return front;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		setCrossOverRate
+
+		Description:	-
+
+		Input:		crossover rate (usually something like 0.8)
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::setCrossOverRate( double rate )
+	{
+		crossOverRate = rate;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		setMutationRate
+
+		Description:	-
+
+		Input:		mutation rate (usually something like 0.02)
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::setMutationRate( double rate )
+	{
+		mutationRate = rate;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		setCrossPointRange
+
+		Description:	Defines a range within the crosspoints are randomly
+				chosen. If you like your chromosomes to be of
+				different sizes than you may choose values like
+				10 % as minimum and 90 % as maximum.Values like 50 %
+				as minimum and 50 % as maximum ensure that the size
+				of chromosomes is not changed by crossover method.
+	 			But this is only true if sub gene sizes are constant!
+
+		Input:		minimum cross point position, maximum cross point
+				position (in percent)
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
@@ -2116,6 +2942,22 @@ namespace GenBase
 	template <class T, class GenerationTemplate, class ChromosomeTemplate>
 	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::mutate( ChromosomeTemplate* chromosome )
 	{
+		RandStream **stream = mutationStream();
+
+		// called by the stream based method
+		if ( stream != NULL && *stream != NULL )
+		{
+			for ( unsigned int i = 0; i < chromosome->size(); i++ )
+			{
+				if ( ( *stream )->randFloat() < mutationRate )
+				{
+					chromosome->mutate( i , minRandValue, maxRandValue, **stream );
+				}
+			}
+
+			return;
+		}
+
 		for ( unsigned int i = 0; i < chromosome->size(); i++ )
 		{
 			if ( randFloat() < mutationRate )
@@ -2126,6 +2968,76 @@ namespace GenBase
 
 	}
 
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		mutate
+
+		Description:	reentrant version of the method above, calls the
+				method above with stream as random stream of the
+				calling thread (overrides of both methods are used)
+
+		Input:		chromosome, random stream
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::mutate( ChromosomeTemplate* chromosome, RandStream &stream )
+	{
+		RandStream **threadStream = mutationStream();
+
+		// unknown thread or called by an override of the method above
+		if ( threadStream == NULL || *threadStream != NULL )
+		{
+			for ( unsigned int i = 0; i < chromosome->size(); i++ )
+			{
+				if ( stream.randFloat() < mutationRate )
+				{
+					chromosome->mutate( i , minRandValue, maxRandValue, stream );
+				}
+			}
+
+			return;
+		}
+
+		*threadStream = &stream;
+
+		mutate( chromosome );
+
+		*threadStream = NULL;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		mutationStream
+
+		Description:	entry of mutationStreams of the calling thread
+
+		Input:		-
+
+		Output:		pointer to the entry, NULL if there is none
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	RandStream **PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::mutationStream()
+	{
+		unsigned int thread = 0;
+
+#ifdef _OPENMP
+		// nested parallel regions have their own thread numbers
+		if ( omp_get_level() > 1 )
+		{
+			return NULL;
+		}
+
+		thread = omp_get_thread_num();
+#endif
+
+		return thread < mutationStreams.size() ? &mutationStreams[ thread ] : NULL;
+	}
+
 	/*-----------------------------------------------------------------------------
 
 		Class:		PopulationClass
@@ -2169,29 +3081,54 @@ namespace GenBase
 	{
 		selectParents( generation );
 
-		double minCrossPoint1 = 1. * ( parent1->subGeneSizes.size() - 1 ) / 100 * minCrossValue[ 0 ];
-		double maxCrossPoint1 = 1. * ( parent1->subGeneSizes.size() - 1 ) / 100 * maxCrossValue[ 0 ];
+		RandStream stream( rand() );
+
+		crossOver( *parent1, *parent2, baby1, baby2, stream );
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		crossOver
+
+		Description:	Reentrant version of the method above. The parents
+				are specified directly and random values are taken
+				from the specified stream.
+
+		Input:		two parent chromosomes, two baby chromosomes, random
+				stream
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::crossOver
+	( const ChromosomeTemplate& p1, const ChromosomeTemplate& p2,
+	  ChromosomeTemplate & baby1, ChromosomeTemplate & baby2, RandStream &stream ) const
+	{
+		double minCrossPoint1 = 1. * ( p1.subGeneSizes.size() - 1 ) / 100 * minCrossValue[ 0 ];
+		double maxCrossPoint1 = 1. * ( p1.subGeneSizes.size() - 1 ) / 100 * maxCrossValue[ 0 ];
 
-		unsigned int crossPoint1 = randInt( int ( minCrossPoint1 ), int( maxCrossPoint1 ) );
+		unsigned int crossPoint1 = stream.randInt( int ( minCrossPoint1 ), int( maxCrossPoint1 ) );
 
 		unsigned int realCrossPoint1 = 0;
 
 
 		for ( unsigned int i = 0; i < crossPoint1; i++ )
 		{
-			realCrossPoint1 += parent1->subGeneSizes[ i ];
+			realCrossPoint1 += p1.subGeneSizes[ i ];
 		}
 
-		double minCrossPoint2 = 1. * ( parent2->subGeneSizes.size() - 1 ) / 100 * minCrossValue[ 1 ];
-		double maxCrossPoint2 = 1. * ( parent2->subGeneSizes.size() - 1 ) / 100 * maxCrossValue[ 1 ];
+		double minCrossPoint2 = 1. * ( p2.subGeneSizes.size() - 1 ) / 100 * minCrossValue[ 1 ];
+		double maxCrossPoint2 = 1. * ( p2.subGeneSizes.size() - 1 ) / 100 * maxCrossValue[ 1 ];
 
-		unsigned int crossPoint2 = randInt( int( minCrossPoint2 ), int( maxCrossPoint2 ) );
+		unsigned int crossPoint2 = stream.randInt( int( minCrossPoint2 ), int( maxCrossPoint2 ) );
 
 		unsigned int realCrossPoint2 = 0;
 
 		for ( unsigned int i = 0; i < crossPoint2; i++ )
 		{
-			realCrossPoint2 += parent2->subGeneSizes[ i ];
+			realCrossPoint2 += p2.subGeneSizes[ i ];
 		}
 
 		if ( equalCrossPoints )
@@ -2206,7 +3143,7 @@ namespace GenBase
 
 		// 		cout << "CP: " << crossPoint1 << " " << crossPoint2 << endl;
 		// 		cin.get();
-		if ( randFloat() < crossOverRate )
+		if ( stream.randFloat() < crossOverRate )
 		{
 
 			vector <int> tmpSubGeneSizes1;
@@ -2218,42 +3155,42 @@ namespace GenBase
 
 			for ( unsigned int i = 0; i < realCrossPoint1; i++ )
 			{
-				tmpBaby1.push_back( ( *parent1 ) ( i ) );
+				tmpBaby1.push_back( p1( i ) );
 			}
 
-			for ( unsigned int i = realCrossPoint2; i < parent2->size(); i++ )
+			for ( unsigned int i = realCrossPoint2; i < p2.size(); i++ )
 			{
-				tmpBaby1.push_back( ( *parent2 ) ( i ) );
+				tmpBaby1.push_back( p2( i ) );
 			}
 
 			for ( unsigned int i = 0; i < realCrossPoint2; i++ )
 			{
-				tmpBaby2.push_back( ( *parent2 ) ( i ) );
+				tmpBaby2.push_back( p2( i ) );
 			}
 
-			for ( unsigned int i = realCrossPoint1; i < parent1->size(); i++ )
+			for ( unsigned int i = realCrossPoint1; i < p1.size(); i++ )
 			{
-				tmpBaby2.push_back( ( *parent1 ) ( i ) );
+				tmpBaby2.push_back( p1( i ) );
 			}
 
 			for ( unsigned int i = 0; i < crossPoint1; i++ )
 			{
-				tmpSubGeneSizes1.push_back( ( *parent1 ).subGeneSizes[ i ] );
+				tmpSubGeneSizes1.push_back( p1.subGeneSizes[ i ] );
 			}
 
-			for ( unsigned int i = crossPoint2; i < parent2->subGeneSizes.size(); i++ )
+			for ( unsigned int i = crossPoint2; i < p2.subGeneSizes.size(); i++ )
 			{
-				tmpSubGeneSizes1.push_back( ( *parent2 ).subGeneSizes[ i ] );
+				tmpSubGeneSizes1.push_back( p2.subGeneSizes[ i ] );
 			}
 
 			for ( unsigned int i = 0; i < crossPoint2; i++ )
 			{
-				tmpSubGeneSizes2.push_back( ( *parent2 ).subGeneSizes[ i ] );
+				tmpSubGeneSizes2.push_back( p2.subGeneSizes[ i ] );
 			}
 
-			for ( unsigned int i = crossPoint1; i < parent1->subGeneSizes.size(); i++ )
+			for ( unsigned int i = crossPoint1; i < p1.subGeneSizes.size(); i++ )
 			{
-				tmpSubGeneSizes2.push_back( ( *parent1 ).subGeneSizes[ i ] );
+				tmpSubGeneSizes2.push_back( p1.subGeneSizes[ i ] );
 			}
 
 			baby1 = tmpBaby1;
@@ -2264,8 +3201,8 @@ namespace GenBase
 		}
 		else
 		{
-			baby1 = *parent1;
-			baby2 = *parent2;
+			baby1 = p1;
+			baby2 = p2;
 		}
 	}
 
@@ -2312,6 +3249,88 @@ namespace GenBase
 		return selectedChromosome;
 	}
 
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		buildSelectionTable
+
+		Description:	stores the accumulated fitness values of all
+				chromosomes, i.e. entry i contains the sum of the
+				fitness values of the chromosomes 0 to i.
+
+		Input:		the generation from which chromosomes shall be
+				chosen.
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::buildSelectionTable( const GenerationTemplate& generation )
+	{
+		selectionGeneration = &generation;
+
+		// tournament selection doesn't need a table
+		if ( multiObjective ) return;
+
+		long double totalFitness = 0;
+
+		cumulativeFitness.resize( generation.size() );
+
+		for ( unsigned int i = 0; i < generation.size(); i++ )
+		{
+			totalFitness += generation( i ) ->fitness();
+			cumulativeFitness[ i ] = totalFitness;
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		grabChromosome
+
+		Description:	chooses randomly a chromosome dependant on its
+				fitness. Uses the table created by
+				buildSelectionTable() (binary search). If
+				multi-objective optimization is enabled a binary
+				tournament (crowded comparison) is used instead.
+
+		Input:		random stream
+
+		Output:		index of the chromosome
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	const unsigned int PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::grabChromosome( RandStream &stream ) const
+	{
+		if ( multiObjective )
+		{
+			unsigned int n = selectionGeneration->size();
+			unsigned int a = stream.randInt( 0, n - 1 );
+			unsigned int b = stream.randInt( 0, n - 1 );
+
+			return crowdedGreater( ( *selectionGeneration ) ( b ), ( *selectionGeneration ) ( a ) ) ? b : a;
+		}
+
+		assert( cumulativeFitness.size() > 0 );
+
+		long double totalFitness = cumulativeFitness[ cumulativeFitness.size() - 1 ];
+
+		// no fitness at all, every chromosome has the same chance
+		if ( totalFitness <= 0 )
+		{
+			return stream.randInt( 0, cumulativeFitness.size() - 1 );
+		}
+
+		long double randomFitness = stream.randFloat() * totalFitness; // here we decide were to stop the wheel
+
+		unsigned int i = std::upper_bound( cumulativeFitness.begin(), cumulativeFitness.end(), randomFitness )
+		                 - cumulativeFitness.begin();
+
+		if ( i >= cumulativeFitness.size() ) i = cumulativeFitness.size() - 1;
+
+		return i;
+	}
+
 	/*-----------------------------------------------------------------------------
 
 		Class:		PopulationClass
@@ -2355,102 +3374,428 @@ namespace GenBase
 
 		Class:		PopulationClass
 
-		Member:		createNewGeneration
+		Member:		selectParents
 
-		Description:	Creates a new generation with use of crossover,
-				mutation and so on (apparently as in real life). The
-				generations are members of PopulationClass
+		Description:	Reentrant version of the method above. Returns the
+				indices of the chosen chromosomes instead of setting
+				parent1 and parent2. buildSelectionTable() has to be
+				called before.
 
-		Input:		-
+		Input:		random stream, references to both indices
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
 	template <class T, class GenerationTemplate, class ChromosomeTemplate>
-	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::createNewGeneration()
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::selectParents( RandStream &stream,
+	        unsigned int &index1, unsigned int &index2 ) const
 	{
-		//swap generationPointers
-		GenerationTemplate * tmpPointer = oldGeneration;
- 		oldGeneration = newGeneration;
-		newGeneration = tmpPointer;
-		
-// 		*oldGeneration = *newGeneration;
+		index1 = grabChromosome( stream );
+		index2 = index1;
 
-		
-				
-		for ( unsigned int i = 0; i < newGeneration->size() - 1; i += 2 )
+		if ( cloneParents || selectionGeneration->size() < 2 )
 		{
-			ChromosomeTemplate * arg1 = ( *newGeneration ) ( i );
-			ChromosomeTemplate * arg2 = ( *newGeneration ) ( i + 1 );
-			
-			crossOver( *oldGeneration, *arg1, *arg2 );
-
-			mutate( ( *newGeneration ) ( i ) );
-			mutate( ( *newGeneration ) ( i + 1 ) );
-
+			index2 = grabChromosome( stream );
+		}
+		else
+		{
+			//we want to ensure to get two different chromosomes as parents
+			while ( index2 == index1 )
+			{
+				index2 = grabChromosome( stream );
+			}
 		}
-
 	}
 
 	/*-----------------------------------------------------------------------------
 
 		Class:		PopulationClass
 
-		Member:		initializeGeneration
+		Member:		objectivesGreater
 
-		Description:	Initializes randomly the hole start generation.
+		Description:	lexicographic comparison of the objectives
 
-		Input:		-
+		Input:		two chromosomes
 
-		Output:		-
+		Output:		true if the objectives of a are greater
 	-----------------------------------------------------------------------------*/
-
 	template <class T, class GenerationTemplate, class ChromosomeTemplate>
-	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::initializeGeneration
-	( unsigned int minCSize, unsigned int maxCSize, unsigned int minSubSize, unsigned int maxSubSize, T minRand, T maxRand )
+	bool PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::objectivesGreater( const ChromosomeTemplate* a,
+	        const ChromosomeTemplate* b )
 	{
-		newGeneration->initializeChromosomes( minCSize, maxCSize, minSubSize, maxSubSize, minRand, maxRand );
+		return b->objectives() < a->objectives();
 	}
 
-
 	/*-----------------------------------------------------------------------------
-		Class:		GenSolver
 
-		Description:	The purpose of this class is to give easy access to
-				the genetic classes. As the fitness function and the
-				parsing of chromosomes is highly problem specific
-				this class is intentionally an abstract class. To be
-				able to use the genetic algorithms it is necessary
-				to write an implementation of the method
-				parseChromosomes. There you have also to decide
-				weather the cromosomes do thair job well or not. It
-				is impossible to get a solution of your problem if
-				you are not able to write a fitness function!
-	-----------------------------------------------------------------------------*/
+		Class:		PopulationClass
 
+		Member:		crowdedGreater
 
-	/*-----------------------------------------------------------------------------
-		Class:		GenSolver
+		Description:	crowded comparison operator of NSGA-II
 
-		Public Members:
+		Input:		two chromosomes
+
+		Output:		true if a is better than b
 	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	bool PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::crowdedGreater( const ChromosomeTemplate* a,
+	        const ChromosomeTemplate* b )
+	{
+		if ( a->paretoRank() != b->paretoRank() )
+		{
+			return a->paretoRank() < b->paretoRank();
+		}
+
+		return a->crowdingDistance() > b->crowdingDistance();
+	}
 
 	/*-----------------------------------------------------------------------------
 
-		Class:		GenSolver
+		Class:		PopulationClass
 
-		Member:		GenSolver //constructor
+		Member:		sortNonDominated
 
-		Description:	-
+		Description:	Assigns pareto rank and crowding distance to all
+				chromosomes. After sorting lexicographically no
+				chromosome can be dominated by a chromosome that comes
+				later. Therefore each chromosome is inserted into the
+				first front that doesn't dominate it. If a front
+				dominates a chromosome, all previous fronts do it too,
+				so the front can be found by binary search.
 
-		Input:		size of one generation
+				For two objectives the last member of a front has the
+				largest second objective of the front. It is the only
+				member that has to be checked.
+
+		Input:		chromosomes (reordered)
 
 		Output:		-
 	-----------------------------------------------------------------------------*/
-	template <typename T>
-	GenSolver<T>::GenSolver()
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::sortNonDominated( vector <ChromosomeTemplate*> &pool ) const
 	{
-		_currentGeneration = 0;
-		_solution = false;
+		if ( pool.size() == 0 ) return;
+
+		std::sort( pool.begin(), pool.end(), objectivesGreater );
+
+		unsigned int numberOfObjectives = pool[ 0 ] ->objectives().size();
+
+		vector < vector <ChromosomeTemplate*> > fronts;
+
+		for ( unsigned int i = 0; i < pool.size(); i++ )
+		{
+			ChromosomeTemplate *c = pool[ i ];
+
+			assert( c->objectives().size() == numberOfObjectives );
+
+			unsigned int low = 0;
+			unsigned int high = fronts.size();
+
+			while ( low < high )
+			{
+				unsigned int mid = ( low + high ) / 2;
+
+				bool dominated = false;
+
+				if ( numberOfObjectives == 2 )
+				{
+					dominated = fronts[ mid ].back() ->dominates( *c );
+				}
+				else
+				{
+					for ( int j = fronts[ mid ].size() - 1; j >= 0 && !dominated; j-- )
+					{
+						dominated = fronts[ mid ][ j ] ->dominates( *c );
+					}
+				}
+
+				if ( dominated )
+				{
+					low = mid + 1;
+				}
+				else
+				{
+					high = mid;
+				}
+			}
+
+			if ( low == fronts.size() )
+			{
+				fronts.push_back( vector <ChromosomeTemplate*>() );
+			}
+
+			fronts[ low ].push_back( c );
+			c->setParetoRank( low );
+		}
+
+		for ( unsigned int i = 0; i < fronts.size(); i++ )
+		{
+			assignCrowdingDistance( fronts[ i ] );
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		assignCrowdingDistance
+
+		Description:	Sums up the normalized distances to the neighbours
+				for each objective. Boundary chromosomes get an
+				infinite distance.
+
+		Input:		chromosomes of one front
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::assignCrowdingDistance( vector <ChromosomeTemplate*> &front ) const
+	{
+		unsigned int n = front.size();
+
+		for ( unsigned int i = 0; i < n; i++ )
+		{
+			front[ i ] ->setCrowdingDistance( 0 );
+		}
+
+		if ( n == 0 ) return;
+
+		unsigned int numberOfObjectives = front[ 0 ] ->objectives().size();
+
+		// (objective value, index in front)
+		vector < pair <double, unsigned int> > order( n );
+
+		for ( unsigned int m = 0; m < numberOfObjectives; m++ )
+		{
+			for ( unsigned int i = 0; i < n; i++ )
+			{
+				order[ i ] = make_pair( front[ i ] ->objectives() [ m ], i );
+			}
+
+			std::sort( order.begin(), order.end() );
+
+			front[ order[ 0 ].second ] ->setCrowdingDistance( numeric_limits<double>::infinity() );
+			front[ order[ n - 1 ].second ] ->setCrowdingDistance( numeric_limits<double>::infinity() );
+
+			double range = order[ n - 1 ].first - order[ 0 ].first;
+
+			if ( range <= 0 ) continue;
+
+			for ( unsigned int i = 1; i < n - 1; i++ )
+			{
+				ChromosomeTemplate *c = front[ order[ i ].second ];
+
+				c->setCrowdingDistance( c->crowdingDistance()
+				                        + ( order[ i + 1 ].first - order[ i - 1 ].first ) / range );
+			}
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		selectSurvivors
+
+		Description:	Merges survivors of the previous generation with the
+				evaluated generation and keeps the best half
+				(sorted by crowded comparison). The chromosomes that
+				do not survive are moved to oldGeneration and will be
+				overwritten by createNewGeneration().
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::selectSurvivors()
+	{
+		if ( eliteGeneration == NULL )
+		{
+			eliteGeneration = new GenerationTemplate( 0 );
+		}
+
+		if ( eliteGeneration->size() == 0 )
+		{
+			// first generation, nothing to merge
+			eliteGeneration->swap( *oldGeneration );
+
+			for ( unsigned int i = 0; i < eliteGeneration->size(); i++ )
+			{
+				oldGeneration->push_back( new ChromosomeTemplate( ) );
+			}
+
+			vector <ChromosomeTemplate*> pool( eliteGeneration->begin(), eliteGeneration->end() );
+			sortNonDominated( pool );
+
+			return;
+		}
+
+		unsigned int size = eliteGeneration->size();
+
+		vector <ChromosomeTemplate*> pool( eliteGeneration->begin(), eliteGeneration->end() );
+		pool.insert( pool.end(), oldGeneration->begin(), oldGeneration->end() );
+
+		sortNonDominated( pool );
+
+		std::stable_sort( pool.begin(), pool.end(), crowdedGreater );
+
+		for ( unsigned int i = 0; i < size; i++ )
+		{
+			( *eliteGeneration ) [ i ] = pool[ i ];
+		}
+
+		for ( unsigned int i = size; i < pool.size(); i++ )
+		{
+			( *oldGeneration ) [ i - size ] = pool[ i ];
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		createNewGeneration
+
+		Description:	Creates a new generation with use of crossover,
+				mutation and so on (apparently as in real life). The
+				generations are members of PopulationClass
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::createNewGeneration()
+	{
+		//swap generationPointers
+		GenerationTemplate * tmpPointer = oldGeneration;
+ 		oldGeneration = newGeneration;
+		newGeneration = tmpPointer;
+		
+// 		*oldGeneration = *newGeneration;
+
+		GenerationTemplate * parentGeneration = oldGeneration;
+
+		if ( multiObjective )
+		{
+			selectSurvivors();
+			parentGeneration = eliteGeneration;
+		}
+
+		// the selection table is read-only while breeding
+		buildSelectionTable( *parentGeneration );
+
+		// one seed per generation, one stream per pair
+		unsigned long generationSeed = breedStream.next();
+
+		int numberOfPairs = newGeneration->size() / 2;
+
+#ifdef _OPENMP
+		int threads = numberOfThreads > 0 ? numberOfThreads : omp_get_max_threads();
+
+		// one random stream per thread for the mutation (see mutate())
+		if ( mutationStreams.size() < ( unsigned int ) threads )
+		{
+			mutationStreams.resize( threads, NULL );
+		}
+#endif
+
+		#pragma omp parallel for schedule( static ) num_threads( threads )
+		for ( int p = 0; p < numberOfPairs; p++ )
+		{
+			RandStream stream( generationSeed, p );
+
+			unsigned int iParent1 = 0;
+			unsigned int iParent2 = 0;
+
+			selectParents( stream, iParent1, iParent2 );
+
+			ChromosomeTemplate * arg1 = ( *newGeneration ) ( 2 * p );
+			ChromosomeTemplate * arg2 = ( *newGeneration ) ( 2 * p + 1 );
+
+			crossOver( *( *parentGeneration ) ( iParent1 ), *( *parentGeneration ) ( iParent2 ), *arg1, *arg2, stream );
+
+			mutate( arg1, stream );
+			mutate( arg2, stream );
+
+			arg1->invalidateFitness();
+			arg2->invalidateFitness();
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		PopulationClass
+
+		Member:		initializeGeneration
+
+		Description:	Initializes randomly the hole start generation.
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+
+	template <class T, class GenerationTemplate, class ChromosomeTemplate>
+	void PopulationClass< T, GenerationTemplate, ChromosomeTemplate>::initializeGeneration
+	( unsigned int minCSize, unsigned int maxCSize, unsigned int minSubSize, unsigned int maxSubSize, T minRand, T maxRand )
+	{
+		newGeneration->initializeChromosomes( minCSize, maxCSize, minSubSize, maxSubSize, minRand, maxRand );
+	}
+
+
+	/*-----------------------------------------------------------------------------
+		Class:		GenSolver
+
+		Description:	The purpose of this class is to give easy access to
+				the genetic classes. As the fitness function and the
+				parsing of chromosomes is highly problem specific
+				this class is intentionally an abstract class. To be
+				able to use the genetic algorithms it is necessary
+				to write an implementation of the method
+				parseChromosomes. There you have also to decide
+				weather the cromosomes do thair job well or not. It
+				is impossible to get a solution of your problem if
+				you are not able to write a fitness function!
+	-----------------------------------------------------------------------------*/
+
+
+	/*-----------------------------------------------------------------------------
+		Class:		GenSolver
+
+		Public Members:
+	-----------------------------------------------------------------------------*/
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		GenSolver //constructor
+
+		Description:	-
+
+		Input:		size of one generation
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <typename T>
+	GenSolver<T>::GenSolver()
+	{
+		_currentGeneration = 0;
+		_solution = false;
+
+		surrogate = NULL;
+		surrogateFraction = 1;
+		surrogateWarmUp = 0;
+		surrogateGenerations = 0;
+
+		deadline = 0;
+		maxEvaluations = 0;
+		_evaluations = 0;
+		_generationEvaluations = 0;
+		_bestFitness = -numeric_limits<double>::max();
+		_bestScan = 0;
 	}
 
 	/*-----------------------------------------------------------------------------
@@ -2521,6 +3866,66 @@ namespace GenBase
 	-----------------------------------------------------------------------------*/
 	template <class T>
 	void GenSolver<T>::startSolving( unsigned int maxGenerations )
+	{
+		solve( maxGenerations, -1, 0 );
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		startSolvingTime
+
+		Description:	anytime solving with wall-clock time budget
+
+		Input:		time budget in seconds, maximum number of generations
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::startSolvingTime( double seconds, unsigned int maxGenerations )
+	{
+		solve( maxGenerations, seconds, 0 );
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		startSolvingEvaluations
+
+		Description:	anytime solving with evaluation budget
+
+		Input:		maximum number of evaluations, maximum number of
+				generations
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::startSolvingEvaluations( unsigned long maxEvaluations, unsigned int maxGenerations )
+	{
+		assert( maxEvaluations > 0 );
+
+		solve( maxGenerations, -1, maxEvaluations );
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		solve
+
+		Description:	This is the final solving algorithm. The final
+				generation is saved in the member newGeneration.
+
+		Input:		maximum number of generations, time budget in
+				seconds (negative: unlimited), maximum number of
+				evaluations (0: unlimited)
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::solve( unsigned int maxGenerations, double seconds, unsigned long maxEvaluations )
 	{
 
 		assert( this->initialized );
@@ -2534,9 +3939,27 @@ namespace GenBase
 // 
 // 		srand( this->srandValue );
 
+		this->deadline = seconds >= 0 ? currentTime() + seconds : -1;
+		this->maxEvaluations = maxEvaluations > 0 ? _evaluations + maxEvaluations : 0;
+
 		for ( unsigned int i = 0; i < maxGenerations; i++ )
 		{
+			this->screenChromosomes();
+
+			_generationEvaluations = 0;
+			_bestScan = 0;
 			this->parseChromosomes();
+			this->updateBestChromosome();
+
+			this->restoreChromosomes();
+
+			// keep the evaluated generation
+			if ( budgetExhausted() )
+			{
+				cout << ">> STOPPING: Budget exhausted!" << endl;
+				break;
+			}
+
 			this->createNewGeneration();
 			_currentGeneration = i;
 			cout << "--- New Generation: " << i << " ---"<< endl;
@@ -2551,6 +3974,322 @@ namespace GenBase
 		
 		
 	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		currentTime
+
+		Description:	-
+
+		Input:		-
+
+		Output:		monotonic time in seconds
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	double GenSolver<T>::currentTime()
+	{
+		timespec t;
+		clock_gettime( CLOCK_MONOTONIC, &t );
+
+		return t.tv_sec + t.tv_nsec * 1e-9;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		budgetExhausted
+
+		Description:	-
+
+		Input:		-
+
+		Output:		true if time or evaluation budget is exhausted
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	bool GenSolver<T>::budgetExhausted() const
+	{
+		if ( maxEvaluations > 0 && _evaluations + _generationEvaluations >= maxEvaluations ) return true;
+
+		if ( deadline >= 0 && currentTime() >= deadline ) return true;
+
+		return false;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		evaluationAllowed
+
+		Description:	counts the evaluation if the budget allows it
+
+		Input:		-
+
+		Output:		false if the budget is exhausted
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	bool GenSolver<T>::evaluationAllowed()
+	{
+		scanBestChromosome();
+
+		if ( budgetExhausted() ) return false;
+
+		_generationEvaluations++;
+
+		return true;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		updateBestChromosome
+
+		Description:	Counts the evaluated chromosomes of newGeneration
+				(the budget check may have stopped the fitness
+				function) and copies the best one.
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::updateBestChromosome()
+	{
+		unsigned long evaluations = 0;
+
+		for ( unsigned int i = 0; i < this->newGeneration->size(); i++ )
+		{
+			const typename T::chromosome_type *c = ( *this->newGeneration ) ( i );
+
+			if ( !c->evaluated() ) continue;
+
+			evaluations++;
+
+			if ( c->fitness() > _bestFitness )
+			{
+				_bestFitness = c->fitness();
+				_bestChromosome = *c;
+			}
+		}
+
+		_evaluations += std::max( evaluations, _generationEvaluations );
+		_generationEvaluations = 0;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		scanBestChromosome
+
+		Description:	Updates the best chromosome during a generation.
+				Chromosomes are usually evaluated in order, so
+				only the new part of the evaluated prefix of
+				newGeneration is checked (linear in the size of
+				the generation per generation). Chromosomes
+				evaluated out of order are considered by
+				updateBestChromosome().
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::scanBestChromosome()
+	{
+		for ( ; _bestScan < this->newGeneration->size(); _bestScan++ )
+		{
+			const typename T::chromosome_type *c = ( *this->newGeneration ) ( _bestScan );
+
+			if ( !c->evaluated() ) break;
+
+			if ( c->fitness() > _bestFitness )
+			{
+				_bestFitness = c->fitness();
+				_bestChromosome = *c;
+			}
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		bestFitness / bestChromosome / numberOfEvaluations
+
+		Description:	-
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	const double GenSolver<T>::bestFitness() const
+	{
+		return _bestFitness;
+	}
+
+	template <class T>
+	const typename T::chromosome_type& GenSolver<T>::bestChromosome() const
+	{
+		return _bestChromosome;
+	}
+
+	template <class T>
+	const unsigned long GenSolver<T>::numberOfEvaluations() const
+	{
+		return _evaluations;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		setSurrogate
+
+		Description:	enables surrogate-assisted pre-screening
+
+		Input:		surrogate model, fraction of chromosomes that are
+				evaluated, number of generations without
+				pre-screening
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::setSurrogate( Surrogate <typename T::chromosome_type::value_type> *model, double fraction,
+	                                 unsigned int warmUpGenerations )
+	{
+		assert( fraction > 0 );
+		assert( fraction <= 1 );
+
+		surrogate = model;
+		surrogateFraction = fraction;
+		surrogateWarmUp = warmUpGenerations;
+		surrogateGenerations = 0;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		screenChromosomes
+
+		Description:	Predicts the fitness of all chromosomes. The most
+				promising ones are moved to the front of
+				newGeneration, the others are moved to
+				screenedChromosomes and newGeneration is shrinked.
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::screenChromosomes()
+	{
+		typedef typename T::chromosome_type ChromosomeTemplate;
+
+		screenedChromosomes.clear();
+
+		if ( surrogate == NULL || surrogateFraction >= 1 ) return;
+
+		if ( surrogateGenerations < surrogateWarmUp ) return;
+
+		unsigned int size = this->newGeneration->size();
+		unsigned int numberOfEvaluations = ( unsigned int ) ceil( surrogateFraction * size );
+
+		if ( numberOfEvaluations >= size ) return;
+
+		// (negative predicted fitness, index), best prediction first
+		vector < pair <double, unsigned int> > predictions( size );
+
+		for ( unsigned int i = 0; i < size; i++ )
+		{
+			predictions[ i ] = make_pair( -surrogate->predict( *( *this->newGeneration ) ( i ) ), i );
+		}
+
+		std::sort( predictions.begin(), predictions.end() );
+
+		vector <ChromosomeTemplate*> chromosomes( this->newGeneration->begin(), this->newGeneration->end() );
+
+		for ( unsigned int i = 0; i < size; i++ )
+		{
+			ChromosomeTemplate *c = chromosomes[ predictions[ i ].second ];
+
+			if ( i < numberOfEvaluations )
+			{
+				( *this->newGeneration ) [ i ] = c;
+			}
+			else
+			{
+				c->setFitness( -predictions[ i ].first );
+				screenedChromosomes.push_back( c );
+			}
+		}
+
+		this->newGeneration->resize( numberOfEvaluations );
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		GenSolver
+
+		Member:		restoreChromosomes
+
+		Description:	Trains the surrogate with the evaluated
+				chromosomes of newGeneration and appends the
+				screened chromosomes again. Their predicted
+				fitness is limited to the lowest real fitness
+				value.
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void GenSolver<T>::restoreChromosomes()
+	{
+		if ( surrogate == NULL ) return;
+
+		double minFitness = numeric_limits<double>::max();
+		unsigned int samples = 0;
+
+		for ( unsigned int i = 0; i < this->newGeneration->size(); i++ )
+		{
+			const typename T::chromosome_type *c = ( *this->newGeneration ) ( i );
+
+			// the budget check or a solution may have stopped the fitness function
+			if ( !c->evaluated() ) continue;
+
+			surrogate->addSample( *c, c->fitness() );
+			samples++;
+
+			if ( c->fitness() < minFitness ) minFitness = c->fitness();
+		}
+
+		if ( samples > 0 )
+		{
+			surrogate->train();
+			surrogateGenerations++;
+		}
+
+		for ( unsigned int i = 0; i < screenedChromosomes.size(); i++ )
+		{
+			double fitness = screenedChromosomes[ i ] ->fitness();
+
+			if ( fitness > minFitness ) fitness = minFitness;
+			if ( fitness < 0 ) fitness = 0;
+
+			screenedChromosomes[ i ] ->setFitness( fitness );
+
+			this->newGeneration->push_back( screenedChromosomes[ i ] );
+		}
+
+		screenedChromosomes.clear();
+	}
 }
 
 #endif /*LIBGENSOLVERTPL_H*/
@@ -0,0 +1,57 @@
+/***************************************************************************
+*   Copyright (C) 2006 by Michael Hoffer                                  *
+*   info@michaelhoffer.de                                                 *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or     *
+*   (at your option) any later version.                                   *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU General Public License     *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+***************************************************************************/
+
+#ifndef LIBMAPPEDSOLVER_H
+#define LIBMAPPEDSOLVER_H
+
+#include "librand.h"
+#include "libmappedsolver.ipp"
+using namespace std;
+
+/** @file 	libmappedsolver.h
+ * @brief 	out-of-core genetic algorithms
+ * @author 	Michael Hoffer (www.mihosoft.de)
+ */
+
+/*-----------------------------------------------------------------------------
+	Description:	Out-of-core versions of GenFloat::GenSolver and
+			GenInt::GenSolver. The generations are stored in
+			memory-mapped files (see GenBase::MappedGenSolver).
+-----------------------------------------------------------------------------*/
+
+namespace GenFloat
+{
+	class MappedGenSolver : public GenBase::MappedGenSolver<double>
+	{
+		protected:
+			double randFunction( double minRand, double maxRand, RandStream &stream );
+	};
+}
+
+namespace GenInt
+{
+	class MappedGenSolver : public GenBase::MappedGenSolver<int>
+	{
+		protected:
+			int randFunction( int minRand, int maxRand, RandStream &stream );
+	};
+}
+
+#endif /*LIBMAPPEDSOLVER_H*/
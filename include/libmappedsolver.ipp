@@ -0,0 +1,905 @@
+/**************************************************************************
+*   Copyright (C) 2006 by Michael Hoffer                                  *
+*   info@michaelhoffer.de                                                 *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU Library General Public License as       *
+*   published by the Free Software Foundation; either version 2 of the    *
+*   License, or (at your option) any later version.                       *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU Library General Public     *
+*   License along with this program; if not, write to the                 *
+*   Free Software Foundation, Inc.,                                       *
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+***************************************************************************/
+
+/** @file 	libmappedsolver.ipp
+ * @brief 	template classes for out-of-core genetic algorithms
+ * @author 	Michael Hoffer (www.mihosoft.de)
+ */
+
+#ifndef LIBMAPPEDSOLVERTPL_H
+#define LIBMAPPEDSOLVERTPL_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cassert>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <librand.h>
+#include <genutil.h>
+
+using namespace std;
+
+namespace GenBase
+{
+	/**
+	 * Generation that is stored in a memory-mapped file.
+	 *
+	 * In contrast to GenerationClass all chromosomes have the same size and
+	 * the genes are not stored in heap vectors but in one file which is mapped
+	 * into memory. The operating system only keeps the pages in memory that are
+	 * actually used. Therefore the size of a generation is limited by disk
+	 * space rather than by memory.
+	 *
+	 * File layout (all sections are page aligned):
+	 *
+	 *	header | genes (numberOfChromosomes x chromosomeSize) | fitness | accumulated fitness
+	 */
+	template <class T>
+	class MappedGenerationClass
+	{
+		public:
+			MappedGenerationClass();
+			~MappedGenerationClass();
+
+			/**
+			 *			Creates the file and maps it into memory.
+			 *
+			 *			An existing file will be overwritten.
+			 * @param fileName	Filename with path.
+			 * @param numberOfChromosomes Number of chromosomes.
+			 * @param chromosomeSize Number of genes of each chromosome.
+			 * @return		Returns true if creating was successful and false otherwise.
+			 */
+			bool create( string fileName, unsigned int numberOfChromosomes, unsigned int chromosomeSize );
+
+			/**
+			 *			Unmaps and closes the file.
+			 */
+			void close();
+
+			const unsigned int numberOfChromosomes() const;
+			const unsigned int sizeOfChromosome() const;
+
+			/**
+			 *			Returns a pointer to the genes of chromosome i.
+			 */
+			T* genes( unsigned int i );
+			const T* genes( unsigned int i ) const;
+
+			const double fitness( unsigned int i ) const;
+			void setFitness( unsigned int i, double value );
+
+			/**
+			 *			Accumulates all fitness values (see MappedGenSolver::grabChromosome()).
+			 */
+			void accumulateFitness();
+
+			/**
+			 *			Returns the sum of the fitness values of chromosome 0 to i.
+			 *
+			 *			Only valid after accumulateFitness() has been called.
+			 */
+			const double accumulatedFitness( unsigned int i ) const;
+
+			/**
+			 *			Tells the operating system how the mapping will be accessed.
+			 * @param sequential	True for sequential access (read ahead), false for
+			 *			random access.
+			 */
+			void adviseAccess( bool sequential );
+
+		private:
+			MappedGenerationClass( const MappedGenerationClass<T>& source );
+			MappedGenerationClass<T>& operator=( const MappedGenerationClass<T>& source );
+
+			static size_t pageAlign( size_t value );
+
+			int fileDescriptor;
+			void *mapping;
+			size_t mappingSize;
+
+			unsigned int _numberOfChromosomes;
+			unsigned int _chromosomeSize;
+
+			T *geneData;
+			double *fitnessData;
+			double *accumulatedData;
+	};
+
+	/**
+	 * Out-of-core genetic algorithm.
+	 *
+	 * This class works like GenSolver but keeps both generations in memory-mapped
+	 * files (see MappedGenerationClass). Evaluation and breeding stream over the
+	 * population in blocks of #blockSize chromosomes, so the number of pages that
+	 * are touched at a time stays bounded. Parents are chosen fitness proportional
+	 * by binary search on the accumulated fitness, which is also stored in the file.
+	 *
+	 * Breeding draws the parents of a whole block first, sorts them by index and
+	 * copies them into a buffer in one forward sweep over the old generation.
+	 * Children are then bred from this buffer. This keeps the accesses to the
+	 * parent file sequential, but the buffer needs as much memory as one block of
+	 * chromosomes, and if the population is much larger than the block size the
+	 * sweep skips most pages (read ahead may then load pages that are not used).
+	 *
+	 * All chromosomes have the same size. Crossover is a one point crossover with
+	 * equal crosspoints (see PopulationClass::setCrossPointRange()).
+	 *
+	 * As with GenSolver, derived classes have to implement the fitness function
+	 * (parseBlock()) and the random function for genes (randFunction()).
+	 */
+	template <class T>
+	class MappedGenSolver
+	{
+		public:
+			MappedGenSolver();
+			virtual ~MappedGenSolver();
+
+			/**
+			 * 			Initializes the population randomly.
+			 *
+			 * @param fileName	Base filename with path. Two files are created
+			 *			(fileName.0 and fileName.1).
+			 * @param generationSize The size of the generation (must be even).
+			 * @param chromosomeSize The size of each chromosome.
+			 * @param minRand 	The minimum gene value.
+			 * @param maxRand 	The maximum gene value.
+			 * @return		Returns true if initialization was successful and false otherwise.
+			 */
+			bool initialize( string fileName, unsigned int generationSize, unsigned int chromosomeSize,
+			                 T minRand, T maxRand );
+
+			/**
+			 * 			The final genetic algorithm.
+			 *
+			 *			The final generation is saved in #newGeneration. After
+			 *			each generation the fitness of #newGeneration is valid
+			 *			and bestChromosome() returns the index of the fittest
+			 *			chromosome.
+			 * @param maxGenerations The number of Iterations.
+			 */
+			void startSolving( unsigned int maxGenerations );
+
+			void setMutationRate( double rate );
+			void setCrossOverRate( double rate );
+			void setCrossPointRange( double min, double max );
+			void setSrandValue( long int value );
+			void setNumberOfThreads( unsigned int value );
+
+			/**
+			 *                      Sets the number of chromosomes that are processed at a time.
+			 * @param value 	The block size.
+			 */
+			void setBlockSize( unsigned int value );
+
+			/**
+			 *                      Returns the index of the fittest chromosome of the last evaluated generation.
+			 */
+			const unsigned int bestChromosome() const;
+
+			MappedGenerationClass <T> *newGeneration;
+
+		protected:
+			/**
+			 *			Fitness-Function.
+			 *
+			 *			Assigns a fitness value to the chromosomes first to
+			 *			first + count - 1 of #newGeneration. The fitness values
+			 *			must not be negative.
+			 * @param first		Index of the first chromosome of the block.
+			 * @param count		Number of chromosomes of the block.
+			 */
+			virtual void parseBlock( unsigned int first, unsigned int count ) = 0;
+
+			/**
+			 *			Random function for genes (see ChromosomeClass::randFunction()).
+			 */
+			virtual T randFunction( T minRand, T maxRand, RandStream &stream ) = 0;
+
+			/**
+			 *			Returns current generation.
+			 */
+			const unsigned int getCurrentGeneration();
+
+			/**
+			 * If this method is called, startSolving will stop.
+			 */
+			void foundSolution();
+
+			bool _solution;
+
+		private:
+			void parseChromosomes();
+			void createNewGeneration();
+
+			const unsigned int grabChromosome( RandStream &stream ) const;
+
+			void breed( unsigned int pair, const T *parent1, const T *parent2, RandStream &stream );
+
+			MappedGenerationClass <T> *oldGeneration;
+
+			bool initialized;
+
+			T minRandValue;
+			T maxRandValue;
+
+			double mutationRate;
+			double crossOverRate;
+			double minCrossValue;
+			double maxCrossValue;
+
+			long int srandValue;
+			unsigned int numberOfThreads;
+			unsigned int blockSize;
+
+			RandStream breedStream;
+
+			vector <RandStream> pairStreams;
+			vector < std::pair <unsigned int, unsigned int> > parentReads;
+			vector <T> parentBuffer;
+
+			unsigned int _bestChromosome;
+			unsigned int _currentGeneration;
+	};
+}
+
+
+
+namespace GenBase
+{
+	/*-----------------------------------------------------------------------------
+		Class:		MappedGenerationClass
+
+		Description:	Generation that is stored in a memory-mapped file.
+	-----------------------------------------------------------------------------*/
+
+	template <class T>
+	MappedGenerationClass<T>::MappedGenerationClass()
+	{
+		fileDescriptor = -1;
+		mapping = NULL;
+		mappingSize = 0;
+
+		_numberOfChromosomes = 0;
+		_chromosomeSize = 0;
+
+		geneData = NULL;
+		fitnessData = NULL;
+		accumulatedData = NULL;
+	}
+
+	template <class T>
+	MappedGenerationClass<T>::~MappedGenerationClass()
+	{
+		close();
+	}
+
+	template <class T>
+	size_t MappedGenerationClass<T>::pageAlign( size_t value )
+	{
+		size_t pageSize = sysconf( _SC_PAGESIZE );
+		return ( value + pageSize - 1 ) / pageSize * pageSize;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenerationClass
+
+		Member:		create
+
+		Description:	creates the file, sets its size and maps it
+
+		Input:		filename, number of chromosomes, chromosome size
+
+		Output:		true if successful
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	bool MappedGenerationClass<T>::create( string fileName, unsigned int numberOfChromosomes, unsigned int chromosomeSize )
+	{
+		close();
+
+		size_t headerSize = pageAlign( 64 );
+		size_t geneSize = pageAlign( ( size_t ) numberOfChromosomes * chromosomeSize * sizeof( T ) );
+		size_t fitnessSize = pageAlign( ( size_t ) numberOfChromosomes * sizeof( double ) );
+
+		mappingSize = headerSize + geneSize + 2 * fitnessSize;
+
+		fileDescriptor = open( fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+
+		if ( fileDescriptor < 0 )
+		{
+			cerr << "Error: Can't create file \"" << fileName << "\"!" << endl;
+			return false;
+		}
+
+		if ( ftruncate( fileDescriptor, mappingSize ) != 0 )
+		{
+			cerr << "Error: Can't resize file \"" << fileName << "\" (disk full?)!" << endl;
+			close();
+			return false;
+		}
+
+		mapping = mmap( NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0 );
+
+		if ( mapping == MAP_FAILED )
+		{
+			cerr << "Error: Can't map file \"" << fileName << "\"!" << endl;
+			mapping = NULL;
+			close();
+			return false;
+		}
+
+		char *base = ( char* ) mapping;
+
+		// header: magic string, version, sizes
+		snprintf( base, headerSize, "GenSolver-Map 0.1 %u %u %u",
+		          numberOfChromosomes, chromosomeSize, ( unsigned int ) sizeof( T ) );
+
+		geneData = ( T* ) ( base + headerSize );
+		fitnessData = ( double* ) ( base + headerSize + geneSize );
+		accumulatedData = ( double* ) ( base + headerSize + geneSize + fitnessSize );
+
+		_numberOfChromosomes = numberOfChromosomes;
+		_chromosomeSize = chromosomeSize;
+
+		return true;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenerationClass
+
+		Member:		close
+
+		Description:	unmaps and closes the file (the file is kept)
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void MappedGenerationClass<T>::close()
+	{
+		if ( mapping != NULL )
+		{
+			munmap( mapping, mappingSize );
+			mapping = NULL;
+		}
+
+		if ( fileDescriptor >= 0 )
+		{
+			::close( fileDescriptor );
+			fileDescriptor = -1;
+		}
+
+		mappingSize = 0;
+
+		_numberOfChromosomes = 0;
+		_chromosomeSize = 0;
+
+		geneData = NULL;
+		fitnessData = NULL;
+		accumulatedData = NULL;
+	}
+
+	template <class T>
+	const unsigned int MappedGenerationClass<T>::numberOfChromosomes() const
+	{
+		return _numberOfChromosomes;
+	}
+
+	template <class T>
+	const unsigned int MappedGenerationClass<T>::sizeOfChromosome() const
+	{
+		return _chromosomeSize;
+	}
+
+	template <class T>
+	T* MappedGenerationClass<T>::genes( unsigned int i )
+	{
+		assert( i < _numberOfChromosomes );
+		return geneData + ( size_t ) i * _chromosomeSize;
+	}
+
+	template <class T>
+	const T* MappedGenerationClass<T>::genes( unsigned int i ) const
+	{
+		assert( i < _numberOfChromosomes );
+		return geneData + ( size_t ) i * _chromosomeSize;
+	}
+
+	template <class T>
+	const double MappedGenerationClass<T>::fitness( unsigned int i ) const
+	{
+		return fitnessData[ i ];
+	}
+
+	template <class T>
+	void MappedGenerationClass<T>::setFitness( unsigned int i, double value )
+	{
+		fitnessData[ i ] = value;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenerationClass
+
+		Member:		accumulateFitness
+
+		Description:	entry i of the accumulated fitness is the sum of the
+				fitness values of chromosome 0 to i
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void MappedGenerationClass<T>::accumulateFitness()
+	{
+		long double totalFitness = 0;
+
+		for ( unsigned int i = 0; i < _numberOfChromosomes; i++ )
+		{
+			totalFitness += fitnessData[ i ];
+			accumulatedData[ i ] = totalFitness;
+		}
+	}
+
+	template <class T>
+	const double MappedGenerationClass<T>::accumulatedFitness( unsigned int i ) const
+	{
+		return accumulatedData[ i ];
+	}
+
+	template <class T>
+	void MappedGenerationClass<T>::adviseAccess( bool sequential )
+	{
+		if ( mapping == NULL ) return;
+
+		madvise( mapping, mappingSize, sequential ? MADV_SEQUENTIAL : MADV_RANDOM );
+	}
+
+
+	/*-----------------------------------------------------------------------------
+		Class:		MappedGenSolver
+
+		Description:	Out-of-core genetic algorithm.
+	-----------------------------------------------------------------------------*/
+
+	template <class T>
+	MappedGenSolver<T>::MappedGenSolver()
+	{
+		newGeneration = new MappedGenerationClass <T>();
+		oldGeneration = new MappedGenerationClass <T>();
+
+		initialized = false;
+		_solution = false;
+
+		mutationRate = 0.02;
+		crossOverRate = 0.7;
+		minCrossValue = 0;
+		maxCrossValue = 100;
+
+		srandValue = 0;
+		numberOfThreads = 0;
+		blockSize = 65536;
+
+		_bestChromosome = 0;
+		_currentGeneration = 0;
+	}
+
+	template <class T>
+	MappedGenSolver<T>::~MappedGenSolver()
+	{
+		delete newGeneration;
+		delete oldGeneration;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenSolver
+
+		Member:		initialize
+
+		Description:	creates both generation files and initializes the
+				first generation randomly (block by block)
+
+		Input:		base filename, size of one generation, chromosome
+				size, minimum random value, maximum random value
+
+		Output:		true if successful
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	bool MappedGenSolver<T>::initialize( string fileName, unsigned int generationSize, unsigned int chromosomeSize,
+	                                     T minRand, T maxRand )
+	{
+		assert( generationSize % 2 == 0 );
+		assert( !initialized );
+
+		if ( !newGeneration->create( fileName + ".0", generationSize, chromosomeSize ) ) return false;
+		if ( !oldGeneration->create( fileName + ".1", generationSize, chromosomeSize ) )
+		{
+			newGeneration->close();
+			remove( ( fileName + ".0" ).c_str() );
+			return false;
+		}
+
+		minRandValue = minRand;
+		maxRandValue = maxRand;
+
+		breedStream.seed( srandValue );
+
+		unsigned long initSeed = breedStream.next();
+
+		newGeneration->adviseAccess( true );
+
+#ifdef _OPENMP
+		int threads = numberOfThreads > 0 ? numberOfThreads : omp_get_max_threads();
+#endif
+
+		for ( unsigned int first = 0; first < generationSize; first += blockSize )
+		{
+			int count = std::min( blockSize, generationSize - first );
+
+			#pragma omp parallel for schedule( static ) num_threads( threads )
+			for ( int k = 0; k < count; k++ )
+			{
+				RandStream stream( initSeed, first + k );
+
+				T *genes = newGeneration->genes( first + k );
+
+				for ( unsigned int j = 0; j < chromosomeSize; j++ )
+				{
+					genes[ j ] = randFunction( minRand, maxRand, stream );
+				}
+
+				newGeneration->setFitness( first + k, 0 );
+			}
+		}
+
+		initialized = true;
+
+		return true;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::setMutationRate( double rate )
+	{
+		mutationRate = rate;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::setCrossOverRate( double rate )
+	{
+		crossOverRate = rate;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::setCrossPointRange( double min, double max )
+	{
+		assert ( min >= 0 );
+		assert ( max <= 100 );
+		assert ( max >= min );
+
+		minCrossValue = min;
+		maxCrossValue = max;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::setSrandValue( long int value )
+	{
+		srandValue = value;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::setNumberOfThreads( unsigned int value )
+	{
+		numberOfThreads = value;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::setBlockSize( unsigned int value )
+	{
+		assert( value > 0 );
+		blockSize = value;
+	}
+
+	template <class T>
+	const unsigned int MappedGenSolver<T>::bestChromosome() const
+	{
+		return _bestChromosome;
+	}
+
+	template <class T>
+	const unsigned int MappedGenSolver<T>::getCurrentGeneration()
+	{
+		return _currentGeneration;
+	}
+
+	template <class T>
+	void MappedGenSolver<T>::foundSolution()
+	{
+		_solution = true;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenSolver
+
+		Member:		parseChromosomes
+
+		Description:	calls parseBlock() for all blocks of newGeneration
+				and finds the fittest chromosome
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void MappedGenSolver<T>::parseChromosomes()
+	{
+		unsigned int size = newGeneration->numberOfChromosomes();
+
+		newGeneration->adviseAccess( true );
+
+		_bestChromosome = 0;
+
+		for ( unsigned int first = 0; first < size; first += blockSize )
+		{
+			unsigned int count = std::min( blockSize, size - first );
+
+			parseBlock( first, count );
+
+			for ( unsigned int i = first; i < first + count; i++ )
+			{
+				if ( newGeneration->fitness( i ) > newGeneration->fitness( _bestChromosome ) )
+				{
+					_bestChromosome = i;
+				}
+			}
+
+			if ( _solution ) break;
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenSolver
+
+		Member:		grabChromosome
+
+		Description:	chooses a chromosome of oldGeneration dependant on its
+				fitness (binary search on the accumulated fitness)
+
+		Input:		random stream
+
+		Output:		index of the chromosome
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	const unsigned int MappedGenSolver<T>::grabChromosome( RandStream &stream ) const
+	{
+		unsigned int size = oldGeneration->numberOfChromosomes();
+
+		double totalFitness = oldGeneration->accumulatedFitness( size - 1 );
+
+		if ( totalFitness <= 0 )
+		{
+			return stream.randInt( 0, size - 1 );
+		}
+
+		double randomFitness = stream.randFloat() * totalFitness;
+
+		unsigned int low = 0;
+		unsigned int high = size - 1;
+
+		while ( low < high )
+		{
+			unsigned int mid = low + ( high - low ) / 2;
+
+			if ( oldGeneration->accumulatedFitness( mid ) > randomFitness )
+			{
+				high = mid;
+			}
+			else
+			{
+				low = mid + 1;
+			}
+		}
+
+		return low;
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenSolver
+
+		Member:		breed
+
+		Description:	creates the chromosomes 2 * pair and 2 * pair + 1 of
+				newGeneration (crossover and mutation)
+
+		Input:		index of the pair, genes of both parents, random
+				stream
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void MappedGenSolver<T>::breed( unsigned int pair, const T *parent1, const T *parent2, RandStream &stream )
+	{
+		unsigned int size = newGeneration->sizeOfChromosome();
+
+		T *baby1 = newGeneration->genes( 2 * pair );
+		T *baby2 = newGeneration->genes( 2 * pair + 1 );
+
+		unsigned int crossPoint = 0;
+
+		if ( stream.randFloat() < crossOverRate )
+		{
+			crossPoint = stream.randInt( int( ( size - 1 ) / 100. * minCrossValue ),
+			                             int( ( size - 1 ) / 100. * maxCrossValue ) );
+		}
+
+		memcpy( baby1, parent1, crossPoint * sizeof( T ) );
+		memcpy( baby1 + crossPoint, parent2 + crossPoint, ( size - crossPoint ) * sizeof( T ) );
+
+		memcpy( baby2, parent2, crossPoint * sizeof( T ) );
+		memcpy( baby2 + crossPoint, parent1 + crossPoint, ( size - crossPoint ) * sizeof( T ) );
+
+		for ( unsigned int j = 0; j < size; j++ )
+		{
+			if ( stream.randFloat() < mutationRate ) baby1[ j ] = randFunction( minRandValue, maxRandValue, stream );
+			if ( stream.randFloat() < mutationRate ) baby2[ j ] = randFunction( minRandValue, maxRandValue, stream );
+		}
+
+		newGeneration->setFitness( 2 * pair, 0 );
+		newGeneration->setFitness( 2 * pair + 1, 0 );
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenSolver
+
+		Member:		createNewGeneration
+
+		Description:	Swaps the generations and breeds the new generation
+				block by block. Each pair uses its own random stream,
+				so the result does not depend on the number of
+				threads. The parents of a block are selected first
+				and read in ascending order into parentBuffer.
+
+		Input:		-
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void MappedGenSolver<T>::createNewGeneration()
+	{
+		MappedGenerationClass <T> *tmpPointer = oldGeneration;
+		oldGeneration = newGeneration;
+		newGeneration = tmpPointer;
+
+		oldGeneration->accumulateFitness();
+
+		// parents are read in sorted order, children are written sequentially
+		oldGeneration->adviseAccess( true );
+		newGeneration->adviseAccess( true );
+
+		unsigned long generationSeed = breedStream.next();
+
+		unsigned int numberOfPairs = newGeneration->numberOfChromosomes() / 2;
+		unsigned int pairsPerBlock = std::max( 1u, blockSize / 2 );
+		unsigned int size = newGeneration->sizeOfChromosome();
+
+		pairStreams.resize( std::min( pairsPerBlock, numberOfPairs ) );
+		parentReads.resize( 2 * pairStreams.size() );
+		parentBuffer.resize( parentReads.size() * size );
+
+#ifdef _OPENMP
+		int threads = numberOfThreads > 0 ? numberOfThreads : omp_get_max_threads();
+#endif
+
+		for ( unsigned int first = 0; first < numberOfPairs; first += pairsPerBlock )
+		{
+			int count = std::min( pairsPerBlock, numberOfPairs - first );
+
+			/*---- selection ----*/
+
+			#pragma omp parallel for schedule( static ) num_threads( threads )
+			for ( int k = 0; k < count; k++ )
+			{
+				pairStreams[ k ].seed( generationSeed, first + k );
+
+				parentReads[ 2 * k ] = std::make_pair( grabChromosome( pairStreams[ k ] ), 2 * k );
+				parentReads[ 2 * k + 1 ] = std::make_pair( grabChromosome( pairStreams[ k ] ), 2 * k + 1 );
+			}
+
+			/*---- read the parents in ascending order ----*/
+
+			std::sort( parentReads.begin(), parentReads.begin() + 2 * count );
+
+			#pragma omp parallel for schedule( static ) num_threads( threads )
+			for ( int r = 0; r < 2 * count; r++ )
+			{
+				memcpy( &parentBuffer[ parentReads[ r ].second * size ],
+				        oldGeneration->genes( parentReads[ r ].first ), size * sizeof( T ) );
+			}
+
+			/*---- crossover and mutation ----*/
+
+			#pragma omp parallel for schedule( static ) num_threads( threads )
+			for ( int k = 0; k < count; k++ )
+			{
+				breed( first + k, &parentBuffer[ 2 * k * size ], &parentBuffer[ ( 2 * k + 1 ) * size ],
+				       pairStreams[ k ] );
+			}
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+
+		Class:		MappedGenSolver
+
+		Member:		startSolving
+
+		Description:	This is the final solving algorithm. In contrast to
+				GenSolver::startSolving() the last generation is
+				evaluated, i.e. after this method returns
+				bestChromosome() is valid.
+
+		Input:		maximum number of generations
+
+		Output:		-
+	-----------------------------------------------------------------------------*/
+	template <class T>
+	void MappedGenSolver<T>::startSolving( unsigned int maxGenerations )
+	{
+		assert( initialized );
+
+		for ( unsigned int i = 0; i < maxGenerations; i++ )
+		{
+			if ( i > 0 ) this->createNewGeneration();
+
+			this->parseChromosomes();
+			_currentGeneration = i;
+			cout << "--- New Generation: " << i << " ---"<< endl;
+
+			if ( _solution )
+			{
+				cout << ">> STOPPING: Solution found!" << endl;
+				break;
+			}
+		}
+	}
+}
+
+#endif /*LIBMAPPEDSOLVERTPL_H*/
@@ -22,6 +22,7 @@
 #define LIBNETSOLVER_H
 
 #include <iostream>
+#include <map>
 #include <libgensolver.h>
 #include <libnnet.h>
 
@@ -38,10 +39,516 @@ class NetSolver : public GenFloat::GenSolver
 		virtual void fitnessFunction() = 0;
 		virtual void initialize( unsigned int generationSize, int minRand, int maxRand );
 
+		/**
+		 * Enables population batched evaluation.
+		 *
+		 * The chromosomes are evaluated in blocks of size chromosomes by
+		 * batchFitnessFunction(). All chromosomes share the topology of net.
+		 * A size of 0 or 1 disables batched evaluation (default).
+		 *
+		 * This pays off for small nets. Nets with wide layers are evaluated
+		 * faster one by one (see NNetPlan::dense()).
+		 */
+		void setBatchSize( unsigned int size );
+
+		/**
+		 * Fitness function of the batched evaluation.
+		 *
+		 * Evaluates the chromosomes in actualEntities. Use sendSignals() to
+		 * evaluate all of them for one input sample. The default implementation
+		 * calls fitnessFunction() for each chromosome.
+		 */
+		virtual void batchFitnessFunction();
+
+		/**
+		 * Evaluates all chromosomes in actualEntities for several input samples.
+		 *
+		 * @param inputs	numberOfSamples rows with one entry per input cell of net.
+		 * @param numberOfSamples Number of samples.
+		 * @param outputs	numberOfSamples * actualEntities.size() rows (the chromosomes
+		 *			of sample 0 first) with one entry per output cell of net.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool sendSignals( const double *inputs, unsigned int numberOfSamples, double *outputs );
+
+		/**
+		 * Enables the memetic (Lamarckian) refinement.
+		 *
+		 * After each generation has been evaluated the best numberOfIndividuals
+		 * chromosomes are improved by steps steps of gradient descent on the
+		 * training data (see setTrainingData() and NNet::gradientDescent()).
+		 * The improved weights are written back into the chromosomes, which
+		 * are evaluated again (one evaluation each). The fitness function
+		 * should therefore reward a small error on the training data.
+		 * Requires a feed forward net. 0 disables the refinement (default).
+		 */
+		void setMemeticRefinement( unsigned int numberOfIndividuals, unsigned int steps, double learningRate );
+
+		/**
+		 * Sets the training data of the memetic refinement. The data is copied.
+		 *
+		 * @param inputs	numberOfSamples rows with one entry per input cell of net.
+		 * @param targets	numberOfSamples rows with one entry per output cell of net.
+		 * @param numberOfSamples Number of samples.
+		 */
+		void setTrainingData( const double *inputs, const double *targets, unsigned int numberOfSamples );
+
+		/**
+		 * Sets the training data, the input and target values of the samples are
+		 * copied. The dataset needs one input value per input cell of net and one
+		 * target value per output cell.
+		 */
+		void setTrainingData( const NNetDataset &data );
+
+		/**
+		 * Enables the evaluation on the training data with racing.
+		 *
+		 * NetSolver computes the fitness itself as 1 / ( 1 + mean squared error )
+		 * on the training data (see setTrainingData()), fitnessFunction() and
+		 * batchFitnessFunction() are not called. The samples are evaluated in
+		 * mini-batches (see setMiniBatchSize()) in a random order that is the same
+		 * for all chromosomes of a generation. After each mini-batch the evaluation
+		 * of a chromosome is aborted if even the lower bound
+		 * mean - deviations * standard error (with finite population correction) of
+		 * its error is larger than the error of the selectedFraction * generation
+		 * size best chromosome that has been evaluated completely in this
+		 * generation (or in the last generation as long as there are not enough of
+		 * them). An aborted chromosome gets the fitness of its estimated error.
+		 * The bigger the dataset and the smaller selectedFraction the more
+		 * evaluations are saved (see evaluatedSampleFraction()). The bound is
+		 * updated after each group of chromosomes, which are evaluated in
+		 * parallel (see setEvaluationGroupSize()), setBatchSize() is ignored.
+		 * Requires a feed forward net. A fraction of 0 disables racing (default).
+		 *
+		 * @param selectedFraction Fraction of the generation that is evaluated completely
+		 *			(e.g. 0.25).
+		 * @param deviations	Number of standard errors of the lower bound.
+		 */
+		void enableRacing( double selectedFraction, double deviations = 3.0 );
+
+		/**
+		 * Number of samples per mini-batch of the racing and of the stochastic
+		 * fitness (default: 256).
+		 */
+		void setMiniBatchSize( unsigned int size );
+
+		/**
+		 * Enables the stochastic fitness.
+		 *
+		 * Each generation number mini-batches are chosen randomly from the
+		 * training data and all chromosomes of the generation are evaluated on
+		 * these samples only (see enableRacing() for the fitness). Can be combined
+		 * with racing. 0 uses all samples (default).
+		 *
+		 * @param number	Number of mini-batches per generation.
+		 */
+		void setMiniBatchesPerGeneration( unsigned int number );
+
+		/**
+		 * Fraction of the samples of the training data evaluated per chromosome in
+		 * the last generation (1 if every chromosome has been evaluated on all
+		 * samples).
+		 */
+		double evaluatedSampleFraction() const;
+
+		/**
+		 * Enables the incremental evaluation of mutated chromosomes.
+		 *
+		 * Uses the evaluation on the training data (see enableRacing(), without
+		 * racing and stochastic fitness all chromosomes are evaluated on all
+		 * samples). The activations of all cells for all samples of the cacheSize
+		 * best completely evaluated chromosomes of a generation are kept. A
+		 * chromosome of the next generation that differs from one of them in at
+		 * most maxChangedWeights weights (e.g. a child without crossover) is
+		 * evaluated with NNet::updateSignals(), i.e. only the cells behind the
+		 * changed weights are computed again. Such chromosomes are always
+		 * evaluated completely (no racing). The fitness equals the fitness of the
+		 * normal evaluation up to rounding. Needs about
+		 * ( 2 * cacheSize + group size ) * samples * cells doubles of memory (see
+		 * setEvaluationGroupSize()). Not used with the stochastic fitness (see
+		 * setMiniBatchesPerGeneration()) and the topology evolution. A cache size
+		 * of 0 disables the incremental evaluation (default).
+		 *
+		 * @param maxChangedWeights Maximum number of different weights.
+		 * @param cacheSize	Number of chromosomes whose activations are kept.
+		 */
+		void enableIncrementalEvaluation( unsigned int maxChangedWeights, unsigned int cacheSize );
+
+		/**
+		 * Number of chromosomes of the last generation that have been evaluated
+		 * incrementally.
+		 */
+		unsigned int numberOfIncrementalEvaluations() const;
+
+		/**
+		 * Parallelization of the evaluation on the training data.
+		 */
+		enum ParallelEvaluation
+		{
+			AUTOMATIC_PARALLELISM,	///< chooses one of the following
+			ACROSS_CHROMOSOMES,	///< one chromosome per thread
+			ACROSS_SAMPLES		///< the mini-batches of one chromosome are distributed
+		};
+
+		/**
+		 * Sets the parallelization of the evaluation on the training data (see
+		 * enableRacing()).
+		 *
+		 * The chromosomes are evaluated in groups (see setEvaluationGroupSize())
+		 * with the threads of setNumberOfThreads(). ACROSS_CHROMOSOMES is
+		 * efficient for big generations and small datasets, ACROSS_SAMPLES for
+		 * small generations (e.g. refinement of few individuals) and big
+		 * datasets: the threads evaluate consecutive mini-batches of one
+		 * chromosome, the racing check follows after each round.
+		 * AUTOMATIC_PARALLELISM uses ACROSS_CHROMOSOMES if the generation (or the
+		 * refined individuals) has at least two chromosomes per thread or the
+		 * dataset has less than two mini-batches per thread (default). The error
+		 * sums of the mini-batches are always added in the same order, i.e. the
+		 * fitness doesn't depend on the mode (nor on the number of threads if the
+		 * group size is fixed).
+		 *
+		 * @param mode		The parallelization.
+		 */
+		void setParallelEvaluation( ParallelEvaluation mode );
+
+		/**
+		 * Parallelization used for the last group of chromosomes.
+		 */
+		ParallelEvaluation lastParallelism() const;
+
+		/**
+		 * Sets the number of chromosomes that are evaluated in parallel before the
+		 * racing bound and the cache of enableIncrementalEvaluation() are updated.
+		 * Bigger groups keep more threads busy, smaller groups update the bound
+		 * more often. With racing the fitness depends on the group size, so a
+		 * fixed size is needed for results that don't depend on the number of
+		 * threads. 0 chooses the smallest multiple of the number of threads with
+		 * at least 16 and at least two chromosomes per thread (default).
+		 *
+		 * @param size		Number of chromosomes per group.
+		 */
+		void setEvaluationGroupSize( unsigned int size );
+
+		/**
+		 * Units of the crossover.
+		 */
+		enum WeightBlocks
+		{
+			SINGLE_WEIGHTS,		///< every weight (default of PopulationClass)
+			INCOMING_WEIGHTS,	///< the incoming weights of a cell
+			OUTGOING_WEIGHTS	///< the outgoing weights of a cell
+		};
+
+		/**
+		 * Sets the units of the crossover.
+		 *
+		 * The default crossover cuts the weight list anywhere and splits the
+		 * weights of a cell between the parents. With INCOMING_WEIGHTS (default)
+		 * or OUTGOING_WEIGHTS the cross point lies between two cells and the
+		 * babies get the weights of all cells behind it from the other parent,
+		 * i.e. the features learned by a cell are kept. The cells are ordered
+		 * topologically (see NNetPlan::order), i.e. layer by layer for layered
+		 * nets, cells that are not reached from the inputs follow in the order of
+		 * the cells of net. The blocks are derived from the connections of net
+		 * when initialize() is called. The mutation still changes single weights.
+		 * Not used with the topology evolution (see enableTopologyEvolution()).
+		 *
+		 * @param blocks	The units.
+		 */
+		void setWeightBlocks( WeightBlocks blocks );
+
+		/**
+		 * Enables the evolution of the topology (NEAT).
+		 *
+		 * The chromosomes no longer store one weight per connection of net but a
+		 * list of connection genes sorted by innovation number. Each gene consists
+		 * of three values: innovation number, weight and enabled flag (1 or 0).
+		 * The innovation number identifies sender and receiver node of the
+		 * connection and is the same for all chromosomes. The evolution starts with
+		 * all input cells of net connected to all output cells (the rest of the
+		 * topology of net is discarded). Besides the usual weight mutations (see
+		 * setMutationRate()) a chromosome is mutated with the probability
+		 * addConnectionRate by adding a connection and with the probability
+		 * addNodeRate by splitting a connection with a new node. Crossover aligns
+		 * the genes of the parents by innovation number (see crossOver()). Each
+		 * node has a depth (inputs 0, outputs 1, new nodes between the nodes of
+		 * the connection they split) and connections always lead to deeper nodes,
+		 * i.e. all nets are feed forward nets.
+		 *
+		 * During the evaluation net is the union of the topologies of all
+		 * chromosomes, the connections a chromosome doesn't have get the weight 0.
+		 * New genes are added to net with NNet::addCell() and NNet::addConnection()
+		 * which patch the compiled forward pass, net is only generated again (see
+		 * NNet::generateNet()) if more than half of its connections are no longer
+		 * used. Use storeChromosome() to get the net of a chromosome.
+		 *
+		 * The breeding threads (see setNumberOfThreads()) only record the
+		 * structural mutations. They are applied after breeding in the order of
+		 * the chromosomes, i.e. innovation numbers and nodes are assigned as with
+		 * one thread and the result doesn't depend on the number of threads. Must
+		 * be called before initialize(). The memetic refinement is not used in
+		 * this mode.
+		 *
+		 * @param addConnectionRate Probability of adding a connection.
+		 * @param addNodeRate	Probability of adding a node.
+		 */
+		void enableTopologyEvolution( double addConnectionRate, double addNodeRate );
+
+		/**
+		 * Stores the weights of a chromosome (e.g. bestChromosome()) in net.
+		 *
+		 * With topology evolution net contains connections with weight 0 that
+		 * don't belong to the chromosome. They can be removed with
+		 * NNet::prune( 0 ).
+		 *
+		 * @param chromosome	The chromosome.
+		 */
+		void storeChromosome( const GenFloat::ChromosomeClass &chromosome );
+
+		/**
+		 * Number of innovations (connection genes) of the topology evolution.
+		 */
+		unsigned int numberOfInnovations() const;
+
+		/**
+		 * Weight and structural mutations of the topology evolution (see
+		 * enableTopologyEvolution()), otherwise the default mutation.
+		 */
+		void mutate( GenFloat::ChromosomeClass *chromosome );
+		void mutate( GenFloat::ChromosomeClass *chromosome, RandStream &stream );
+
+		/**
+		 * Crossover of the topology evolution: genes with the same innovation
+		 * number are taken randomly from one of the parents, all other genes are
+		 * taken from the fitter parent. Otherwise the crossover of whole cells
+		 * (see setWeightBlocks()).
+		 */
+		void crossOver( const GenFloat::ChromosomeClass &p1, const GenFloat::ChromosomeClass &p2,
+		                GenFloat::ChromosomeClass &baby1, GenFloat::ChromosomeClass &baby2,
+		                RandStream &stream ) const;
+
 		GenFloat::ChromosomeClass * actualEntity;
+
+		/**
+		 * The chromosomes evaluated by batchFitnessFunction().
+		 */
+		vector <GenFloat::ChromosomeClass*> actualEntities;
 	private:
 		void parseChromosomes();
+
+		/**
+		 * Breeds the new generation and applies the structural mutations of the
+		 * topology evolution (see enableTopologyEvolution()).
+		 */
+		void createNewGeneration();
+
+		void parseChromosomeBlocks();
+		void refineChromosomes();
+		void storeBatchWeights();
+		void bindWeights( GenFloat::ChromosomeClass *chromosome );
 		unsigned int actualEntityID;
+
+		unsigned int batchSize;
+
+		/**
+		 * Weights of actualEntities, one column per chromosome.
+		 */
+		vector <double> batchWeights;
+
+		unsigned int memeticIndividuals;
+		unsigned int memeticSteps;
+		double learningRate;
+
+		vector <double> trainingInputs;
+		vector <double> trainingTargets;
+		unsigned int numberOfTrainingSamples;
+
+		/*
+		 * Evaluation on the training data (see enableRacing())
+		 */
+		bool dataFitness() const;
+		void parseChromosomesOnData();
+		void shuffleMiniBatches();
+
+		/**
+		 * Buffers of one thread.
+		 */
+		struct EvaluationContext
+		{
+			vector <double> activations;
+			vector <double> workspace;
+		};
+
+		/**
+		 * State of the evaluation of one chromosome.
+		 */
+		struct DataEvaluation
+		{
+			GenFloat::ChromosomeClass *chromosome;
+
+			// decoded weights if the chromosome can't be used directly
+			vector <double> weights;
+			const double *weightData;
+
+			double maxError;
+			double sum;
+			double sumOfSquares;
+			unsigned int samples;
+			double error;
+
+			// incremental evaluation: activations and cached base (UINT_MAX if none)
+			bool record;
+			vector <double> recordedActivations;
+			unsigned int base;
+		};
+
+		/**
+		 * Evaluates evaluationGroup[ 0 ] ... evaluationGroup[ count - 1 ]
+		 * (chromosome and maxError set) in parallel. total is the number of
+		 * chromosomes of the whole evaluation (see setParallelEvaluation()).
+		 */
+		void evaluateGroup( unsigned int count, unsigned int total );
+		int evaluationThreads() const;
+		unsigned int chromosomesPerGroup() const;
+		void prepareEvaluation( DataEvaluation &evaluation );
+		void evaluateMiniBatch( DataEvaluation &evaluation, unsigned int b, EvaluationContext &context,
+		                        double &sum, double &sumOfSquares ) const;
+		bool addMiniBatch( DataEvaluation &evaluation, unsigned int b, double sum, double sumOfSquares ) const;
+		void finishEvaluation( DataEvaluation &evaluation );
+
+		vector <DataEvaluation> evaluationGroup;
+		vector <EvaluationContext> evaluationContexts;
+		ParallelEvaluation parallelEvaluation;
+		ParallelEvaluation lastParallelEvaluation;
+		unsigned int evaluationGroupSize;
+
+		double racingFraction;
+		double racingDeviations;
+
+		/**
+		 * Error of the selectedFraction * generation size best chromosome
+		 * of the last generation.
+		 */
+		double racingBound;
+		unsigned int miniBatchSize;
+		unsigned int miniBatchesPerGeneration;
+
+		/**
+		 * Mini-batches of the current generation in evaluation order and the
+		 * number of their samples.
+		 */
+		vector <unsigned int> miniBatchOrder;
+		unsigned int numberOfGenerationSamples;
+
+		unsigned long evaluatedSamples;
+		unsigned long evaluatedChromosomes;
+
+		/*
+		 * Incremental evaluation (see enableIncrementalEvaluation())
+		 */
+		bool incrementalEvaluation() const;
+		void cacheActivations( DataEvaluation &evaluation );
+
+		unsigned int maxChangedWeights;
+		unsigned int cacheSize;
+
+		/**
+		 * Activations (see NNet::recordSignals(), one block per mini-batch) and
+		 * weights of the best chromosomes of the last generation.
+		 */
+		vector < vector <double> > cachedActivations;
+		vector < vector <double> > cachedWeights;
+		unsigned int numberOfCachedChromosomes;
+
+		/**
+		 * The same for the current generation and the errors of these chromosomes.
+		 */
+		vector < vector <double> > nextActivations;
+		vector < vector <double> > nextWeights;
+		vector <double> nextErrors;
+
+		unsigned int incrementalEvaluations;
+
+		/*
+		 * Crossover of cells (see setWeightBlocks())
+		 */
+		void updateWeightBlocks();
+		bool crossBlocks( const GenFloat::ChromosomeClass &chromosome ) const;
+
+		WeightBlocks weightBlocks;
+
+		/**
+		 * Chromosome indices of the weights of block b are
+		 * blockWeights[ blockStart[ b ] ] ... blockWeights[ blockStart[ b + 1 ] - 1 ].
+		 */
+		vector <unsigned int> blockStart;
+		vector <unsigned int> blockWeights;
+
+		/*
+		 * Topology evolution (see enableTopologyEvolution())
+		 */
+		void initializeTopology();
+		void updateTopology();
+		void rebuildNet( const vector <char> &used );
+		void addInnovation( unsigned int innovation );
+		void decodeWeights( const GenFloat::ChromosomeClass &chromosome, double *weights,
+		                    unsigned int stride ) const;
+		unsigned int createInnovation( unsigned int sender, unsigned int receiver );
+		unsigned int createNode( unsigned int innovation );
+		void addConnectionGene( GenFloat::ChromosomeClass *chromosome, RandStream &stream );
+		void addNodeGene( GenFloat::ChromosomeClass *chromosome, RandStream &stream );
+		void applyStructuralMutations();
+
+		/**
+		 * Structural mutation recorded by mutate() while breeding, seed of the
+		 * random stream that is used to apply it.
+		 */
+		struct StructuralMutation
+		{
+			GenFloat::ChromosomeClass *chromosome;
+			unsigned long seed;
+			bool addNode;
+			bool addConnection;
+		};
+
+		vector <StructuralMutation> structuralMutations;
+		bool breeding;
+
+		bool topologyEvolution;
+		double addConnectionRate;
+		double addNodeRate;
+
+		unsigned int numberOfInputNodes;
+		unsigned int numberOfOutputNodes;
+
+		/**
+		 * Sender and receiver node of each innovation.
+		 */
+		vector <unsigned int> innovationSender;
+		vector <unsigned int> innovationReceiver;
+		map < pair <unsigned int, unsigned int>, unsigned int > innovationOfConnection;
+
+		/**
+		 * Node that splits each innovation (UINT_MAX if none).
+		 */
+		vector <unsigned int> splitNode;
+
+		/**
+		 * Depth of each node (inputs 0, outputs 1).
+		 */
+		vector <double> nodeDepth;
+
+		/**
+		 * Cell of each node and weight index of each innovation in net
+		 * (UINT_MAX if they are not part of net).
+		 */
+		vector <unsigned int> cellOfNode;
+		vector <unsigned int> weightIndex;
+
+		/**
+		 * Weights of net for the current chromosome.
+		 */
+		vector <double> chromosomeWeights;
 };
 
 #endif /*LIBNETSOLVER_H*/
@@ -26,6 +26,8 @@
 #include <iostream>
 #include <fstream>
 
+#include "libtextreader.h"
+
 #include <File.h>
 #include <HeaderTag.h>
 #include <DoubleField.h>
@@ -185,6 +187,161 @@ class NNetInput : public File
 		DoubleField *field;
 };
 
+/**
+ *	Samples (input values and target values) in contiguous memory.
+ *
+ *	All input values are stored in one matrix with one row of numberOfInputs() values per sample,
+ *	the target values in a second matrix of the same kind. Both matrices start at a 64 byte
+ *	boundary and the rows are not padded, i.e. inputs() can be passed directly to the batch
+ *	functions (NNet::sendSignals( const double*, double*, unsigned int ), NetSolver::sendSignals(),
+ *	QuantizedNNet::sendSignals(), ...) and inputs( n ) to NNet::setInputs() or
+ *	NNetContext::setInputs(). Nothing is parsed or copied per sample.
+ *
+ *	The samples are either added in memory (addSample(), loadData()) or mapped from a binary
+ *	file (openBinaryData()). The binary format is stored in native byte order:
+ *
+ *	<pre>
+ *	header		magic "#NNetDat", version, byte order mark, sizes and offsets of the sections
+ *	inputs		double x numberOfSamples x numberOfInputs
+ *	targets		double x numberOfSamples x numberOfOutputs
+ *	</pre>
+ *
+ *	Mapped samples are read-only and the file has to stay open while the pointers are used.
+ *
+ *	Example:
+ *	@code
+ *	NNetDataset data;
+ *	if ( NNetDataset::convertData( "samples.txt", "samples.bin", 16, 4 ) && data.openBinaryData( "samples.bin" ) )
+ *	{
+ *		std::vector <double> outputs( data.numberOfSamples() * 4 );
+ *		net.sendSignals( data.inputs(), &outputs[ 0 ], data.numberOfSamples() );
+ *	}
+ *	@endcode
+ */
+class NNetDataset
+{
+	public:
+		NNetDataset();
+
+		/**
+		 * Constructor.
+		 *
+		 * @param numberOfInputs	Number of input values per sample.
+		 * @param numberOfOutputs	Number of target values per sample.
+		 */
+		NNetDataset( unsigned int numberOfInputs, unsigned int numberOfOutputs );
+
+		~NNetDataset();
+
+		/**
+		 *			Removes all samples (or closes the binary file) and sets the
+		 *			number of values per sample.
+		 */
+		void create( unsigned int numberOfInputs, unsigned int numberOfOutputs );
+
+		/**
+		 *			Removes all samples or closes the binary file.
+		 */
+		void close();
+
+		/**
+		 *			Reserves memory for numberOfSamples samples.
+		 */
+		void reserve( unsigned int numberOfSamples );
+
+		/**
+		 *			Appends a sample.
+		 *
+		 * @param inputs 	numberOfInputs() input values.
+		 * @param targets 	numberOfOutputs() target values, may be NULL if the
+		 *			dataset has no targets.
+		 * @return 		Returns false if the dataset is mapped from a file.
+		 */
+		bool addSample( const double *inputs, const double *targets );
+
+		/**
+		 *			Appends a sample, the input values are taken from an
+		 *			NNetInput file.
+		 */
+		bool addSample( const NNetInput &input, const double *targets );
+
+		/**
+		 *			Loads a text file with whitespace separated numbers, numberOfInputs
+		 *			input values followed by numberOfOutputs target values per sample
+		 *			(usually one sample per line). Lines starting with '#' are comments.
+		 *
+		 * @param fileName 	Filename with path.
+		 * @return 		Returns true if successful and false otherwise.
+		 */
+		bool loadData( std::string fileName, unsigned int numberOfInputs, unsigned int numberOfOutputs );
+
+		/**
+		 *			Saves the samples in the binary format.
+		 *
+		 * @param fileName 	Filename with path.
+		 * @return 		Returns true if successful and false otherwise.
+		 */
+		bool saveBinaryData( std::string fileName ) const;
+
+		/**
+		 *			Maps a binary file. The samples are neither parsed nor copied.
+		 *
+		 * @param fileName 	Filename with path.
+		 * @return 		Returns true if the file is valid and false otherwise.
+		 */
+		bool openBinaryData( std::string fileName );
+
+		/**
+		 *			Converts a text file (see loadData()) to the binary format.
+		 */
+		static bool convertData( std::string textFileName, std::string binaryFileName,
+		                         unsigned int numberOfInputs, unsigned int numberOfOutputs );
+
+		const unsigned int numberOfSamples() const;
+		const unsigned int numberOfInputs() const;
+		const unsigned int numberOfOutputs() const;
+
+		/**
+		 *			Returns true if the samples are mapped from a file.
+		 */
+		const bool isMapped() const;
+
+		/**
+		 *			Input matrix (numberOfSamples() rows with numberOfInputs() values)
+		 *			and the row of sample n.
+		 */
+		const double *inputs() const;
+		const double *inputs( unsigned int n ) const;
+
+		/**
+		 *			Target matrix (numberOfSamples() rows with numberOfOutputs() values)
+		 *			and the row of sample n.
+		 */
+		const double *targets() const;
+		const double *targets( unsigned int n ) const;
+
+	private:
+		NNetDataset( const NNetDataset & );
+		NNetDataset & operator=( const NNetDataset & );
+
+		unsigned int samples;
+		unsigned int inputsPerSample;
+		unsigned int outputsPerSample;
+
+		/**
+		 *			Aligned memory of both matrices (see reserve()) and the number
+		 *			of samples it can store.
+		 */
+		double *memory;
+		unsigned int capacity;
+
+		void *mapping;
+		size_t mappingSize;
+
+		const double *inputData;
+		const double *targetData;
+};
+
 /**
 		 *		Internal class, representing a connection between two cells
 		 */
@@ -211,13 +368,381 @@ class netConnection
 };
 
 
+/**
+ *	Activation functions of the compiled forward pass (see NNet::setActivation()).
+ *
+ *	Sigmoid and tanh are available in three precision tiers:
+ *
+ *	- EXACT		libm exp() and tanh().
+ *	- APPROXIMATE	Rational minimax approximation of tanh (sigmoid( x ) = 0.5 + 0.5 * tanh( x / 2 )),
+ *			only multiplications, additions and one division, i.e. vectorizable.
+ *	- TABLE		Linear interpolation in a table with 4096 intervals (sigmoid on [-16, 16],
+ *			tanh on [-8, 8]).
+ *
+ *	Measured maximum absolute errors (10^7 points in [-20, 20]):
+ *
+ *	<pre>
+ *			APPROXIMATE	TABLE
+ *	sigmoid		1.1e-7		7.4e-7
+ *	tanh		2.2e-7		1.5e-6
+ *	</pre>
+ *
+ *	ReLU and softsign are always exact.
+ */
+class Activation
+{
+	public:
+		enum Function { SIGMOID, TANH, RELU, SOFTSIGN };
+		enum Precision { EXACT, APPROXIMATE, TABLE };
+
+		Activation( Function function = SIGMOID, Precision precision = EXACT );
+
+		/**
+		 *			Computes y[ i ] = f( x[ i ] ) for i = 0 ... n - 1.
+		 */
+		void apply( const double *x, double *y, unsigned int n ) const;
+
+		double operator()( double x ) const;
+
+		/**
+		 *			Returns the derivative f'( x ) (exact, independent of the precision).
+		 */
+		double derivative( double x ) const;
+
+		const Function function() const;
+		const Precision precision() const;
+
+	private:
+		Function _function;
+		Precision _precision;
+};
+
+/**
+ *	Compiled forward pass of a NNet.
+ *
+ *	The topology of the net is compiled once (see NNet::compile()). The connections are stored
+ *	in CSR format, i.e. the targets and weights of all connections are stored in two contiguous
+ *	arrays. The outgoing connections of cell i are found at the positions rowStart[i] to
+ *	rowStart[i+1]-1. The cells are stored in the order of NNet::allCells and the connections of
+ *	each cell in the order of Cell::connections. This is the same order as used by
+ *	NNet::setWeights().
+ *
+ *	The forward pass visits all cells that can be reached from the input cells in topological
+ *	order. Each cell computes its sigmoid once and sends it to all connected cells. All
+ *	activations are stored in one flat buffer (one entry per cell).
+ *
+ *	Nets that consist of fully connected layers (as built by NNet::createNet()) are detected
+ *	and evaluated layer by layer as dense matrix-vector products. The weights of layer l are
+ *	a row-major matrix (one row per sender) and start at rowStart[layerStart[l]].
+ */
+class NNetPlan
+{
+	public:
+		NNetPlan();
+
+		/**
+		 *			Compiles the topology.
+		 *
+		 * @param allCells	All cells of the net (Cell::netIndex must be the index).
+		 * @param inputCells	The input cells.
+		 * @param outputCells	The output cells.
+		 * @return		Returns true if the net is a feed forward net (no cycles) and false otherwise.
+		 */
+		bool compile( const std::vector <Cell*> &allCells, const std::vector <Cell*> &inputCells,
+		              const std::vector <Cell*> &outputCells );
+
+		/**
+		 *			Compiles a topology that is already stored in CSR format.
+		 *
+		 * @param numberOfCells	Number of cells.
+		 * @param inputs	Indices of the input cells.
+		 * @param outputs	Indices of the output cells.
+		 * @param rowStart	numberOfCells + 1 entries.
+		 * @param targets	rowStart[ numberOfCells ] entries.
+		 * @param weights	rowStart[ numberOfCells ] entries. If NULL, external weights
+		 *			have to be bound (see bindWeights()).
+		 * @return		Returns true if the net is a feed forward net (no cycles) and false otherwise.
+		 */
+		bool compile( unsigned int numberOfCells, const std::vector <unsigned int> &inputs,
+		              const std::vector <unsigned int> &outputs, const unsigned int *rowStart,
+		              const unsigned int *targets, const double *weights );
+
+		/**
+		 *			Returns true if the compiled net doesn't contain cycles.
+		 */
+		const bool feedForward() const;
+
+		/**
+		 *			Returns true if the net consists of fully connected layers.
+		 */
+		const bool dense() const;
+
+		/**
+		 *			Returns true if the net contains cycles.
+		 *
+		 *			The connections that close a cycle (back edges, found by a depth
+		 *			first search from the input cells) are delayed by one time step,
+		 *			all other connections form a feed forward net (see step()).
+		 */
+		const bool recurrent() const;
+
+		/**
+		 *			One time step of a recurrent net.
+		 *
+		 *			The back edges send the signals of the previous time step, all
+		 *			other connections send the signals of the current time step. The
+		 *			buffers must not overlap.
+		 * @param previous	Activations of the previous time step (one entry per cell).
+		 * @param current	Activations of the current time step (one entry per cell).
+		 *			The input cells have to be set, all other cells have to be 0.
+		 * @param workspace	Buffer with one entry per cell.
+		 * @param weights	Weights to use instead of weightData() (optional).
+		 */
+		void step( const double *previous, double *current, double *workspace,
+		           const double *weights = NULL ) const;
+
+		/**
+		 *			Forward pass.
+		 *
+		 *			The activations of the input cells (and of all other cells if
+		 *			memory is enabled) have to be set before.
+		 * @param activations	Activation buffer with one entry per cell.
+		 * @param workspace	Buffer with one entry per cell.
+		 * @param weights	Weights to use instead of weightData() (optional).
+		 */
+		void forward( double *activations, double *workspace, const double *weights = NULL ) const;
+
+		/**
+		 *			Forward pass for several samples.
+		 *
+		 *			The activations are stored cell by cell, i.e. the activation of
+		 *			cell c for sample i is activations[ c * count + i ]. Each weight is
+		 *			loaded once for all samples.
+		 * @param activations	Activation buffer with numberOfCells() * count entries.
+		 * @param count		Number of samples.
+		 * @param workspace	Buffer with numberOfCells() * count entries.
+		 * @param weights	Weights to use instead of weightData() (optional).
+		 */
+		void forwardBatch( double *activations, unsigned int count, double *workspace,
+		                   const double *weights = NULL ) const;
+
+		/**
+		 *			Incremental forward pass for several samples.
+		 *
+		 *			Computes the activations for the current weights from the
+		 *			activations of other weights (e.g. the parent of a mutated
+		 *			chromosome). Only the receivers of connections with a changed
+		 *			weight and the cells behind them are computed again, their
+		 *			activations are updated by the differences of the signals, i.e.
+		 *			the result equals forwardBatch() up to rounding. Pays off if few
+		 *			weights are changed. Layout as in forwardBatch().
+		 * @param baseActivations Activations of baseWeights after forwardBatch().
+		 * @param baseWeights	Weights baseActivations belong to.
+		 * @param activations	Activation buffer with numberOfCells() * count entries.
+		 * @param count		Number of samples.
+		 * @param workspace	Buffer with 2 * count entries.
+		 * @param weights	Weights to use instead of weightData() (optional).
+		 */
+		void forwardDelta( const double *baseActivations, const double *baseWeights, double *activations,
+		                   unsigned int count, double *workspace, const double *weights = NULL ) const;
+
+		/**
+		 *			Forward pass for several weight sets and samples.
+		 *
+		 *			Each weight set uses its own weights, i.e. the weight of connection e
+		 *			for weight set p is weights[ e * count + p ]. The activation of cell c
+		 *			for sample i and weight set p is
+		 *			activations[ ( c * numberOfSamples + i ) * count + p ]. Each weight is
+		 *			loaded once for all samples.
+		 * @param activations	Activation buffer with numberOfCells() * numberOfSamples * count entries.
+		 * @param weights	Weight matrix with numberOfConnections() * count entries.
+		 * @param count		Number of weight sets.
+		 * @param numberOfSamples Number of samples.
+		 * @param workspace	Buffer with numberOfSamples * count entries.
+		 */
+		void forwardPopulation( double *activations, const double *weights, unsigned int count,
+		                        unsigned int numberOfSamples, double *workspace ) const;
+
+		/**
+		 *			Backward pass (backpropagation) of a feed forward net.
+		 *
+		 *			Propagates the derivatives of an error function with respect to
+		 *			the activations back through the net and adds the derivatives
+		 *			with respect to the weights to gradient.
+		 * @param activations	Activations after forward() (one entry per cell).
+		 * @param deltas	One entry per cell. On entry the derivatives of the error
+		 *			with respect to the activations of the output cells, all
+		 *			other entries 0. On exit the derivatives for all cells.
+		 * @param gradient	numberOfConnections() entries (order of weights), the
+		 *			derivatives are added.
+		 * @param weights	Weights to use instead of weightData() (optional).
+		 */
+		void backward( const double *activations, double *deltas, double *gradient,
+		               const double *weights = NULL ) const;
+
+		/**
+		 *			Adds a cell without connections.
+		 *
+		 * @return		Index of the new cell.
+		 */
+		unsigned int addCell();
+
+		/**
+		 *			Adds a connection without compiling the topology again.
+		 *
+		 *			The connection is appended to the connections of the sender,
+		 *			i.e. it gets the index rowStart[ sender + 1 ] - 1 and the index of
+		 *			all connections of later cells increases by one. The topological
+		 *			order of feed forward nets is patched locally: cells that are
+		 *			reached through the new connection are inserted behind the
+		 *			sender, and if the receiver was in front of the sender, only the
+		 *			cells between receiver and sender that depend on the receiver
+		 *			are moved. Only if this is not possible (the connection closes
+		 *			a cycle, recurrent nets) is the topology compiled again.
+		 *			External weights are released (their number changes).
+		 *
+		 * @param sender	Index of the sender.
+		 * @param receiver	Index of the receiver.
+		 * @param weight	The weight.
+		 * @return		Returns true if the net is still a feed forward net and false otherwise.
+		 */
+		bool addConnection( unsigned int sender, unsigned int receiver, double weight );
+
+		const unsigned int numberOfCells() const;
+		const unsigned int numberOfConnections() const;
+
+		/**
+		 *			Uses external weights (numberOfConnections() entries in the order
+		 *			of weights) instead of weights. The weights are not copied. NULL
+		 *			switches back to weights.
+		 */
+		void bindWeights( const double *weights );
+
+		/**
+		 *			Returns the weights used by the forward pass.
+		 */
+		const double *weightData() const;
+
+		/**
+		 *			Cells that send signals, in topological order.
+		 */
+		std::vector <unsigned int> order;
+
+		/**
+		 *			Index of the first outgoing connection of each cell (numberOfCells() + 1 entries).
+		 */
+		std::vector <unsigned int> rowStart;
+
+		/**
+		 *			Receiver of each connection.
+		 */
+		std::vector <unsigned int> targets;
+
+		/**
+		 *			Weight of each connection.
+		 */
+		std::vector <double> weights;
+
+		/**
+		 *			Indices of the input and output cells.
+		 */
+		std::vector <unsigned int> inputs;
+		std::vector <unsigned int> outputs;
+
+		/**
+		 *			Index of the first cell of each layer (only valid if dense() is true).
+		 */
+		std::vector <unsigned int> layerStart;
+
+		/**
+		 *			The activation function.
+		 */
+		Activation activation;
+
+	private:
+		bool isFeedForward;
+		bool isDense;
+		bool isRecurrent;
+		const double *boundWeights;
+
+		/**
+		 *			Forward connections of recurrent nets, for each cell in order.
+		 */
+		std::vector <unsigned int> sweepStart;
+		std::vector <unsigned int> sweepEdges;
+
+		/**
+		 *			Back edges of recurrent nets, grouped by sender.
+		 */
+		std::vector <unsigned int> recurrentSenders;
+		std::vector <unsigned int> recurrentStart;
+		std::vector <unsigned int> recurrentEdges;
+
+		/**
+		 *			Compiles the CSR topology.
+		 */
+		bool compileTopology();
+
+		/**
+		 *			Compiles nets with cycles.
+		 */
+		bool compileRecurrent( const std::vector <unsigned int> &reachedCells );
+
+		/**
+		 *			Detects fully connected layers.
+		 */
+		bool detectLayers();
+
+		/**
+		 *			Layer by layer forward pass of dense nets.
+		 */
+		void forwardDense( double *activations, double *workspace, const double *weights ) const;
+		void forwardBatchDense( double *activations, unsigned int count, double *workspace,
+		                        const double *weights ) const;
+};
+
+/**
+ *	Result of NNet::prune().
+ */
+struct PruningReport
+{
+	PruningReport();
+
+	/**
+	 *			Prints the report.
+	 */
+	void print( std::ostream &out = std::cout ) const;
+
+	unsigned int cellsBefore;
+	unsigned int cellsAfter;
+	unsigned int connectionsBefore;
+	unsigned int connectionsAfter;
+
+	/**
+	 *			Time of one compiled forward pass in seconds and the ratio
+	 *			secondsBefore / secondsAfter.
+	 */
+	double secondsBefore;
+	double secondsAfter;
+	double speedup;
+
+	/**
+	 *			Largest absolute change of an output for the samples passed
+	 *			to NNet::prune() (0 if there are none).
+	 */
+	double maxOutputChange;
+};
+
 /**
  * 	Basic neural network class.
  *
  *	This is an attempt to create a basic neural network class based on Cell classes. It only has one
  *	method that starts the send process. You can build networks that don't have to be feedforward nets.
- *	Of course there are input and output cells. But all cells can be connected freely. But be aware that
- *	if you connect cells of the second layer to cells of the first layer you are in an endless loop!
+ *	Of course there are input and output cells. But all cells can be connected freely.
+ *
+ *	Nets are evaluated by a compiled forward pass (see NNetPlan). If cells of a later layer are
+ *	connected to cells of an earlier layer the net is recurrent, i.e. these connections send the
+ *	signals of the previous call of sendSignals().
  */
 
 
@@ -241,6 +766,9 @@ class NNet
 
 		/**
 		 * Assignment operator
+		 *
+		 * Copies cells, connections, weights and activations. Bound weights
+		 * are copied, too.
 		 */
 		NNet & operator=( const NNet &net );
 
@@ -306,21 +834,240 @@ class NNet
 		 */
 		void setInputs( NNetInput &input );
 
+		/**
+		 * 			Initializes input cells with the input values of sample n.
+		 */
+		void setInputs( const NNetDataset &data, unsigned int n );
+
 		/**
 		 *			Starts the send process.
+		 *
+		 *			For nets with cycles this is one time step (see NNetPlan::step()).
+		 *			The activations of the cells (Cell::signalSum) are the state,
+		 *			reset() starts a new sequence.
 		 */
 		void sendSignals();
 
+		/**
+		 *			Runs a sequence, one sendSignals() call per time step.
+		 *
+		 * @param inputs	numberOfSteps rows with one entry per input cell.
+		 * @param outputs	numberOfSteps rows with one entry per output cell.
+		 * @param numberOfSteps Number of time steps.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool sendSequence( const double *inputs, double *outputs, unsigned int numberOfSteps );
+
+		/**
+		 *			Gradient of the mean squared error.
+		 *
+		 *			Computes E = 1 / ( 2 * numberOfSamples ) * sum of ( output - target )^2
+		 *			over all samples and output cells and its derivatives with respect
+		 *			to the weights by backpropagation (memory disabled). Only feed
+		 *			forward nets are supported.
+		 *
+		 * @param inputs	numberOfSamples rows with one entry per input cell.
+		 * @param targets	numberOfSamples rows with one entry per output cell.
+		 * @param numberOfSamples Number of samples.
+		 * @param gradient	numberOfConnections() entries (order of setWeights()).
+		 * @param error		The error E.
+		 * @param weights	Weights to use instead of the weights of the net (optional).
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool gradient( const double *inputs, const double *targets, unsigned int numberOfSamples,
+		               double *gradient, double &error, const double *weights = NULL );
+
+		/**
+		 *			Gradient descent on the mean squared error (see gradient()).
+		 *
+		 *			Each step changes the weights by -rate * gradient (gradient of all
+		 *			samples). The rate starts at learningRate and is adapted: a step
+		 *			that increases the error is taken back and the rate is halved,
+		 *			otherwise the rate grows by 10 %, i.e. the error never increases.
+		 *			The weights are changed in place, the weights of the net are not
+		 *			affected.
+		 *
+		 * @param weights	numberOfConnections() entries (order of setWeights()).
+		 * @param inputs	numberOfSamples rows with one entry per input cell.
+		 * @param targets	numberOfSamples rows with one entry per output cell.
+		 * @param numberOfSamples Number of samples.
+		 * @param steps		Number of steps.
+		 * @param learningRate	Step size.
+		 * @param error		The error of the changed weights.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool gradientDescent( double *weights, const double *inputs, const double *targets,
+		                      unsigned int numberOfSamples, unsigned int steps, double learningRate,
+		                      double &error );
+
+		/**
+		 *			Batched send process.
+		 *
+		 *			Evaluates the net for several samples in one call. Each sample is
+		 *			evaluated like sendSignals() with memory disabled. The cells are not
+		 *			changed. Only feed forward nets are supported.
+		 *
+		 * @param inputs	Input matrix, numberOfSamples rows with one entry per input cell.
+		 * @param outputs	Output matrix, numberOfSamples rows with one entry per output cell.
+		 * @param numberOfSamples Number of samples.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool sendSignals( const double *inputs, double *outputs, unsigned int numberOfSamples );
+		bool sendSignals( const std::vector<double> &inputs, std::vector<double> &outputs );
+
+		/**
+		 *			Population batched send process.
+		 *
+		 *			Evaluates several samples for several weight sets (i.e. several nets
+		 *			with the same topology) in one call. Each weight set is evaluated like
+		 *			sendSignals() with memory disabled. The cells are not changed.
+		 *			Only feed forward nets are supported.
+		 *
+		 * @param inputs	Input matrix, numberOfSamples rows with one entry per input cell.
+		 * @param numberOfSamples Number of samples.
+		 * @param weights	Weight matrix, numberOfConnections() rows (in the order of
+		 *			setWeights()) with one column per weight set.
+		 * @param numberOfNets	Number of weight sets.
+		 * @param outputs	Output matrix, numberOfSamples * numberOfNets rows (the weight
+		 *			sets of sample 0 first) with one entry per output cell.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool sendSignals( const double *inputs, unsigned int numberOfSamples, const double *weights,
+		                  unsigned int numberOfNets, double *outputs );
+
+		/**
+		 *			Batched send process that keeps the activations of all cells.
+		 *
+		 *			Like sendSignals( inputs, outputs, numberOfSamples ), but the
+		 *			samples are evaluated in one block and the activations of all cells
+		 *			are stored (see NNetPlan::forwardBatch()), e.g. as base of
+		 *			updateSignals(). Only feed forward nets are supported.
+		 *
+		 * @param inputs	Input matrix, numberOfSamples rows with one entry per input cell.
+		 * @param numberOfSamples Number of samples.
+		 * @param activations	numberOfCells() * numberOfSamples entries, the activation of
+		 *			cell c for sample i is activations[ c * numberOfSamples + i ].
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool recordSignals( const double *inputs, unsigned int numberOfSamples, double *activations );
+
+		/**
+		 *			Incremental send process.
+		 *
+		 *			Computes the activations of recordSignals() for the current
+		 *			weights from the activations recorded with other weights. Only
+		 *			the cells behind the changed weights are computed again (see
+		 *			NNetPlan::forwardDelta()), e.g. for a mutated chromosome or a
+		 *			step of a local search. Only feed forward nets are supported.
+		 *
+		 * @param baseActivations Activations recorded with baseWeights.
+		 * @param baseWeights	numberOfConnections() entries (order of setWeights()).
+		 * @param numberOfSamples Number of samples.
+		 * @param activations	Activations for the current weights (same layout).
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool updateSignals( const double *baseActivations, const double *baseWeights,
+		                    unsigned int numberOfSamples, double *activations );
+
 		/**
 		 *               	Loads net from file.
 		 *
 		 *			With this method you can load a net from file.
 		 *
+		 *			Binary files (see saveBinaryNet()) are detected automatically.
+		 *			Text files are parsed in one pass with a fixed size read buffer
+		 *			(see TextReader), the connections are stored directly.
+		 *
 		 * @param fileName 	Filename with path.
 		 * @return 		Returns true if loading was successful and false otherwise.
 		 */
 		bool loadNet( std::string fileName );
 
+		/**
+		 *               	Loads net from binary file (see MappedNNet).
+		 *
+		 * @param fileName 	Filename with path.
+		 * @return 		Returns true if loading was successful and false otherwise.
+		 */
+		bool loadBinaryNet( std::string fileName );
+
+		/**
+		 *               	Saves net as binary file.
+		 *
+		 *			The file contains the compiled topology (CSR format) and the
+		 *			weights. It can be memory-mapped and used without parsing (see
+		 *			MappedNNet).
+		 *
+		 * @param fileName 	Filename with path.
+		 * @return 		Returns true if saving was successful and false otherwise.
+		 */
+		bool saveBinaryNet( std::string fileName );
+
+		/**
+		 *               	Converts a text file (#NNet-File 0.1) to a binary file.
+		 *
+		 * @param textFileName 	Filename of the text file with path.
+		 * @param binaryFileName Filename of the binary file with path.
+		 * @return 		Returns true if converting was successful and false otherwise.
+		 */
+		static bool convertNet( std::string textFileName, std::string binaryFileName );
+
+		/**
+		 *			Removes weak connections and dead cells.
+		 *
+		 *			Connections with |weight| <= threshold are removed. Then all
+		 *			cells that are not reached from the input cells or don't reach
+		 *			an output cell (they don't contribute to the outputs) are removed
+		 *			with their connections. Input and output cells are kept in their
+		 *			order, the remaining cells keep their relative order. The net is
+		 *			compiled again, i.e. the compiled forward pass only visits the
+		 *			remaining connections.
+		 *
+		 *			The number and order of the weights change (see setWeights()).
+		 *			Bound weights are copied.
+		 *
+		 *			Note: a fully connected layered net loses the dense kernel as
+		 *			soon as a single connection is removed. The sparse forward pass
+		 *			is only faster if most connections are removed (see
+		 *			PruningReport::speedup).
+		 *
+		 * @param threshold	Connections with |weight| <= threshold are removed.
+		 * @param report	Optional report (sizes, time of a forward pass before
+		 *			and after pruning, change of the outputs).
+		 * @param samples	Optional samples for the report, numberOfSamples rows
+		 *			with one entry per input cell. Otherwise the forward pass
+		 *			is timed with all inputs 0.
+		 * @param numberOfSamples Number of samples.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool prune( double threshold, PruningReport *report = NULL, const double *samples = NULL,
+		            unsigned int numberOfSamples = 0 );
+
+		/**
+		 *			Adds a cell without connections.
+		 *
+		 *			The net is not compiled again (see NNetPlan::addCell()).
+		 * @return		Index of the new cell.
+		 */
+		unsigned int addCell();
+
+		/**
+		 *			Adds a connection.
+		 *
+		 *			The compiled forward pass is patched instead of compiled again
+		 *			(see NNetPlan::addConnection()). The weight is appended to the
+		 *			weights of the sender, i.e. its index in the order of setWeights()
+		 *			is getPlan().rowStart[ sender + 1 ] - 1 afterwards and the index
+		 *			of the weights of all later cells increases by one. Bound weights
+		 *			are copied (see releaseWeights()).
+		 *
+		 * @param sender	Index of the sender.
+		 * @param receiver	Index of the receiver.
+		 * @param weight	The weight.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool addConnection( unsigned int sender, unsigned int receiver, double weight );
+
 		/**
 		 *               	Saves net as file.
 		 *
@@ -359,6 +1106,64 @@ class NNet
 
 		void setWeights( std::vector<double>newWeights );
 
+		/**
+		 *			Binds external weights without copying them.
+		 *
+		 *			The weights have to be stored contiguously in the order of
+		 *			setWeights() (numberOfConnections() entries) and have to stay valid
+		 *			until they are released, replaced by setWeights() or the net is
+		 *			compiled again. Switching weight sets only costs a pointer
+		 *			assignment. Cell::weights are not updated (see
+		 *			copyWeightsToCells()), saveNet() and copies of the net use the
+		 *			bound weights.
+		 *
+		 * @param weights	Pointer to the first weight.
+		 * @return		Returns true if successful and false if the net is not compiled.
+		 */
+		bool bindWeights( const double *weights );
+
+		/**
+		 *			Releases bound weights. The bound weights are copied (like
+		 *			setWeights()), i.e. the net keeps them.
+		 */
+		void releaseWeights();
+
+		/**
+		 *			Returns true if external weights are bound (see bindWeights()).
+		 */
+		bool weightsBound() const;
+
+		/**
+		 *			Copies the bound weights into Cell::weights, the weights stay
+		 *			bound. Code that reads Cell::weights (e.g. a fitness function)
+		 *			sees the bound weights afterwards.
+		 */
+		void copyWeightsToCells();
+
+		/**
+		 *			Compiles the topology (see NNetPlan).
+		 *
+		 *			This is done automatically by generateNet(), loadNet() and
+		 *			createNet(). It only has to be called if cells have been connected
+		 *			or weights have been changed directly (Cell::connect(), Cell::weights).
+		 */
+		void compile();
+
+		/**
+		 *			Returns the compiled forward pass (e.g. to create NNetContext objects).
+		 */
+		const NNetPlan &getPlan() const;
+
+		/**
+		 * Defines the activation function of the cells (default: exact sigmoid).
+		 *
+		 * Only used by the compiled forward pass, i.e. nets that are not compiled
+		 * always use Cell::sigmoid().
+		 */
+		void setActivation( Activation::Function function,
+		                    Activation::Precision precision = Activation::EXACT );
+		const Activation &activation() const;
+
 		/**
 		 * Defines whether cells are always resetted or not.
 		 */
@@ -377,17 +1182,29 @@ class NNet
 
 		const int getNumberOfCells() const;
 
+		/**
+		 * Frees memory of all cells.
+		 */
+		void clear();
+
 		void generateCells( unsigned int numberOfCells );
+
+		/**
+		 * Generates the net from a topology in CSR format.
+		 */
+		void generateNet( unsigned int numberOfCells, const std::vector <unsigned int> &inputs,
+		                  const std::vector <unsigned int> &outputs, const unsigned int *rowStart,
+		                  const unsigned int *targets, const double *weights );
 		void storeInputCells();
 		void storeOutputCells();
 		void connectCells();
 
 		/*file specific methods*/
 
-		bool readHeaderSection( std::ifstream &f, std::vector <std::string> &headerList );
-		bool readInputSection( std::ifstream &f );
-		bool readOutputSection( std::ifstream &f );
-		bool readConnectionSection( std::ifstream &f );
+		bool readHeaderSection( TextReader &reader );
+		bool readInputSection( TextReader &reader );
+		bool readOutputSection( TextReader &reader );
+		bool readConnectionSection( TextReader &reader );
 
 		void writeHeaderSection( std::ofstream &f, double version ) const;
 		void writeInputSection( std::ofstream &f ) const;
@@ -399,6 +1216,373 @@ class NNet
 		 */
 		bool enableMemory;
 
+		/**
+		 * The compiled forward pass.
+		 */
+		NNetPlan plan;
+
+		/**
+		 * Activation buffer of the forward pass (one entry per cell).
+		 */
+		std::vector <double> activations;
+		std::vector <double> previousActivations;
+		std::vector <double> workspace;
+
+		/**
+		 * Buffers of the batched send process.
+		 */
+		std::vector <double> batchActivations;
+		std::vector <double> batchWorkspace;
+
+		/**
+		 * Buffers of the backward pass.
+		 */
+		std::vector <double> deltas;
+		std::vector <double> gradients;
+		std::vector <double> previousWeights;
+
+		/**
+		 * Computes the mean squared error and (if gradient is not NULL) its gradient.
+		 */
+		double backpropagate( const double *inputs, const double *targets, unsigned int numberOfSamples,
+		                      double *gradient, const double *weights );
+
+		/**
+		 * One time step of a net with cycles.
+		 */
+		void sendSignalsRecurrent();
+
+		/**
+		 * The wavefront algorithm used for nets that are not compiled.
+		 */
+		void sendSignalsWavefront();
+
+};
+
+/**
+ *	Execution context of a NNet.
+ *
+ *	The compiled forward pass of a net (see NNet::getPlan()) is immutable and can be shared by
+ *	several threads. All state of an evaluation (the activations) is stored in a context,
+ *	i.e. each thread should own its own context. A context only needs one allocation. The net
+ *	must not be changed (compiled, weights set) while contexts are used.
+ *
+ *	Only feed forward nets are supported.
+ */
+class NNetContext
+{
+	public:
+		/**
+		 *			Creates a context for the compiled forward pass of net.
+		 */
+		NNetContext( const NNet &net );
+		NNetContext( const NNetPlan &plan );
+
+		/**
+		 *			Sets the value of input cell i (like Cell::firstInput()).
+		 */
+		void setInput( unsigned int i, double value );
+
+		/**
+		 *			Sets the values of all input cells.
+		 */
+		void setInputs( const double *values );
+
+		/**
+		 *			Starts the send process.
+		 *
+		 *			For recurrent nets this is one time step (see NNetPlan::step()),
+		 *			the activations of the previous call are the state.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool sendSignals();
+
+		/**
+		 *			Runs a sequence, one sendSignals() call per time step.
+		 *
+		 * @param inputs	numberOfSteps rows with one entry per input cell.
+		 * @param outputs	numberOfSteps rows with one entry per output cell.
+		 * @param numberOfSteps Number of time steps.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool sendSequence( const double *inputs, double *outputs, unsigned int numberOfSteps );
+
+		/**
+		 *			Returns the value of output cell i (like Cell::finalOutput()).
+		 */
+		const double output( unsigned int i ) const;
+
+		/**
+		 *			Returns the activation (i.e. Cell::signalSum) of cell i.
+		 */
+		const double activation( unsigned int i ) const;
+
+		/**
+		 *			Uses external weights for this context only (see NNet::bindWeights()).
+		 *			NULL switches back to the weights of the net.
+		 */
+		void bindWeights( const double *weights );
+
+		/**
+		 * Defines whether cells are always resetted or not.
+		 */
+		void setMemory( bool value );
+
+		/**
+		 * Resets all activations except the input values.
+		 */
+		void reset();
+
+	private:
+		const NNetPlan *plan;
+
+		/**
+		 * Activations, workspace, activations of the previous time step (one
+		 * entry per cell each) and input values.
+		 */
+		std::vector <double> buffer;
+
+		const double *weights;
+
+		bool enableMemory;
+
+		void initialize();
+};
+
+/**
+ *	Memory-mapped binary net file.
+ *
+ *	The binary format (see NNet::saveBinaryNet()) stores the topology in CSR format. All sections
+ *	are 8 byte aligned and stored in native byte order:
+ *
+ *	<pre>
+ *	header		magic "#NNetBin", version, byte order mark, sizes and offsets of the sections
+ *	inputs		uint32 x numberOfInputs
+ *	outputs		uint32 x numberOfOutputs
+ *	rowStart	uint32 x ( numberOfCells + 1 )
+ *	targets		uint32 x numberOfConnections
+ *	weights		double x numberOfConnections
+ *	</pre>
+ *
+ *	The file is mapped and validated, but not parsed. The compiled forward pass uses the mapped
+ *	weights directly, e.g. via NNetContext. The file has to stay open while the plan is used.
+ */
+class MappedNNet
+{
+	public:
+		MappedNNet();
+
+		/**
+		 *			Opens a binary file.
+		 */
+		MappedNNet( std::string fileName );
+
+		~MappedNNet();
+
+		/**
+		 *			Opens a binary file.
+		 *
+		 * @param fileName 	Filename with path.
+		 * @return 		Returns true if the file is valid and false otherwise.
+		 */
+		bool open( std::string fileName );
+
+		void close();
+
+		/**
+		 *			Returns the compiled forward pass.
+		 */
+		const NNetPlan &getPlan() const;
+
+		const unsigned int numberOfCells() const;
+		const unsigned int numberOfConnections() const;
+
+		/**
+		 *			Pointers to the sections of the file.
+		 */
+		const unsigned int *inputs() const;
+		const unsigned int *outputs() const;
+		const unsigned int *rowStart() const;
+		const unsigned int *targets() const;
+		const double *weights() const;
+
+		const unsigned int numberOfInputs() const;
+		const unsigned int numberOfOutputs() const;
+
+	private:
+		MappedNNet( const MappedNNet & );
+		MappedNNet & operator=( const MappedNNet & );
+
+		void *mapping;
+		size_t mappingSize;
+
+		NNetPlan plan;
+};
+
+/**
+ *	Accuracy of a QuantizedNNet compared to the double precision net (see QuantizedNNet::compare()).
+ */
+struct QuantizationReport
+{
+	QuantizationReport();
+
+	/**
+	 *			Prints the report.
+	 */
+	void print( std::ostream &out = std::cout ) const;
+
+	unsigned int numberOfSamples;
+
+	/**
+	 *			Maximum, mean and root mean square of the absolute output errors.
+	 */
+	double maxError;
+	double meanError;
+	double rmsError;
+
+	/**
+	 *			maxError divided by the largest absolute reference output.
+	 */
+	double relativeError;
+
+	/**
+	 *			Fraction of samples where both nets have the largest value at the
+	 *			same output cell.
+	 */
+	double agreement;
+
+	/**
+	 *			Memory of the connections (indices, weights and scale factors) in bytes.
+	 */
+	unsigned long referenceBytes;
+	unsigned long quantizedBytes;
+};
+
+/**
+ *	Quantized inference-only copy of a feed forward NNet.
+ *
+ *	The weights are stored with reduced precision, grouped by receiving cell, so that each cell
+ *	computes its signal sum as one dot product. If the senders of a cell are consecutive cells
+ *	(e.g. fully connected layers) the activations are read contiguously, otherwise through an
+ *	index array.
+ *
+ *	- INT8	Weight w of a connection to cell r is stored as q = round( w / scale ) with
+ *		|q| <= 127, scale is the largest |w| of cell r (PER_CELL) or of all cells with the
+ *		same distance from the input cells (PER_LAYER) divided by 127. The activations sent
+ *		by the cells are quantized to int8 as well, the products are accumulated in int32.
+ *	- FLOAT16 Weights are stored in IEEE half precision, activations and sums in single
+ *		precision.
+ *
+ *	Example:
+ *	@code
+ *	QuantizedNNet q;
+ *	q.quantize( net, QuantizedNNet::INT8 );
+ *	q.compare( net, samples, numberOfSamples ).print();
+ *	q.sendSignals( inputs, outputs, numberOfSamples );
+ *	@endcode
+ */
+class QuantizedNNet
+{
+	public:
+		enum Format { INT8, FLOAT16 };
+		enum Granularity { PER_CELL, PER_LAYER };
+
+		QuantizedNNet();
+
+		/**
+		 *			Creates the quantized copy of a net.
+		 *
+		 *			The activations sent by the cells are quantized with one scale
+		 *			factor. For sigmoid, tanh and softsign it covers [-1, 1], for relu
+		 *			(and for all functions if samples are given) the largest
+		 *			activation observed for the samples.
+		 *
+		 * @param net		The net, has to be a compiled feed forward net.
+		 * @param format	Storage format.
+		 * @param granularity	Scale factors of INT8 weights.
+		 * @param samples	Calibration samples, numberOfSamples rows with one entry
+		 *			per input cell (optional, required for relu).
+		 * @param numberOfSamples Number of calibration samples.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool quantize( const NNet &net, Format format, Granularity granularity = PER_CELL,
+		               const double *samples = NULL, unsigned int numberOfSamples = 0 );
+
+		/**
+		 *			Evaluates samples (memory disabled).
+		 *
+		 * @param inputs	numberOfSamples rows with one entry per input cell.
+		 * @param outputs	numberOfSamples rows with one entry per output cell.
+		 * @param numberOfSamples Number of samples.
+		 */
+		void sendSignals( const double *inputs, double *outputs, unsigned int numberOfSamples = 1 );
+
+		/**
+		 *			Compares the outputs with the outputs of the double precision net.
+		 *
+		 * @param reference	The net this object was created from.
+		 * @param inputs	numberOfSamples rows with one entry per input cell.
+		 * @param numberOfSamples Number of samples.
+		 * @return		The accuracy report.
+		 */
+		QuantizationReport compare( const NNet &reference, const double *inputs, unsigned int numberOfSamples );
+
+		const Format format() const;
+		const unsigned int numberOfInputs() const;
+		const unsigned int numberOfOutputs() const;
+
+		/**
+		 *			Memory of the connections (indices, weights and scale factors) in bytes.
+		 */
+		const unsigned long memoryUsage() const;
+
+	private:
+		Format _format;
+		Activation activation;
+
+		/**
+		 *			Cells in topological order. For position i the incoming
+		 *			connections are weightStart[ i ] to weightStart[ i + 1 ] - 1.
+		 *			If firstSender[ i ] is not noSender the senders are consecutive
+		 *			cells, otherwise they are stored in senders (from senderStart[ i ]).
+		 */
+		std::vector <unsigned int> order;
+		std::vector <unsigned int> weightStart;
+		std::vector <unsigned int> firstSender;
+		std::vector <unsigned int> senderStart;
+		std::vector <unsigned int> senders;
+		std::vector <char> sends;
+
+		/**
+		 *			Weights (only the vector of the format is used) and the scale
+		 *			factors of INT8 weights (one per position).
+		 */
+		std::vector <signed char> weights8;
+		std::vector <unsigned short> weights16;
+		std::vector <float> scales;
+
+		/**
+		 *			Scale factor of the int8 activations.
+		 */
+		float activationScale;
+
+		std::vector <unsigned int> inputs;
+		std::vector <unsigned int> outputs;
+
+		/**
+		 *			Input slot of each cell (noSender if it is no input cell).
+		 */
+		std::vector <unsigned int> inputSlot;
+
+		/**
+		 *			Signal sums and sent activations of the current sample.
+		 */
+		std::vector <float> sums;
+		std::vector <signed char> activations8;
+		std::vector <float> activations;
+
+		void forwardInt8( const double *values );
+		void forwardFloat16( const double *values );
 };
 
 #endif /*LIBNNET_H*/
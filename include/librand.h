@@ -35,4 +35,56 @@ double randFloat( int x, int y );
 
 int randInt( int x, int y );
 
+/**
+ * Reentrant random number stream.
+ *
+ * Unlike the functions above this class does not use the global state of
+ * rand(). Each object carries its own state, so several streams can be used
+ * concurrently (one per thread or per task) and the sequence of one stream
+ * only depends on the values it was seeded with.
+ */
+class RandStream
+{
+	public:
+		/**
+		 * Constructor.
+		 *
+		 * @param seed		Seed value.
+		 * @param streamIndex	Index of the sub stream. Streams with equal seed but
+		 *			different index produce independent sequences.
+		 */
+		RandStream( unsigned long seed = 0, unsigned long streamIndex = 0 );
+
+		/**
+		 * Reinitializes the stream.
+		 *
+		 * @param seed		Seed value.
+		 * @param streamIndex	Index of the sub stream.
+		 */
+		void seed( unsigned long seed, unsigned long streamIndex = 0 );
+
+		/**
+		 * Returns a raw 32 bit random number.
+		 */
+		unsigned long next();
+
+		/**
+		 * Returns a random number between 0 and 1 ( 0 <= value < 1 ).
+		 */
+		double randFloat();
+
+		/**
+		 * Returns a random number between x and y (same semantics as ::randFloat( x, y )).
+		 */
+		double randFloat( int x, int y );
+
+		/**
+		 * Returns a random number between x and y ( x <= value <= y ).
+		 */
+		int randInt( int x, int y );
+
+	private:
+		unsigned long long state;
+};
+
 #endif /*LIBRAND_H*/
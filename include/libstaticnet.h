@@ -0,0 +1,462 @@
+/***************************************************************************
+*   Copyright (C) 2006 by Michael Hoffer                                  *
+*   info@michaelhoffer.de                                                 *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU Library General Public License as       *
+*   published by the Free Software Foundation; either version 2 of the    *
+*   License, or (at your option) any later version.                       *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU Library General Public     *
+*   License along with this program; if not, write to the                 *
+*   Free Software Foundation, Inc.,                                       *
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+***************************************************************************/
+
+/** @file 	libstaticnet.h
+ * @brief 	layered neural networks with a topology that is fixed at compile time
+ * @author 	Michael Hoffer (www.mihosoft.de)
+ */
+
+#ifndef LIBSTATICNET_H
+#define LIBSTATICNET_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <libnnet.h>
+
+/*-----------------------------------------------------------------------------
+	Description:	Helpers of StaticNet. All loop bounds are template
+			parameters, i.e. the compiler knows the size of every
+			loop and of every temporary array.
+-----------------------------------------------------------------------------*/
+
+/**
+ *	Computes y[ i ] = f( x[ i ] ) for i = 0 ... N - 1 (exact precision only).
+ */
+template <unsigned int N>
+inline void staticActivation( Activation::Function function, const double *x, double *y )
+{
+	switch ( function )
+	{
+		default:
+		case Activation::SIGMOID:
+			for ( unsigned int i = 0; i < N; i++ ) y[ i ] = 1 / ( 1 + exp( -x[ i ] ) );
+			break;
+
+		case Activation::TANH:
+			for ( unsigned int i = 0; i < N; i++ ) y[ i ] = tanh( x[ i ] );
+			break;
+
+		case Activation::RELU:
+			for ( unsigned int i = 0; i < N; i++ ) y[ i ] = x[ i ] > 0 ? x[ i ] : 0;
+			break;
+
+		case Activation::SOFTSIGN:
+			for ( unsigned int i = 0; i < N; i++ ) y[ i ] = x[ i ] / ( 1 + fabs( x[ i ] ) );
+			break;
+	}
+}
+
+/**
+ *	One fully connected layer: y = W^T f( x ). W is stored row-major (one row per
+ *	sender) like the layers of a NNet created by NNet::createNet(). The rows are
+ *	added in the same order as in the compiled forward pass of NNet, i.e. the
+ *	results are identical.
+ */
+template <unsigned int Senders, unsigned int Receivers>
+inline void staticLayer( const double *x, double *y, const double ( &weights )[ Senders ][ Receivers ],
+                         Activation::Function function )
+{
+	double s[ Senders ];
+
+	staticActivation<Senders>( function, x, s );
+
+	for ( unsigned int k = 0; k < Receivers; k++ ) y[ k ] = 0;
+
+	for ( unsigned int j = 0; j < Senders; j++ )
+	{
+		for ( unsigned int k = 0; k < Receivers; k++ )
+		{
+			y[ k ] += s[ j ] * weights[ j ][ k ];
+		}
+	}
+}
+
+/**
+ *	The layers of a StaticNet. The first layer connects Senders to Hidden1 cells,
+ *	the remaining layers are stored in #next (the hidden layer sizes are shifted
+ *	by one). The specialization below ends the recursion.
+ */
+template <unsigned int Senders, unsigned int Hidden1, unsigned int Hidden2, unsigned int Hidden3,
+          unsigned int Outputs>
+struct StaticLayers
+{
+	typedef StaticLayers <Hidden1, Hidden2, Hidden3, 0, Outputs> Next;
+
+	enum { numberOfWeights = Senders * Hidden1 + Next::numberOfWeights };
+
+	double weights[ Senders ][ Hidden1 ];
+	Next next;
+
+	void forward( const double *x, double *y, Activation::Function function ) const
+	{
+		double hidden[ Hidden1 ];
+
+		staticLayer( x, hidden, weights, function );
+		next.forward( hidden, y, function );
+	}
+
+	void setWeights( const double *w )
+	{
+		for ( unsigned int j = 0; j < Senders; j++ )
+		{
+			for ( unsigned int k = 0; k < Hidden1; k++ ) weights[ j ][ k ] = *w++;
+		}
+
+		next.setWeights( w );
+	}
+
+	void getWeights( double *w ) const
+	{
+		for ( unsigned int j = 0; j < Senders; j++ )
+		{
+			for ( unsigned int k = 0; k < Hidden1; k++ ) *w++ = weights[ j ][ k ];
+		}
+
+		next.getWeights( w );
+	}
+};
+
+template <unsigned int Senders, unsigned int Outputs>
+struct StaticLayers <Senders, 0, 0, 0, Outputs>
+{
+	enum { numberOfWeights = Senders * Outputs };
+
+	double weights[ Senders ][ Outputs ];
+
+	void forward( const double *x, double *y, Activation::Function function ) const
+	{
+		staticLayer( x, y, weights, function );
+	}
+
+	void setWeights( const double *w )
+	{
+		for ( unsigned int j = 0; j < Senders; j++ )
+		{
+			for ( unsigned int k = 0; k < Outputs; k++ ) weights[ j ][ k ] = *w++;
+		}
+	}
+
+	void getWeights( double *w ) const
+	{
+		for ( unsigned int j = 0; j < Senders; j++ )
+		{
+			for ( unsigned int k = 0; k < Outputs; k++ ) *w++ = weights[ j ][ k ];
+		}
+	}
+};
+
+/**
+ *	Fully connected layered net with a topology that is fixed at compile time.
+ *
+ *	StaticNet<Inputs, Outputs, Hidden1, Hidden2, Hidden3> is the net that
+ *	NNet::createNet( Inputs, Outputs, layerSize ) creates for the hidden layers
+ *	Hidden1, Hidden2 and Hidden3 (0 means no layer, up to three hidden layers).
+ *	The parameters are in the same order as the arguments of NNet::createNet().
+ *
+ *	The weights are stored in fixed size arrays and the forward pass is a
+ *	sequence of loops with constant bounds on stack arrays, i.e. the compiler
+ *	can unroll and vectorize everything and keep small layers in registers.
+ *	There are no cells and no heap memory. The outputs are identical to the
+ *	outputs of the corresponding NNet (exact precision).
+ *
+ *	Nets are exchanged with NNet via fromNet()/toNet() and with files via
+ *	loadNet()/saveNet() (text and binary format of NNet). The activation
+ *	function is not stored in net files and has to be set with setActivation().
+ *
+ *	Example:
+ *	@code
+ *	StaticNet <2, 1, 8> net; // 2 inputs, 8 hidden cells, 1 output
+ *	if ( net.loadNet( "xor.nnet" ) )
+ *	{
+ *		double in[ 2 ] = { 0, 1 }, out[ 1 ];
+ *		net.sendSignals( in, out );
+ *	}
+ *	@endcode
+ */
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1 = 0, unsigned int Hidden2 = 0,
+          unsigned int Hidden3 = 0>
+class StaticNet
+{
+	public:
+		enum
+		{
+			numberOfInputs = Inputs,
+			numberOfOutputs = Outputs,
+			numberOfCells = Inputs + Hidden1 + Hidden2 + Hidden3 + Outputs,
+			numberOfConnections = StaticLayers <Inputs, Hidden1, Hidden2, Hidden3, Outputs>::numberOfWeights
+		};
+
+		/**
+		 *			Constructor. All weights are 0, the activation function
+		 *			is the sigmoid.
+		 */
+		StaticNet();
+
+		/**
+		 *			Computes the outputs of one sample.
+		 *
+		 * @param inputs	numberOfInputs values.
+		 * @param outputs	numberOfOutputs values.
+		 */
+		void sendSignals( const double *inputs, double *outputs ) const;
+
+		/**
+		 *			Computes the outputs of several samples.
+		 *
+		 * @param inputs	numberOfSamples rows with numberOfInputs values each.
+		 * @param outputs	numberOfSamples rows with numberOfOutputs values each.
+		 * @param numberOfSamples Number of samples.
+		 */
+		void sendSignals( const double *inputs, double *outputs, unsigned int numberOfSamples ) const;
+
+		/**
+		 *			Sets the weights.
+		 *
+		 * @param weights	numberOfConnections values in the order of
+		 *			NNet::setWeights().
+		 */
+		void setWeights( const double *weights );
+
+		/**
+		 *			Returns the weights (order of NNet::setWeights()).
+		 *
+		 * @param weights	numberOfConnections values.
+		 */
+		void getWeights( double *weights ) const;
+
+		void setActivation( Activation::Function function );
+		const Activation::Function activation() const;
+
+		/**
+		 *			Copies the weights of a net.
+		 *
+		 * @param net		Compiled net with the topology of this class
+		 *			(as created by NNet::createNet()).
+		 * @return		Returns false if the topology doesn't match.
+		 */
+		bool fromNet( const NNet &net );
+
+		/**
+		 *			Creates the corresponding NNet (topology, weights and
+		 *			activation function).
+		 *
+		 * @param net		The net.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool toNet( NNet &net ) const;
+
+		/**
+		 *			Loads the weights from a net file (see NNet::loadNet()).
+		 *
+		 * @param fileName	Filename with path.
+		 * @return		Returns false if the file can't be loaded or if the
+		 *			topology doesn't match.
+		 */
+		bool loadNet( const std::string &fileName );
+
+		/**
+		 *			Saves the net in the text format of NNet::saveNet().
+		 *
+		 * @param fileName	Filename with path.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool saveNet( const std::string &fileName ) const;
+
+	private:
+		// hidden layers have to be specified from left to right (no gaps)
+		typedef char HiddenLayersWithoutGaps
+		[ ( Hidden1 > 0 || Hidden2 == 0 ) && ( Hidden2 > 0 || Hidden3 == 0 ) ? 1 : -1 ];
+		typedef char InputsAndOutputs[ Inputs > 0 && Outputs > 0 ? 1 : -1 ];
+
+		StaticLayers <Inputs, Hidden1, Hidden2, Hidden3, Outputs> layers;
+		Activation::Function _activation;
+};
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::StaticNet()
+{
+	std::vector <double> zeros( numberOfConnections, 0.0 );
+
+	layers.setWeights( &zeros[ 0 ] );
+	_activation = Activation::SIGMOID;
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+void StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::sendSignals( const double *inputs,
+        double *outputs ) const
+{
+	layers.forward( inputs, outputs, _activation );
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+void StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::sendSignals( const double *inputs,
+        double *outputs, unsigned int numberOfSamples ) const
+{
+	for ( unsigned int n = 0; n < numberOfSamples; n++ )
+	{
+		layers.forward( inputs + n * Inputs, outputs + n * Outputs, _activation );
+	}
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+void StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::setWeights( const double *weights )
+{
+	layers.setWeights( weights );
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+void StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::getWeights( double *weights ) const
+{
+	layers.getWeights( weights );
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+void StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::setActivation( Activation::Function function )
+{
+	_activation = function;
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+const Activation::Function StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::activation() const
+{
+	return _activation;
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+bool StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::fromNet( const NNet &net )
+{
+	const NNetPlan &plan = net.getPlan();
+
+	/*--------------------------------------------
+		The net has to be the net created by
+		NNet::createNet(): layer by layer, each
+		cell connected to all cells of the next
+		layer in ascending order
+	----------------------------------------------*/
+
+	const unsigned int sizes[ 5 ] = { Inputs, Hidden1, Hidden2, Hidden3, Outputs };
+
+	std::vector <unsigned int> layerSize;
+
+	for ( unsigned int l = 0; l < 5; l++ )
+	{
+		if ( sizes[ l ] > 0 ) layerSize.push_back( sizes[ l ] );
+	}
+
+	bool matches = plan.numberOfCells() == numberOfCells &&
+	               plan.numberOfConnections() == numberOfConnections &&
+	               plan.inputs.size() == Inputs && plan.outputs.size() == Outputs &&
+	               plan.weightData() != NULL;
+
+	for ( unsigned int i = 0; matches && i < Inputs; i++ )
+	{
+		matches = plan.inputs[ i ] == i;
+	}
+
+	for ( unsigned int i = 0; matches && i < Outputs; i++ )
+	{
+		matches = plan.outputs[ i ] == numberOfCells - Outputs + i;
+	}
+
+	unsigned int offset = 0;
+
+	for ( unsigned int l = 0; matches && l < layerSize.size(); l++ )
+	{
+		const unsigned int receivers = l + 1 < layerSize.size() ? layerSize[ l + 1 ] : 0;
+		const unsigned int nextOffset = offset + layerSize[ l ];
+
+		for ( unsigned int j = offset; matches && j < nextOffset; j++ )
+		{
+			matches = plan.rowStart[ j + 1 ] - plan.rowStart[ j ] == receivers;
+
+			for ( unsigned int k = 0; matches && k < receivers; k++ )
+			{
+				matches = plan.targets[ plan.rowStart[ j ] + k ] == nextOffset + k;
+			}
+		}
+
+		offset = nextOffset;
+	}
+
+	if ( !matches )
+	{
+		std::cerr << "Error: Net does not match the topology of the StaticNet!" << std::endl;
+		return false;
+	}
+
+	layers.setWeights( plan.weightData() );
+
+	return true;
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+bool StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::toNet( NNet &net ) const
+{
+	std::vector <int> layerSize;
+
+	if ( Hidden1 > 0 ) layerSize.push_back( Hidden1 );
+	if ( Hidden2 > 0 ) layerSize.push_back( Hidden2 );
+	if ( Hidden3 > 0 ) layerSize.push_back( Hidden3 );
+
+	if ( !net.createNet( Inputs, Outputs, layerSize ) ) return false;
+
+	std::vector <double> weights( numberOfConnections );
+
+	layers.getWeights( &weights[ 0 ] );
+
+	net.setWeights( weights );
+	net.setActivation( _activation );
+
+	return true;
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+bool StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::loadNet( const std::string &fileName )
+{
+	NNet net;
+
+	if ( !net.loadNet( fileName ) ) return false;
+
+	return fromNet( net );
+}
+
+template <unsigned int Inputs, unsigned int Outputs, unsigned int Hidden1, unsigned int Hidden2,
+          unsigned int Hidden3>
+bool StaticNet <Inputs, Outputs, Hidden1, Hidden2, Hidden3>::saveNet( const std::string &fileName ) const
+{
+	NNet net;
+
+	return toNet( net ) && net.saveNet( fileName );
+}
+
+#endif /*LIBSTATICNET_H*/
@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2006 by Michael Hoffer                                  *
+ *   info@michaelhoffer.de                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef LIBSURROGATE_H
+#define LIBSURROGATE_H
+
+#include <vector>
+
+#include <libgensolver.h>
+#include <libnnet.h>
+
+/** @file 	libsurrogate.h
+* @brief 	surrogate models for pre-screening of chromosomes
+* @author 	Michael Hoffer (www.mihosoft.de)
+*/
+
+/**
+ *	Surrogate model based on NNet.
+ *
+ *	The model is a feed forward net with one hidden layer (see NNet::createNet()). The genes
+ *	are normalized and fed to the input cells, an additional input cell with constant input
+ *	works as bias. The weights between input and hidden layer are initialized randomly and
+ *	are never changed. Training only fits the weights between hidden layer and output cell
+ *	(ridge regression, i.e. a linear least squares problem). Therefore training is fast and
+ *	can be done after each generation.
+ *
+ *	Only the last samples are used for training (see NNetSurrogate::NNetSurrogate()).
+ *
+ *	Usage:
+ *	<pre>
+ *	NNetSurrogate surrogate;
+ *	solver.setSurrogate( &surrogate, 0.25 ); // evaluate 25 % of each generation
+ *	</pre>
+ */
+class NNetSurrogate : public GenBase::Surrogate <double>
+{
+	public:
+		/**
+		 *			Constructor.
+		 *
+		 * @param numberOfHiddenCells Size of the hidden layer.
+		 * @param maxSamples	Maximum number of samples used for training (the oldest
+		 *			samples are replaced).
+		 * @param ridge		Regularization of the least squares problem.
+		 * @param seed		Seed for the random weights of the hidden layer.
+		 */
+		NNetSurrogate( unsigned int numberOfHiddenCells = 64, unsigned int maxSamples = 2000,
+		               double ridge = 1e-6, unsigned long seed = 0 );
+
+		void addSample( const std::vector <double> &genes, double fitness );
+
+		void train();
+
+		double predict( const std::vector <double> &genes );
+
+		/**
+		 *	Returns true if train() has been successfully called.
+		 */
+		const bool trained() const;
+
+		/**
+		 *	The net of the surrogate.
+		 */
+		NNet net;
+
+	private:
+		/**
+		 *	Creates the net and initializes the weights of the hidden layer.
+		 */
+		void createNet( unsigned int numberOfGenes );
+
+		/**
+		 *	Feeds the normalized genes to the input cells and starts the send process.
+		 */
+		void sendSignals( const std::vector <double> &genes );
+
+		unsigned int numberOfGenes;
+		unsigned int numberOfHiddenCells;
+		unsigned int maxSamples;
+		double ridge;
+		unsigned long seed;
+
+		std::vector < std::vector <double> > samples;
+		std::vector <double> targets;
+		unsigned int nextSample;
+
+		std::vector <double> mean;
+		std::vector <double> scale;
+		double targetMean;
+
+		std::vector <double> weights;
+
+		bool isTrained;
+};
+
+#endif /*LIBSURROGATE_H*/
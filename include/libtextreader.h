@@ -0,0 +1,157 @@
+/***************************************************************************
+*   Copyright (C) 2006 by Michael Hoffer                                  *
+*   info@michaelhoffer.de                                                 *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU Library General Public License as       *
+*   published by the Free Software Foundation; either version 2 of the    *
+*   License, or (at your option) any later version.                       *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU Library General Public     *
+*   License along with this program; if not, write to the                 *
+*   Free Software Foundation, Inc.,                                       *
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+***************************************************************************/
+
+/** @file 	libtextreader.h
+ * @brief 	Streaming tokenizer for the text file formats
+ * @author 	Michael Hoffer (www.mihosoft.de)
+ * @date 	13.03.06
+ */
+
+#ifndef LIBTEXTREADER_H
+#define LIBTEXTREADER_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * Streaming tokenizer for whitespace separated text files.
+ *
+ * The file is read in large blocks into one buffer. Tokens are returned as
+ * pointers into this buffer (no string is allocated) and numbers are parsed
+ * in place, i.e. the memory consumption only depends on the buffer size and
+ * not on the size of the file. It is used by NNet::loadNet() and
+ * GenerationClass::loadGeneration().
+ *
+ * Example:
+ * @code
+ * TextReader reader;
+ * if ( reader.open( "net.nnet" ) )
+ * {
+ * 	while ( reader.next() && !reader.is( "</inputs>" ) )
+ * 	{
+ * 		int value;
+ * 		if ( !reader.toInt( value ) ) ...
+ * 	}
+ * }
+ * @endcode
+ */
+class TextReader
+{
+	public:
+		/**
+		 * Constructor.
+		 *
+		 * @param bufferSize	Size of the read buffer in bytes. The buffer grows
+		 *			if a single token does not fit into it.
+		 */
+		TextReader( unsigned int bufferSize = 1 << 20 );
+		~TextReader();
+
+		/**
+		 * Opens a file.
+		 *
+		 * @param fileName	Filename with path.
+		 * @return		Returns true if successful and false otherwise.
+		 */
+		bool open( const std::string &fileName );
+
+		/**
+		 * Closes the file.
+		 */
+		void close();
+
+		/**
+		 * Reads the next token.
+		 *
+		 * @return		Returns false at the end of the file.
+		 */
+		bool next();
+
+		/**
+		 * Skips the rest of the current line (e.g. comments).
+		 */
+		void skipLine();
+
+		/**
+		 * Returns the current token (zero terminated). The pointer is valid
+		 * until the next call of next() or skipLine().
+		 */
+		const char *token() const;
+
+		/**
+		 * Returns the length of the current token.
+		 */
+		unsigned int length() const;
+
+		/**
+		 * Returns true if the current token equals str.
+		 */
+		bool is( const char *str ) const;
+
+		/**
+		 * Converts the current token to an integer.
+		 *
+		 * @param value		The value.
+		 * @return		Returns false if the token is not a valid integer number.
+		 */
+		bool toInt( int &value ) const;
+
+		/**
+		 * Converts the current token to a floating point number. Decimal numbers
+		 * with up to 15 significant digits and small exponents (everything
+		 * NNet::saveNet() writes) are converted without calling strtod(), the
+		 * result is correctly rounded in any case.
+		 *
+		 * @param value		The value.
+		 * @return		Returns false if the token is not a valid floating point number.
+		 */
+		bool toDouble( double &value ) const;
+
+	private:
+		// not copyable
+		TextReader( const TextReader & );
+		TextReader &operator=( const TextReader & );
+
+		/**
+		 * Moves the unread part of the buffer to its beginning and
+		 * reads the next block. Returns false if nothing was read.
+		 */
+		bool fill();
+
+		FILE *file;
+		bool endOfFile;
+
+		// one byte more than capacity for the terminating zero
+		std::vector <char> buffer;
+		size_t capacity;
+
+		// unread data is [position, end)
+		size_t position;
+		size_t end;
+
+		size_t tokenBegin;
+		size_t tokenLength;
+
+		// true if the current token was terminated by a line break
+		bool lineEnd;
+};
+
+#endif /*LIBTEXTREADER_H*/
@@ -33,6 +33,11 @@ namespace GenFloat
 	{
 		return randFloat( int(minRand), int(maxRand) );
 	}
+
+	double ChromosomeClass::randFunction( double minRand, double maxRand, RandStream &stream )
+	{
+		return stream.randFloat( int(minRand), int(maxRand) );
+	}
 }
 
 namespace GenInt
@@ -41,4 +46,9 @@ namespace GenInt
 	{
 		return randInt( minRand, maxRand );
 	}
+
+	int ChromosomeClass::randFunction( int minRand, int maxRand, RandStream &stream )
+	{
+		return stream.randInt( minRand, maxRand );
+	}
 }
@@ -20,21 +20,81 @@
 
 
 #include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include "libnetsolver.h"
 #include <genutil.h>
 
 //using namespace std;
 
+// innovation number, weight, enabled flag (see enableTopologyEvolution())
+static const unsigned int geneSize = 3;
+
 NetSolver::NetSolver()
 {
 	actualEntity = NULL;
 	actualEntityID = 0;
+	batchSize = 0;
+	memeticIndividuals = 0;
+	memeticSteps = 0;
+	learningRate = 0;
+	numberOfTrainingSamples = 0;
+	topologyEvolution = false;
+	breeding = false;
+	addConnectionRate = 0;
+	addNodeRate = 0;
+	numberOfInputNodes = 0;
+	numberOfOutputNodes = 0;
+	racingFraction = 0;
+	racingDeviations = 3.0;
+	racingBound = HUGE_VAL;
+	miniBatchSize = 256;
+	maxChangedWeights = 0;
+	cacheSize = 0;
+	parallelEvaluation = AUTOMATIC_PARALLELISM;
+	evaluationGroupSize = 0;
+	weightBlocks = INCOMING_WEIGHTS;
+	lastParallelEvaluation = ACROSS_CHROMOSOMES;
+	numberOfCachedChromosomes = 0;
+	incrementalEvaluations = 0;
+	miniBatchesPerGeneration = 0;
+	numberOfGenerationSamples = 0;
+	evaluatedSamples = 0;
+	evaluatedChromosomes = 0;
 }
 
 NetSolver::NetSolver( string fileName)
 {
 	actualEntity = NULL;
 	actualEntityID = 0;
+	batchSize = 0;
+	memeticIndividuals = 0;
+	memeticSteps = 0;
+	learningRate = 0;
+	numberOfTrainingSamples = 0;
+	topologyEvolution = false;
+	breeding = false;
+	addConnectionRate = 0;
+	addNodeRate = 0;
+	numberOfInputNodes = 0;
+	numberOfOutputNodes = 0;
+	racingFraction = 0;
+	racingDeviations = 3.0;
+	racingBound = HUGE_VAL;
+	miniBatchSize = 256;
+	maxChangedWeights = 0;
+	cacheSize = 0;
+	parallelEvaluation = AUTOMATIC_PARALLELISM;
+	evaluationGroupSize = 0;
+	weightBlocks = INCOMING_WEIGHTS;
+	lastParallelEvaluation = ACROSS_CHROMOSOMES;
+	numberOfCachedChromosomes = 0;
+	incrementalEvaluations = 0;
+	miniBatchesPerGeneration = 0;
+	numberOfGenerationSamples = 0;
+	evaluatedSamples = 0;
+	evaluatedChromosomes = 0;
 	
 	if ( !net.loadNet(fileName) )
 	{
@@ -46,25 +106,263 @@ NetSolver::NetSolver( string fileName)
 void NetSolver::parseChromosomes()
 {
 	// PREPROCESSING
+	if ( topologyEvolution )
+	{
+		updateTopology();
+	}
+	
+	if ( dataFitness() )
+	{
+		parseChromosomesOnData();
+	}
+	else if ( batchSize > 1 )
+	{
+		parseChromosomeBlocks();
+	}
+	else
+	{
+		for (unsigned int k = 0; k < newGeneration->size(); k++)
+		{
+			// time or evaluation budget (see startSolvingTime())
+			if ( !evaluationAllowed() )
+			{
+				break;
+			}
+		
+			actualEntity = ( *newGeneration ) ( k );
+		
+			bindWeights( actualEntity );
+			net.reset();
+		
+			actualEntityID = k;
+		
+			// call virtual fitness funciton
+			fitnessFunction();
+		
+			if (_solution)
+			{
+				break;
+			}
+		}
+	}
+		
+	if ( !_solution )
+	{
+		refineChromosomes();
+	}
+	
+	// the chromosomes may be deleted, keep a copy of the weights
+	net.releaseWeights();
+	
+	// POSTPROCESSING
 	// not implemented yet
+}
+
+void NetSolver::initialize( unsigned int generationSize, int minRand, int maxRand )
+{
+	if ( !topologyEvolution )
+	{
+		PopulationClass::initialize(generationSize, net.numberOfConnections(), net.numberOfConnections(),1, 1, minRand, maxRand );
+		updateWeightBlocks();
+		return;
+	}
+	
+	initializeTopology();
+	
+	// minimal topology: each input connected to each output
+	unsigned int genes = innovationSender.size();
+	
+	PopulationClass::initialize( generationSize, genes * geneSize, genes * geneSize, geneSize, geneSize, minRand, maxRand );
+	
+	for ( unsigned int k = 0; k < newGeneration->size(); k++ )
+	{
+		GenFloat::ChromosomeClass &chromosome = *( *newGeneration ) ( k );
+		
+		for ( unsigned int g = 0; g < genes; g++ )
+		{
+			chromosome[ g * geneSize ] = g;
+			chromosome[ g * geneSize + 2 ] = 1;
+		}
+	}
+}
+
+void NetSolver::parseChromosomeBlocks()
+{
+	for ( unsigned int first = 0; first < newGeneration->size(); first += batchSize )
+	{
+		actualEntities.clear();
+		
+		// time or evaluation budget (see startSolvingTime())
+		for ( unsigned int k = first; k < newGeneration->size() && k < first + batchSize; k++ )
+		{
+			if ( !evaluationAllowed() )
+			{
+				break;
+			}
+			
+			actualEntities.push_back( ( *newGeneration ) ( k ) );
+		}
+		
+		if ( actualEntities.empty() )
+		{
+			break;
+		}
+		
+		storeBatchWeights();
+		
+		actualEntityID = first;
+		
+		batchFitnessFunction();
+		
+		if (_solution)
+		{
+			break;
+		}
+	}
+}
+
+void NetSolver::storeBatchWeights()
+{
+	// store weights, one column per chromosome
+	unsigned int numberOfConnections = net.numberOfConnections();
+	unsigned int count = actualEntities.size();
+	
+	batchWeights.resize( numberOfConnections * count );
+	
+	if ( topologyEvolution )
+	{
+		fill( batchWeights.begin(), batchWeights.end(), 0.0 );
+		
+		for ( unsigned int p = 0; p < count; p++ )
+		{
+			decodeWeights( *actualEntities[ p ], &batchWeights[ p ], count );
+		}
+		
+		return;
+	}
+	
+	for ( unsigned int p = 0; p < count; p++ )
+	{
+		for ( unsigned int j = 0; j < numberOfConnections; j++ )
+		{
+			batchWeights[ j * count + p ] = ( *actualEntities[ p ] ) ( j );
+		}
+	}
+}
+
+void NetSolver::refineChromosomes()
+{
+	if ( memeticIndividuals == 0 || numberOfTrainingSamples == 0 || topologyEvolution )
+	{
+		return;
+	}
+	
+	unsigned int numberOfConnections = net.numberOfConnections();
+	
+	// evaluated chromosomes, best first
+	vector < pair <double, unsigned int> > ranking;
+	
+	for ( unsigned int k = 0; k < newGeneration->size(); k++ )
+	{
+		if ( ( *newGeneration ) ( k ) ->evaluated() )
+		{
+			ranking.push_back( make_pair( -( *newGeneration ) ( k ) ->fitness(), k ) );
+		}
+	}
+	
+	sort( ranking.begin(), ranking.end() );
+	
+	/*--------------------------------------------
+		Gradient descent directly on the
+		chromosomes (Lamarckian)
+	----------------------------------------------*/
+	
+	actualEntities.clear();
+	vector <unsigned int> entityIDs;
+	
+	for ( unsigned int r = 0; r < ranking.size() && entityIDs.size() < memeticIndividuals; r++ )
+	{
+		GenFloat::ChromosomeClass *chromosome = ( *newGeneration ) ( ranking[ r ].second );
+		
+		if ( chromosome->size() != numberOfConnections )
+		{
+			continue;
+		}
+		
+		// the refined chromosome is evaluated again
+		if ( !evaluationAllowed() )
+		{
+			break;
+		}
+		
+		double error = 0;
+		
+		if ( !net.gradientDescent( &( *chromosome ) [ 0 ], &trainingInputs[ 0 ], &trainingTargets[ 0 ],
+		                           numberOfTrainingSamples, memeticSteps, learningRate, error ) )
+		{
+			break;
+		}
+		
+		chromosome->invalidateFitness();
+		
+		actualEntities.push_back( chromosome );
+		entityIDs.push_back( ranking[ r ].second );
+	}
+	
+	if ( actualEntities.empty() )
+	{
+		return;
+	}
+	
+	/*--------------------------------------------
+		Evaluate the refined chromosomes
+	----------------------------------------------*/
 	
-	for (unsigned int k = 0; k < newGeneration->size(); k++)
+	if ( dataFitness() )
 	{
+		unsigned int groupSize = chromosomesPerGroup();
 		
-		// set wights
-		vector <double> weights;
-		for ( unsigned int j = 0; j < newGeneration->sizeOfChromosome( k ); j++ )
+		for ( unsigned int first = 0; first < actualEntities.size(); first += groupSize )
 		{
-			weights.push_back( ( *( *newGeneration ) ( k ) ) ( j ) );
+			unsigned int count = min( groupSize, ( unsigned int ) actualEntities.size() - first );
+			
+			if ( evaluationGroup.size() < count )
+			{
+				evaluationGroup.resize( count );
+			}
+			
+			for ( unsigned int g = 0; g < count; g++ )
+			{
+				evaluationGroup[ g ].chromosome = actualEntities[ first + g ];
+				evaluationGroup[ g ].maxError = HUGE_VAL;
+			}
+			
+			evaluateGroup( count, actualEntities.size() );
 		}
 		
-		net.setWeights( weights );
+		return;
+	}
+	
+	if ( batchSize > 1 )
+	{
+		storeBatchWeights();
+		
+		actualEntityID = entityIDs[ 0 ];
+		
+		batchFitnessFunction();
+		
+		return;
+	}
+	
+	for ( unsigned int p = 0; p < actualEntities.size(); p++ )
+	{
+		actualEntity = actualEntities[ p ];
+		
+		bindWeights( actualEntity );
 		net.reset();
 		
-		actualEntity = ( *newGeneration ) ( k );
-		actualEntityID = k;
+		actualEntityID = entityIDs[ p ];
 		
-		// call virtual fitness funciton
 		fitnessFunction();
 		
 		if (_solution)
@@ -72,12 +370,1461 @@ void NetSolver::parseChromosomes()
 			break;
 		}
 	}
+}
+
+void NetSolver::setMemeticRefinement( unsigned int numberOfIndividuals, unsigned int steps, double learningRate )
+{
+	memeticIndividuals = numberOfIndividuals;
+	memeticSteps = steps;
+	this->learningRate = learningRate;
+}
+
+void NetSolver::setTrainingData( const double *inputs, const double *targets, unsigned int numberOfSamples )
+{
+	trainingInputs.assign( inputs, inputs + numberOfSamples * net.getPlan().inputs.size() );
+	trainingTargets.assign( targets, targets + numberOfSamples * net.getPlan().outputs.size() );
+	numberOfTrainingSamples = numberOfSamples;
 	
-	// POSTPROCESSING
-	// not implemented yet
+	// the cached activations belong to the old samples
+	numberOfCachedChromosomes = 0;
+	nextErrors.clear();
 }
 
-void NetSolver::initialize( unsigned int generationSize, int minRand, int maxRand )
+void NetSolver::setTrainingData( const NNetDataset &data )
+{
+	if ( data.numberOfInputs() != net.getPlan().inputs.size() ||
+	     data.numberOfOutputs() != net.getPlan().outputs.size() )
+	{
+		cerr << "Error: Dataset doesn't match input and output cells of the net!" << endl;
+		return;
+	}
+	
+	setTrainingData( data.inputs(), data.targets(), data.numberOfSamples() );
+}
+
+void NetSolver::enableRacing( double selectedFraction, double deviations )
+{
+	racingFraction = selectedFraction;
+	racingDeviations = deviations;
+	racingBound = HUGE_VAL;
+}
+
+void NetSolver::setMiniBatchSize( unsigned int size )
+{
+	miniBatchSize = max( size, 1u );
+	
+	// the layout of the cached activations depends on the mini-batches
+	numberOfCachedChromosomes = 0;
+	nextErrors.clear();
+}
+
+void NetSolver::setMiniBatchesPerGeneration( unsigned int number )
+{
+	miniBatchesPerGeneration = number;
+}
+
+double NetSolver::evaluatedSampleFraction() const
+{
+	if ( evaluatedChromosomes == 0 || numberOfTrainingSamples == 0 )
+	{
+		return 1.0;
+	}
+	
+	return ( double ) evaluatedSamples / ( ( double ) evaluatedChromosomes * numberOfTrainingSamples );
+}
+
+bool NetSolver::dataFitness() const
+{
+	return racingFraction > 0 || miniBatchesPerGeneration > 0 || cacheSize > 0;
+}
+
+void NetSolver::shuffleMiniBatches()
+{
+	unsigned int numberOfMiniBatches = ( numberOfTrainingSamples + miniBatchSize - 1 ) / miniBatchSize;
+	
+	miniBatchOrder.resize( numberOfMiniBatches );
+	
+	for ( unsigned int b = 0; b < numberOfMiniBatches; b++ )
+	{
+		miniBatchOrder[ b ] = b;
+	}
+	
+	// same order for all chromosomes of the generation
+	RandStream stream( rand() );
+	
+	for ( unsigned int b = numberOfMiniBatches; b > 1; b-- )
+	{
+		swap( miniBatchOrder[ b - 1 ], miniBatchOrder[ stream.randInt( 0, b - 1 ) ] );
+	}
+	
+	if ( miniBatchesPerGeneration > 0 && miniBatchesPerGeneration < numberOfMiniBatches )
+	{
+		miniBatchOrder.resize( miniBatchesPerGeneration );
+	}
+	
+	// without racing the order doesn't matter, sequential access is faster
+	if ( racingFraction <= 0 )
+	{
+		sort( miniBatchOrder.begin(), miniBatchOrder.end() );
+	}
+	
+	numberOfGenerationSamples = 0;
+	
+	for ( unsigned int b = 0; b < miniBatchOrder.size(); b++ )
+	{
+		numberOfGenerationSamples += min( miniBatchSize, numberOfTrainingSamples - miniBatchOrder[ b ] * miniBatchSize );
+	}
+	
+}
+
+void NetSolver::parseChromosomesOnData()
+{
+	if ( numberOfTrainingSamples == 0 )
+	{
+		cerr << "Error: No training data!" << endl;
+		return;
+	}
+	
+	if ( !net.getPlan().feedForward() )
+	{
+		cerr << "Error: Evaluation on the training data requires a feed forward net!" << endl;
+		return;
+	}
+	
+	shuffleMiniBatches();
+	
+	evaluatedSamples = 0;
+	evaluatedChromosomes = 0;
+	incrementalEvaluations = 0;
+	
+	// the best chromosomes of the last generation are the bases of the incremental evaluation
+	cachedActivations.swap( nextActivations );
+	cachedWeights.swap( nextWeights );
+	numberOfCachedChromosomes = nextErrors.size();
+	nextErrors.clear();
+	
+	/*--------------------------------------------
+		Errors of the best completely evaluated
+		chromosomes (max-heap), the largest one
+		is the racing bound
+	----------------------------------------------*/
+	
+	unsigned int selected = 0;
+	
+	if ( racingFraction > 0 )
+	{
+		selected = max( 1u, ( unsigned int ) ceil( racingFraction * newGeneration->size() ) );
+	}
+	
+	vector <double> bestErrors;
+	vector <double> errors;
+	
+	bool budgetLeft = true;
+	
+	unsigned int groupSize = chromosomesPerGroup();
+	
+	for ( unsigned int first = 0; first < newGeneration->size() && budgetLeft; first += groupSize )
+	{
+		// until enough chromosomes are evaluated the bound of the last generation is used
+		double maxError = selected > 0 ? racingBound : HUGE_VAL;
+		
+		if ( selected > 0 && bestErrors.size() == selected )
+		{
+			maxError = bestErrors.front();
+		}
+		
+		/*--------------------------------------------
+			Group of chromosomes with the same bound
+		----------------------------------------------*/
+		
+		unsigned int count = 0;
+		
+		for ( unsigned int k = first; k < newGeneration->size() && k < first + groupSize; k++ )
+		{
+			// time or evaluation budget (see startSolvingTime())
+			if ( !evaluationAllowed() )
+			{
+				budgetLeft = false;
+				break;
+			}
+			
+			if ( evaluationGroup.size() <= count )
+			{
+				evaluationGroup.resize( count + 1 );
+			}
+			
+			evaluationGroup[ count ].chromosome = ( *newGeneration ) ( k );
+			evaluationGroup[ count ].maxError = maxError;
+			count++;
+		}
+		
+		evaluateGroup( count, newGeneration->size() );
+		
+		for ( unsigned int g = 0; g < count; g++ )
+		{
+			double error = evaluationGroup[ g ].error;
+			
+			errors.push_back( error );
+			
+			// aborted chromosomes have an error above the bound
+			if ( selected == 0 || error > maxError )
+			{
+				continue;
+			}
+			
+			if ( bestErrors.size() < selected )
+			{
+				bestErrors.push_back( error );
+				push_heap( bestErrors.begin(), bestErrors.end() );
+			}
+			else if ( error < bestErrors.front() )
+			{
+				pop_heap( bestErrors.begin(), bestErrors.end() );
+				bestErrors.back() = error;
+				push_heap( bestErrors.begin(), bestErrors.end() );
+			}
+		}
+	}
+	
+	// aborted chromosomes included, the bound grows if the generation got worse
+	if ( selected > 0 && errors.size() >= selected )
+	{
+		nth_element( errors.begin(), errors.begin() + selected - 1, errors.end() );
+		racingBound = errors[ selected - 1 ];
+	}
+}
+
+int NetSolver::evaluationThreads() const
+{
+#ifdef _OPENMP
+	return numberOfThreads > 0 ? numberOfThreads : omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+unsigned int NetSolver::chromosomesPerGroup() const
 {
-	PopulationClass::initialize(generationSize, net.numberOfConnections(), net.numberOfConnections(),1, 1, minRand, maxRand );
+	if ( evaluationGroupSize > 0 )
+	{
+		return evaluationGroupSize;
+	}
+	
+	// smallest multiple of the number of threads with at least 16 chromosomes
+	unsigned int threads = evaluationThreads();
+	
+	return threads * max( 2u, ( 16 + threads - 1 ) / threads );
+}
+
+void NetSolver::evaluateGroup( unsigned int count, unsigned int total )
+{
+	const NNetPlan &plan = net.getPlan();
+	
+	unsigned int numberOfCells = plan.numberOfCells();
+	
+	for ( unsigned int g = 0; g < count; g++ )
+	{
+		prepareEvaluation( evaluationGroup[ g ] );
+	}
+	
+	/*--------------------------------------------
+		Scheduler: one chromosome per thread if
+		the whole evaluation has enough
+		chromosomes (or too few mini-batches),
+		otherwise the mini-batches of each
+		chromosome are distributed
+	----------------------------------------------*/
+	
+	int threads = evaluationThreads();
+	
+	ParallelEvaluation mode = parallelEvaluation;
+	
+	if ( mode == AUTOMATIC_PARALLELISM )
+	{
+		bool enoughChromosomes = total >= 2 * ( unsigned int ) threads;
+		bool enoughMiniBatches = miniBatchOrder.size() >= 2 * ( unsigned int ) threads;
+		
+		mode = enoughChromosomes || !enoughMiniBatches ? ACROSS_CHROMOSOMES : ACROSS_SAMPLES;
+	}
+	
+	if ( threads == 1 || count == 0 )
+	{
+		mode = ACROSS_CHROMOSOMES;
+	}
+	
+	lastParallelEvaluation = mode;
+	
+	if ( evaluationContexts.size() < ( unsigned int ) threads )
+	{
+		evaluationContexts.resize( threads );
+	}
+	
+	for ( int t = 0; t < threads; t++ )
+	{
+		evaluationContexts[ t ].activations.resize( numberOfCells * miniBatchSize );
+		evaluationContexts[ t ].workspace.resize( numberOfCells * miniBatchSize );
+	}
+	
+	if ( mode == ACROSS_CHROMOSOMES )
+	{
+		#pragma omp parallel for schedule( dynamic ) num_threads( threads )
+		for ( int g = 0; g < ( int ) count; g++ )
+		{
+			int t = 0;
+			
+#ifdef _OPENMP
+			t = omp_get_thread_num();
+#endif
+			
+			DataEvaluation &evaluation = evaluationGroup[ g ];
+			
+			for ( unsigned int b = 0; b < miniBatchOrder.size(); b++ )
+			{
+				double sum = 0;
+				double sumOfSquares = 0;
+				
+				evaluateMiniBatch( evaluation, b, evaluationContexts[ t ], sum, sumOfSquares );
+				
+				if ( !addMiniBatch( evaluation, b, sum, sumOfSquares ) )
+				{
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		vector <double> sums( threads );
+		vector <double> sumsOfSquares( threads );
+		
+		for ( unsigned int g = 0; g < count; g++ )
+		{
+			DataEvaluation &evaluation = evaluationGroup[ g ];
+			
+			// rounds of one mini-batch per thread, added in the same order as above
+			for ( unsigned int first = 0; first < miniBatchOrder.size(); first += threads )
+			{
+				int roundSize = min( ( unsigned int ) threads, ( unsigned int ) miniBatchOrder.size() - first );
+				
+				#pragma omp parallel for schedule( static ) num_threads( threads )
+				for ( int r = 0; r < roundSize; r++ )
+				{
+					evaluateMiniBatch( evaluation, first + r, evaluationContexts[ r ], sums[ r ], sumsOfSquares[ r ] );
+				}
+				
+				int r = 0;
+				
+				while ( r < roundSize && addMiniBatch( evaluation, first + r, sums[ r ], sumsOfSquares[ r ] ) )
+				{
+					r++;
+				}
+				
+				if ( r < roundSize )
+				{
+					break;
+				}
+			}
+		}
+	}
+	
+	for ( unsigned int g = 0; g < count; g++ )
+	{
+		finishEvaluation( evaluationGroup[ g ] );
+	}
+}
+
+void NetSolver::prepareEvaluation( DataEvaluation &evaluation )
+{
+	const GenFloat::ChromosomeClass &chromosome = *evaluation.chromosome;
+	
+	unsigned int numberOfConnections = net.numberOfConnections();
+	
+	evaluation.base = UINT_MAX;
+	evaluation.sum = 0;
+	evaluation.sumOfSquares = 0;
+	evaluation.samples = 0;
+	evaluation.error = 0;
+	
+	/*--------------------------------------------
+		Weights of the net
+	----------------------------------------------*/
+	
+	if ( topologyEvolution )
+	{
+		evaluation.weights.assign( numberOfConnections, 0.0 );
+		
+		if ( numberOfConnections > 0 )
+		{
+			decodeWeights( chromosome, &evaluation.weights[ 0 ], 1 );
+		}
+	}
+	else if ( chromosome.size() != numberOfConnections )
+	{
+		evaluation.weights.assign( chromosome.begin(), chromosome.begin() + min( ( unsigned int ) chromosome.size(), numberOfConnections ) );
+		evaluation.weights.resize( numberOfConnections, 0.0 );
+	}
+	else
+	{
+		// the slot may hold the weights of an earlier chromosome
+		evaluation.weights.clear();
+	}
+	
+	// evaluate directly from the chromosome if possible
+	if ( !evaluation.weights.empty() )
+	{
+		evaluation.weightData = &evaluation.weights[ 0 ];
+	}
+	else
+	{
+		evaluation.weightData = chromosome.empty() ? NULL : &chromosome[ 0 ];
+	}
+	
+	/*--------------------------------------------
+		Incremental evaluation: a chromosome of
+		the last generation with few different
+		weights is the base
+	----------------------------------------------*/
+	
+	evaluation.record = incrementalEvaluation() && chromosome.size() == numberOfConnections;
+	
+	if ( !evaluation.record )
+	{
+		return;
+	}
+	
+	evaluation.recordedActivations.resize( net.getPlan().numberOfCells() * numberOfTrainingSamples );
+	
+	for ( unsigned int c = 0; c < numberOfCachedChromosomes && evaluation.base == UINT_MAX; c++ )
+	{
+		if ( cachedWeights[ c ].size() != chromosome.size() )
+		{
+			continue;
+		}
+		
+		unsigned int differences = 0;
+		
+		for ( unsigned int j = 0; j < chromosome.size() && differences <= maxChangedWeights; j++ )
+		{
+			if ( chromosome[ j ] != cachedWeights[ c ][ j ] )
+			{
+				differences++;
+			}
+		}
+		
+		if ( differences <= maxChangedWeights )
+		{
+			evaluation.base = c;
+		}
+	}
+}
+
+void NetSolver::evaluateMiniBatch( DataEvaluation &evaluation, unsigned int b, EvaluationContext &context,
+                                   double &sum, double &sumOfSquares ) const
+{
+	const NNetPlan &plan = net.getPlan();
+	
+	unsigned int numberOfCells = plan.numberOfCells();
+	unsigned int numberOfInputs = plan.inputs.size();
+	unsigned int numberOfOutputs = plan.outputs.size();
+	
+	unsigned int first = miniBatchOrder[ b ] * miniBatchSize;
+	unsigned int count = min( miniBatchSize, numberOfTrainingSamples - first );
+	
+	// activations of all cells are kept mini-batch by mini-batch for the incremental evaluation
+	double *activations = evaluation.record ?
+	                      &evaluation.recordedActivations[ first * numberOfCells ] : &context.activations[ 0 ];
+	
+	if ( evaluation.base != UINT_MAX )
+	{
+		plan.forwardDelta( &cachedActivations[ evaluation.base ][ first * numberOfCells ],
+		                   &cachedWeights[ evaluation.base ][ 0 ], activations, count,
+		                   &context.workspace[ 0 ], evaluation.weightData );
+	}
+	else
+	{
+		fill( activations, activations + numberOfCells * count, 0.0 );
+		
+		const double *inputs = &trainingInputs[ first * numberOfInputs ];
+		
+		for ( unsigned int i = 0; i < count; i++ )
+		{
+			for ( unsigned int j = 0; j < numberOfInputs; j++ )
+			{
+				activations[ plan.inputs[ j ] * count + i ] = inputs[ i * numberOfInputs + j ];
+			}
+		}
+		
+		plan.forwardBatch( activations, count, &context.workspace[ 0 ], evaluation.weightData );
+	}
+	
+	/*--------------------------------------------
+		Squared errors of the mini-batch
+	----------------------------------------------*/
+	
+	const double *targets = &trainingTargets[ first * numberOfOutputs ];
+	
+	sum = 0;
+	sumOfSquares = 0;
+	
+	for ( unsigned int i = 0; i < count; i++ )
+	{
+		double e = 0;
+		
+		for ( unsigned int j = 0; j < numberOfOutputs; j++ )
+		{
+			double d = activations[ plan.outputs[ j ] * count + i ] - targets[ i * numberOfOutputs + j ];
+			e += d * d;
+		}
+		
+		e /= numberOfOutputs;
+		
+		sum += e;
+		sumOfSquares += e * e;
+	}
+}
+
+bool NetSolver::addMiniBatch( DataEvaluation &evaluation, unsigned int b, double sum, double sumOfSquares ) const
+{
+	unsigned int first = miniBatchOrder[ b ] * miniBatchSize;
+	
+	evaluation.sum += sum;
+	evaluation.sumOfSquares += sumOfSquares;
+	evaluation.samples += min( miniBatchSize, numberOfTrainingSamples - first );
+	
+	/*--------------------------------------------
+		Racing: stop if the error can't be
+		smaller than the bound (at least two
+		mini-batches for the variance), the
+		incremental evaluation is cheap enough
+	----------------------------------------------*/
+	
+	unsigned int samples = evaluation.samples;
+	
+	if ( evaluation.maxError < HUGE_VAL && evaluation.base == UINT_MAX && b > 0 && samples < numberOfGenerationSamples )
+	{
+		double mean = evaluation.sum / samples;
+		double variance = max( 0.0, ( evaluation.sumOfSquares - samples * mean * mean ) / ( samples - 1 ) );
+		double remaining = ( double ) ( numberOfGenerationSamples - samples ) / ( numberOfGenerationSamples - 1 );
+		double standardError = sqrt( variance / samples * remaining );
+		
+		if ( mean - racingDeviations * standardError > evaluation.maxError )
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void NetSolver::finishEvaluation( DataEvaluation &evaluation )
+{
+	evaluatedSamples += evaluation.samples;
+	evaluatedChromosomes++;
+	
+	if ( evaluation.base != UINT_MAX )
+	{
+		incrementalEvaluations++;
+	}
+	
+	evaluation.error = evaluation.sum / max( evaluation.samples, 1u );
+	
+	evaluation.chromosome->setFitness( 1.0 / ( 1.0 + evaluation.error ) );
+	
+	if ( evaluation.record && evaluation.samples == numberOfGenerationSamples )
+	{
+		cacheActivations( evaluation );
+	}
+}
+
+void NetSolver::enableIncrementalEvaluation( unsigned int maxChangedWeights, unsigned int cacheSize )
+{
+	this->maxChangedWeights = maxChangedWeights;
+	this->cacheSize = cacheSize;
+	
+	numberOfCachedChromosomes = 0;
+	nextErrors.clear();
+}
+
+unsigned int NetSolver::numberOfIncrementalEvaluations() const
+{
+	return incrementalEvaluations;
+}
+
+bool NetSolver::incrementalEvaluation() const
+{
+	return cacheSize > 0 && miniBatchesPerGeneration == 0 && !topologyEvolution;
+}
+
+void NetSolver::cacheActivations( DataEvaluation &evaluation )
+{
+	unsigned int slot = nextErrors.size();
+	
+	if ( slot == cacheSize )
+	{
+		// replaces the worst one
+		slot = max_element( nextErrors.begin(), nextErrors.end() ) - nextErrors.begin();
+		
+		if ( evaluation.error >= nextErrors[ slot ] )
+		{
+			return;
+		}
+	}
+	else
+	{
+		nextErrors.push_back( evaluation.error );
+		
+		if ( nextActivations.size() <= slot )
+		{
+			nextActivations.resize( slot + 1 );
+			nextWeights.resize( slot + 1 );
+		}
+	}
+	
+	nextErrors[ slot ] = evaluation.error;
+	nextWeights[ slot ].assign( evaluation.chromosome->begin(), evaluation.chromosome->end() );
+	
+	// no copy, the buffer of the slot is used for the next chromosome
+	nextActivations[ slot ].swap( evaluation.recordedActivations );
+}
+
+void NetSolver::setParallelEvaluation( ParallelEvaluation mode )
+{
+	parallelEvaluation = mode;
+}
+
+NetSolver::ParallelEvaluation NetSolver::lastParallelism() const
+{
+	return lastParallelEvaluation;
+}
+
+void NetSolver::setEvaluationGroupSize( unsigned int size )
+{
+	evaluationGroupSize = size;
+}
+
+void NetSolver::batchFitnessFunction()
+{
+	unsigned int first = actualEntityID;
+	
+	for ( unsigned int p = 0; p < actualEntities.size(); p++ )
+	{
+		actualEntity = actualEntities[ p ];
+		
+		bindWeights( actualEntity );
+		net.reset();
+		
+		actualEntityID = first + p;
+		
+		fitnessFunction();
+		
+		if (_solution)
+		{
+			break;
+		}
+	}
+	
+	actualEntityID = first;
+}
+
+bool NetSolver::sendSignals( const double *inputs, unsigned int numberOfSamples, double *outputs )
+{
+	if ( actualEntities.empty() )
+	{
+		return true;
+	}
+	
+	return net.sendSignals( inputs, numberOfSamples, &batchWeights[ 0 ], actualEntities.size(), outputs );
+}
+
+void NetSolver::setBatchSize( unsigned int size )
+{
+	batchSize = size;
+}
+
+void NetSolver::bindWeights( GenFloat::ChromosomeClass *chromosome )
+{
+	if ( topologyEvolution )
+	{
+		chromosomeWeights.assign( net.numberOfConnections(), 0.0 );
+		
+		decodeWeights( *chromosome, &chromosomeWeights[ 0 ], 1 );
+		
+		if ( !net.bindWeights( &chromosomeWeights[ 0 ] ) )
+		{
+			net.setWeights( chromosomeWeights );
+		}
+	}
+	// evaluate directly from the chromosome if possible
+	else if ( chromosome->size() != ( unsigned int ) net.numberOfConnections() ||
+	          !net.bindWeights( &( *chromosome ) [ 0 ] ) )
+	{
+		net.setWeights( *chromosome );
+	}
+	
+	// fitnessFunction() may read Cell::weights or call net.saveNet()
+	net.copyWeightsToCells();
+}
+
+void NetSolver::setWeightBlocks( WeightBlocks blocks )
+{
+	weightBlocks = blocks;
+	
+	updateWeightBlocks();
+}
+
+void NetSolver::updateWeightBlocks()
+{
+	blockStart.clear();
+	blockWeights.clear();
+	
+	if ( weightBlocks == SINGLE_WEIGHTS || topologyEvolution )
+	{
+		return;
+	}
+	
+	/*--------------------------------------------
+		Position of each cell: topological
+		order of the plan (layer by layer),
+		cells that are not reached from the
+		inputs follow in the order of the cells
+	----------------------------------------------*/
+	
+	const NNetPlan &plan = net.getPlan();
+	
+	unsigned int numberOfCells = plan.numberOfCells();
+	unsigned int numberOfConnections = plan.targets.size();
+	
+	vector <unsigned int> rank( numberOfCells, UINT_MAX );
+	
+	unsigned int ranked = 0;
+	
+	for ( unsigned int i = 0; i < plan.order.size(); i++ )
+	{
+		rank[ plan.order[ i ] ] = ranked++;
+	}
+	
+	for ( unsigned int c = 0; c < numberOfCells; c++ )
+	{
+		if ( rank[ c ] == UINT_MAX )
+		{
+			rank[ c ] = ranked++;
+		}
+	}
+	
+	/*--------------------------------------------
+		Weights of each cell in this order,
+		the chromosome stores the outgoing
+		weights of a cell one after another
+		(see NNetPlan::rowStart)
+	----------------------------------------------*/
+	
+	vector <unsigned int> cellOfWeight( numberOfConnections );
+	
+	for ( unsigned int c = 0; c < numberOfCells; c++ )
+	{
+		for ( unsigned int j = plan.rowStart[ c ]; j < plan.rowStart[ c + 1 ]; j++ )
+		{
+			cellOfWeight[ j ] = rank[ weightBlocks == INCOMING_WEIGHTS ? plan.targets[ j ] : c ];
+		}
+	}
+	
+	vector <unsigned int> start( numberOfCells + 1, 0 );
+	
+	for ( unsigned int j = 0; j < numberOfConnections; j++ )
+	{
+		start[ cellOfWeight[ j ] + 1 ]++;
+	}
+	
+	for ( unsigned int c = 0; c < numberOfCells; c++ )
+	{
+		start[ c + 1 ] += start[ c ];
+	}
+	
+	blockWeights.resize( numberOfConnections );
+	
+	vector <unsigned int> position( start.begin(), start.end() - 1 );
+	
+	for ( unsigned int j = 0; j < numberOfConnections; j++ )
+	{
+		blockWeights[ position[ cellOfWeight[ j ] ]++ ] = j;
+	}
+	
+	// cells without weights are no blocks
+	for ( unsigned int c = 0; c < numberOfCells; c++ )
+	{
+		if ( start[ c + 1 ] > start[ c ] )
+		{
+			blockStart.push_back( start[ c ] );
+		}
+	}
+	
+	blockStart.push_back( numberOfConnections );
+}
+
+bool NetSolver::crossBlocks( const GenFloat::ChromosomeClass &chromosome ) const
+{
+	// at least two blocks for a cross point
+	return blockStart.size() > 2 && chromosome.size() == blockWeights.size();
+}
+
+void NetSolver::enableTopologyEvolution( double addConnectionRate, double addNodeRate )
+{
+	topologyEvolution = true;
+	this->addConnectionRate = addConnectionRate;
+	this->addNodeRate = addNodeRate;
+}
+
+unsigned int NetSolver::numberOfInnovations() const
+{
+	return innovationSender.size();
+}
+
+void NetSolver::initializeTopology()
+{
+	/*--------------------------------------------
+		Nodes: inputs, outputs (in the order
+		of the input and output cells of net)
+	----------------------------------------------*/
+	
+	numberOfInputNodes = net.getPlan().inputs.size();
+	numberOfOutputNodes = net.getPlan().outputs.size();
+	
+	nodeDepth.assign( numberOfInputNodes, 0.0 );
+	nodeDepth.resize( numberOfInputNodes + numberOfOutputNodes, 1.0 );
+	
+	innovationSender.clear();
+	innovationReceiver.clear();
+	innovationOfConnection.clear();
+	splitNode.clear();
+	
+	for ( unsigned int i = 0; i < numberOfInputNodes; i++ )
+	{
+		for ( unsigned int o = 0; o < numberOfOutputNodes; o++ )
+		{
+			createInnovation( i, numberOfInputNodes + o );
+		}
+	}
+	
+	rebuildNet( vector <char> ( innovationSender.size(), 1 ) );
+}
+
+unsigned int NetSolver::createInnovation( unsigned int sender, unsigned int receiver )
+{
+	pair <unsigned int, unsigned int> connection( sender, receiver );
+	
+	map < pair <unsigned int, unsigned int>, unsigned int >::const_iterator i =
+	    innovationOfConnection.find( connection );
+	
+	if ( i != innovationOfConnection.end() )
+	{
+		return i->second;
+	}
+	
+	unsigned int innovation = innovationSender.size();
+	
+	innovationSender.push_back( sender );
+	innovationReceiver.push_back( receiver );
+	splitNode.push_back( UINT_MAX );
+	innovationOfConnection[ connection ] = innovation;
+	
+	return innovation;
+}
+
+unsigned int NetSolver::createNode( unsigned int innovation )
+{
+	// all chromosomes that split this connection get the same node
+	if ( splitNode[ innovation ] != UINT_MAX )
+	{
+		return splitNode[ innovation ];
+	}
+	
+	double senderDepth = nodeDepth[ innovationSender[ innovation ] ];
+	double receiverDepth = nodeDepth[ innovationReceiver[ innovation ] ];
+	double depth = 0.5 * ( senderDepth + receiverDepth );
+	
+	// the precision of the depth is exhausted
+	if ( depth <= senderDepth || depth >= receiverDepth )
+	{
+		return UINT_MAX;
+	}
+	
+	splitNode[ innovation ] = nodeDepth.size();
+	nodeDepth.push_back( depth );
+	
+	return splitNode[ innovation ];
+}
+
+/*--------------------------------------------
+	Index of the gene with the specified
+	innovation number (the genes are sorted)
+	or UINT_MAX
+----------------------------------------------*/
+
+static unsigned int findGene( const GenFloat::ChromosomeClass &chromosome, unsigned int innovation )
+{
+	unsigned int first = 0;
+	unsigned int last = chromosome.size() / geneSize;
+	
+	while ( first < last )
+	{
+		unsigned int middle = ( first + last ) / 2;
+		
+		if ( chromosome[ middle * geneSize ] < innovation )
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	
+	if ( first < chromosome.size() / geneSize && chromosome[ first * geneSize ] == innovation )
+	{
+		return first;
+	}
+	
+	return UINT_MAX;
+}
+
+static void insertGene( GenFloat::ChromosomeClass *chromosome, unsigned int innovation, double weight )
+{
+	unsigned int g = 0;
+	
+	while ( g < chromosome->size() / geneSize && ( *chromosome ) [ g * geneSize ] < innovation )
+	{
+		g++;
+	}
+	
+	double gene[ geneSize ] = { ( double ) innovation, weight, 1 };
+	
+	chromosome->insert( chromosome->begin() + g * geneSize, gene, gene + geneSize );
+	chromosome->subGeneSizes.push_back( geneSize );
+}
+
+void NetSolver::addConnectionGene( GenFloat::ChromosomeClass *chromosome, RandStream &stream )
+{
+	unsigned int genes = chromosome->size() / geneSize;
+	
+	/*--------------------------------------------
+		Nodes of the chromosome
+	----------------------------------------------*/
+	
+	vector <unsigned int> nodes;
+	
+	for ( unsigned int i = 0; i < numberOfInputNodes + numberOfOutputNodes; i++ )
+	{
+		nodes.push_back( i );
+	}
+	
+	for ( unsigned int g = 0; g < genes; g++ )
+	{
+		unsigned int innovation = ( unsigned int ) ( *chromosome ) [ g * geneSize ];
+		
+		nodes.push_back( innovationSender[ innovation ] );
+		nodes.push_back( innovationReceiver[ innovation ] );
+	}
+	
+	sort( nodes.begin(), nodes.end() );
+	nodes.erase( unique( nodes.begin(), nodes.end() ), nodes.end() );
+	
+	/*--------------------------------------------
+		Connect two random nodes, the deeper
+		one is the receiver
+	----------------------------------------------*/
+	
+	for ( unsigned int attempt = 0; attempt < 20; attempt++ )
+	{
+		unsigned int sender = nodes[ stream.randInt( 0, nodes.size() - 1 ) ];
+		unsigned int receiver = nodes[ stream.randInt( 0, nodes.size() - 1 ) ];
+		
+		if ( nodeDepth[ sender ] == nodeDepth[ receiver ] )
+		{
+			continue;
+		}
+		
+		if ( nodeDepth[ sender ] > nodeDepth[ receiver ] )
+		{
+			swap( sender, receiver );
+		}
+		
+		map < pair <unsigned int, unsigned int>, unsigned int >::const_iterator i =
+		    innovationOfConnection.find( make_pair( sender, receiver ) );
+		
+		if ( i != innovationOfConnection.end() && findGene( *chromosome, i->second ) != UINT_MAX )
+		{
+			continue;
+		}
+		
+		insertGene( chromosome, createInnovation( sender, receiver ),
+		            chromosome->randFunction( minRandValue, maxRandValue, stream ) );
+		
+		return;
+	}
+}
+
+void NetSolver::addNodeGene( GenFloat::ChromosomeClass *chromosome, RandStream &stream )
+{
+	vector <unsigned int> enabledGenes;
+	
+	for ( unsigned int g = 0; g < chromosome->size() / geneSize; g++ )
+	{
+		if ( ( *chromosome ) [ g * geneSize + 2 ] > 0.5 )
+		{
+			enabledGenes.push_back( g );
+		}
+	}
+	
+	if ( enabledGenes.empty() )
+	{
+		return;
+	}
+	
+	unsigned int g = enabledGenes[ stream.randInt( 0, enabledGenes.size() - 1 ) ];
+	unsigned int innovation = ( unsigned int ) ( *chromosome ) [ g * geneSize ];
+	double weight = ( *chromosome ) [ g * geneSize + 1 ];
+	
+	unsigned int node = createNode( innovation );
+	
+	if ( node == UINT_MAX )
+	{
+		return;
+	}
+	
+	unsigned int first = createInnovation( innovationSender[ innovation ], node );
+	unsigned int second = createInnovation( node, innovationReceiver[ innovation ] );
+	
+	// the connection has already been split
+	if ( findGene( *chromosome, first ) != UINT_MAX || findGene( *chromosome, second ) != UINT_MAX )
+	{
+		return;
+	}
+	
+	/*--------------------------------------------
+		sender -> node (weight 1) -> receiver
+		(old weight), i.e. the net nearly
+		behaves as before
+	----------------------------------------------*/
+	
+	( *chromosome ) [ g * geneSize + 2 ] = 0;
+	
+	insertGene( chromosome, first, 1 );
+	insertGene( chromosome, second, weight );
+}
+
+void NetSolver::mutate( GenFloat::ChromosomeClass *chromosome )
+{
+	if ( !topologyEvolution )
+	{
+		GenFloat::PopulationClass::mutate( chromosome );
+		return;
+	}
+	
+	RandStream stream( rand() );
+	
+	mutate( chromosome, stream );
+}
+
+void NetSolver::mutate( GenFloat::ChromosomeClass *chromosome, RandStream &stream )
+{
+	if ( !topologyEvolution )
+	{
+		GenFloat::PopulationClass::mutate( chromosome, stream );
+		return;
+	}
+	
+	for ( unsigned int g = 0; g < chromosome->size() / geneSize; g++ )
+	{
+		if ( stream.randFloat() < mutationRate )
+		{
+			chromosome->mutate( g * geneSize + 1, minRandValue, maxRandValue, stream );
+		}
+	}
+	
+	bool addNode = stream.randFloat() < addNodeRate;
+	bool addConnection = stream.randFloat() < addConnectionRate;
+	
+	if ( !addNode && !addConnection )
+	{
+		return;
+	}
+	
+	// the innovations are shared by all chromosomes, see applyStructuralMutations()
+	if ( breeding )
+	{
+		StructuralMutation mutation = { chromosome, stream.next(), addNode, addConnection };
+		
+		#pragma omp critical ( netSolverInnovations )
+		structuralMutations.push_back( mutation );
+		
+		return;
+	}
+	
+	if ( addNode )
+	{
+		addNodeGene( chromosome, stream );
+	}
+	
+	if ( addConnection )
+	{
+		addConnectionGene( chromosome, stream );
+	}
+}
+
+void NetSolver::createNewGeneration()
+{
+	breeding = true;
+	
+	GenFloat::PopulationClass::createNewGeneration();
+	
+	breeding = false;
+	
+	applyStructuralMutations();
+}
+
+void NetSolver::applyStructuralMutations()
+{
+	if ( structuralMutations.empty() )
+	{
+		return;
+	}
+	
+	/*--------------------------------------------
+		Order of the chromosomes in the new
+		generation, i.e. the same innovations
+		for any number of threads
+	----------------------------------------------*/
+	
+	map <const GenFloat::ChromosomeClass*, unsigned int> indexOfChromosome;
+	
+	for ( unsigned int k = 0; k < newGeneration->size(); k++ )
+	{
+		indexOfChromosome[ ( *newGeneration ) ( k ) ] = k;
+	}
+	
+	// mutations of the same chromosome keep their order
+	vector < pair <unsigned int, unsigned int> > order;
+	
+	for ( unsigned int m = 0; m < structuralMutations.size(); m++ )
+	{
+		order.push_back( make_pair( indexOfChromosome[ structuralMutations[ m ].chromosome ], m ) );
+	}
+	
+	sort( order.begin(), order.end() );
+	
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		const StructuralMutation &mutation = structuralMutations[ order[ i ].second ];
+		
+		RandStream stream( mutation.seed );
+		
+		if ( mutation.addNode )
+		{
+			addNodeGene( mutation.chromosome, stream );
+		}
+		
+		if ( mutation.addConnection )
+		{
+			addConnectionGene( mutation.chromosome, stream );
+		}
+	}
+	
+	structuralMutations.clear();
+}
+
+void NetSolver::crossOver( const GenFloat::ChromosomeClass &p1, const GenFloat::ChromosomeClass &p2,
+                           GenFloat::ChromosomeClass &baby1, GenFloat::ChromosomeClass &baby2,
+                           RandStream &stream ) const
+{
+	if ( !topologyEvolution && !( crossBlocks( p1 ) && crossBlocks( p2 ) ) )
+	{
+		GenFloat::PopulationClass::crossOver( p1, p2, baby1, baby2, stream );
+		return;
+	}
+	
+	if ( !topologyEvolution )
+	{
+		/*--------------------------------------------
+			One cross point between two blocks,
+			chosen like the cross point of the
+			default crossover
+		----------------------------------------------*/
+		
+		unsigned int numberOfBlocks = blockStart.size() - 1;
+		
+		double minCrossPoint = 1. * ( numberOfBlocks - 1 ) / 100 * minCrossValue[ 0 ];
+		double maxCrossPoint = 1. * ( numberOfBlocks - 1 ) / 100 * maxCrossValue[ 0 ];
+		
+		unsigned int crossPoint = stream.randInt( int( minCrossPoint ), int( maxCrossPoint ) );
+		
+		bool cross = stream.randFloat() < crossOverRate;
+		
+		baby1 = p1;
+		baby2 = p2;
+		
+		if ( !cross )
+		{
+			return;
+		}
+		
+		for ( unsigned int i = blockStart[ crossPoint ]; i < blockWeights.size(); i++ )
+		{
+			unsigned int j = blockWeights[ i ];
+			
+			baby1[ j ] = p2[ j ];
+			baby2[ j ] = p1[ j ];
+		}
+		
+		return;
+	}
+	
+	if ( stream.randFloat() >= crossOverRate )
+	{
+		baby1 = p1;
+		baby2 = p2;
+		return;
+	}
+	
+	const GenFloat::ChromosomeClass &fitter = p2.fitness() > p1.fitness() ? p2 : p1;
+	const GenFloat::ChromosomeClass &other = p2.fitness() > p1.fitness() ? p1 : p2;
+	
+	GenFloat::ChromosomeClass *babies[ 2 ] = { &baby1, &baby2 };
+	
+	for ( unsigned int b = 0; b < 2; b++ )
+	{
+		GenFloat::ChromosomeClass baby;
+		
+		unsigned int j = 0;
+		
+		for ( unsigned int i = 0; i < fitter.size(); i += geneSize )
+		{
+			// skip the genes only the other parent has
+			while ( j < other.size() && other[ j ] < fitter[ i ] )
+			{
+				j += geneSize;
+			}
+			
+			const GenFloat::ChromosomeClass &parent =
+			    j < other.size() && other[ j ] == fitter[ i ] && stream.randFloat() < 0.5 ? other : fitter;
+			
+			unsigned int k = &parent == &fitter ? i : j;
+			
+			baby.insert( baby.end(), parent.begin() + k, parent.begin() + k + geneSize );
+			baby.subGeneSizes.push_back( geneSize );
+		}
+		
+		*babies[ b ] = baby;
+	}
+}
+
+void NetSolver::decodeWeights( const GenFloat::ChromosomeClass &chromosome, double *weights,
+                               unsigned int stride ) const
+{
+	for ( unsigned int i = 0; i < chromosome.size(); i += geneSize )
+	{
+		unsigned int index = weightIndex[ ( unsigned int ) chromosome[ i ] ];
+		
+		if ( chromosome[ i + 2 ] > 0.5 && index != UINT_MAX )
+		{
+			weights[ index * stride ] = chromosome[ i + 1 ];
+		}
+	}
+}
+
+void NetSolver::updateTopology()
+{
+	// innovations and nodes of the last generation
+	weightIndex.resize( innovationSender.size(), UINT_MAX );
+	cellOfNode.resize( nodeDepth.size(), UINT_MAX );
+	
+	/*--------------------------------------------
+		Innovations used by the generation
+	----------------------------------------------*/
+	
+	vector <char> used( innovationSender.size(), 0 );
+	
+	for ( unsigned int k = 0; k < newGeneration->size(); k++ )
+	{
+		const GenFloat::ChromosomeClass &chromosome = *( *newGeneration ) ( k );
+		
+		for ( unsigned int i = 0; i < chromosome.size(); i += geneSize )
+		{
+			if ( chromosome[ i + 2 ] > 0.5 )
+			{
+				used[ ( unsigned int ) chromosome[ i ] ] = 1;
+			}
+		}
+	}
+	
+	unsigned int numberOfUsed = 0;
+	unsigned int numberOfUsedInNet = 0;
+	
+	for ( unsigned int i = 0; i < used.size(); i++ )
+	{
+		if ( used[ i ] )
+		{
+			numberOfUsed++;
+			
+			if ( weightIndex[ i ] != UINT_MAX ) numberOfUsedInNet++;
+		}
+	}
+	
+	/*--------------------------------------------
+		Generate the net again if more than
+		half of its connections are unused,
+		otherwise patch it
+	----------------------------------------------*/
+	
+	if ( net.numberOfConnections() - numberOfUsedInNet > numberOfUsed )
+	{
+		rebuildNet( used );
+		return;
+	}
+	
+	for ( unsigned int i = 0; i < used.size(); i++ )
+	{
+		if ( used[ i ] && weightIndex[ i ] == UINT_MAX )
+		{
+			addInnovation( i );
+		}
+	}
+}
+
+void NetSolver::rebuildNet( const vector <char> &used )
+{
+	/*--------------------------------------------
+		Cells: inputs, outputs, hidden nodes
+	----------------------------------------------*/
+	
+	cellOfNode.assign( nodeDepth.size(), UINT_MAX );
+	weightIndex.assign( innovationSender.size(), UINT_MAX );
+	
+	unsigned int numberOfCells = numberOfInputNodes + numberOfOutputNodes;
+	
+	vector <int> inputs;
+	vector <int> outputs;
+	
+	for ( unsigned int i = 0; i < numberOfCells; i++ )
+	{
+		cellOfNode[ i ] = i;
+		
+		if ( i < numberOfInputNodes )
+		{
+			inputs.push_back( i );
+		}
+		else
+		{
+			outputs.push_back( i );
+		}
+	}
+	
+	for ( unsigned int i = 0; i < used.size(); i++ )
+	{
+		if ( used[ i ] && cellOfNode[ innovationSender[ i ] ] == UINT_MAX )
+		{
+			cellOfNode[ innovationSender[ i ] ] = 0;
+		}
+		
+		if ( used[ i ] && cellOfNode[ innovationReceiver[ i ] ] == UINT_MAX )
+		{
+			cellOfNode[ innovationReceiver[ i ] ] = 0;
+		}
+	}
+	
+	for ( unsigned int node = numberOfInputNodes + numberOfOutputNodes; node < nodeDepth.size(); node++ )
+	{
+		if ( cellOfNode[ node ] != UINT_MAX )
+		{
+			cellOfNode[ node ] = numberOfCells++;
+		}
+	}
+	
+	/*--------------------------------------------
+		Connections grouped by sender, i.e. in
+		the order of the weights
+	----------------------------------------------*/
+	
+	vector < pair <unsigned int, unsigned int> > connections;
+	
+	for ( unsigned int i = 0; i < used.size(); i++ )
+	{
+		if ( used[ i ] )
+		{
+			connections.push_back( make_pair( cellOfNode[ innovationSender[ i ] ], i ) );
+		}
+	}
+	
+	sort( connections.begin(), connections.end() );
+	
+	vector <netConnection> connectionList;
+	
+	for ( unsigned int e = 0; e < connections.size(); e++ )
+	{
+		unsigned int innovation = connections[ e ].second;
+		
+		connectionList.push_back( netConnection( ( int ) connections[ e ].first,
+		                          ( int ) cellOfNode[ innovationReceiver[ innovation ] ], 0 ) );
+		
+		weightIndex[ innovation ] = e;
+	}
+	
+	net.generateNet( inputs, outputs, connectionList );
+}
+
+void NetSolver::addInnovation( unsigned int innovation )
+{
+	unsigned int nodes[ 2 ] = { innovationSender[ innovation ], innovationReceiver[ innovation ] };
+	
+	for ( unsigned int n = 0; n < 2; n++ )
+	{
+		if ( cellOfNode[ nodes[ n ] ] == UINT_MAX )
+		{
+			cellOfNode[ nodes[ n ] ] = net.addCell();
+		}
+	}
+	
+	unsigned int sender = cellOfNode[ nodes[ 0 ] ];
+	
+	net.addConnection( sender, cellOfNode[ nodes[ 1 ] ], 0 );
+	
+	// the weights of the later cells move by one
+	unsigned int index = net.getPlan().rowStart[ sender + 1 ] - 1;
+	
+	for ( unsigned int i = 0; i < weightIndex.size(); i++ )
+	{
+		if ( weightIndex[ i ] != UINT_MAX && weightIndex[ i ] >= index )
+		{
+			weightIndex[ i ] ++;
+		}
+	}
+	
+	weightIndex[ innovation ] = index;
+}
+
+void NetSolver::storeChromosome( const GenFloat::ChromosomeClass &chromosome )
+{
+	if ( !topologyEvolution )
+	{
+		net.setWeights( chromosome );
+		return;
+	}
+	
+	weightIndex.resize( innovationSender.size(), UINT_MAX );
+	cellOfNode.resize( nodeDepth.size(), UINT_MAX );
+	
+	for ( unsigned int i = 0; i < chromosome.size(); i += geneSize )
+	{
+		unsigned int innovation = ( unsigned int ) chromosome[ i ];
+		
+		if ( chromosome[ i + 2 ] > 0.5 && weightIndex[ innovation ] == UINT_MAX )
+		{
+			addInnovation( innovation );
+		}
+	}
+	
+	vector <double> weights( net.numberOfConnections(), 0.0 );
+	
+	decodeWeights( chromosome, &weights[ 0 ], 1 );
+	
+	net.setWeights( weights );
 }
@@ -20,6 +20,19 @@
 
 #include "libnnet.h"
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <climits>
+#include <cstdlib>
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
 #include <genutil.h>
 
 Cell::Cell()
@@ -91,192 +104,1885 @@ void Cell::sendSignals()
 
 
 
-NNet::NNet()
+/*--------------------------------------------
+	Rational minimax approximation of tanh
+	(odd polynomial of degree 13 divided by
+	an even polynomial of degree 6), valid
+	for |x| <= 7.99881, tanh is +-1 up to
+	rounding outside of this range
+----------------------------------------------*/
+
+static inline double tanhApproximation( double x )
 {
-	setMemory( false );
+	const double bound = 7.99881172180175781;
+
+	// clamp without comparisons (they prevent vectorization)
+	x = 0.5 * ( fabs( x + bound ) - fabs( x - bound ) );
+
+	const double x2 = x * x;
+
+	double p = x2 * -2.76076847742355e-16 + 2.00018790482477e-13;
+	p = x2 * p + -8.60467152213735e-11;
+	p = x2 * p + 5.12229709037114e-08;
+	p = x2 * p + 1.48572235717979e-05;
+	p = x2 * p + 6.37261928875436e-04;
+	p = x2 * p + 4.89352455891786e-03;
+	p = x * p;
+
+	double q = x2 * 1.19825839466702e-06 + 1.18534705686654e-04;
+	q = x2 * q + 2.26843463243900e-03;
+	q = x2 * q + 4.89352518554385e-03;
+
+	return p / q;
 }
 
-NNet::NNet( std::string fileName )
+/*--------------------------------------------
+	Lookup tables, sampled on [-range, range]
+	with linear interpolation, values outside
+	are clamped
+----------------------------------------------*/
+
+static const unsigned int tableSize = 4096;
+static const double sigmoidRange = 16.0;
+static const double tanhRange = 8.0;
+
+static const double *createTable( int function, double range )
 {
-	setMemory( false );
+	double *table = new double[ tableSize + 2 ];
 
-	this->loadNet( fileName );
+	for ( unsigned int i = 0; i <= tableSize; i++ )
+	{
+		double x = -range + 2 * range * i / tableSize;
+
+		table[ i ] = function == Activation::SIGMOID ? 1 / ( 1 + exp( -x ) ) : tanh( x );
+	}
+
+	// the interpolation of the last entry reads one entry behind
+	table[ tableSize + 1 ] = table[ tableSize ];
+
+	return table;
 }
 
-NNet::NNet( const NNet &net )
+static inline double tableLookup( const double *table, double range, double x )
 {
-	std::cout << __PRETTY_FUNCTION__ << " here i am" << std::endl;
+	double position = ( x + range ) * ( tableSize / ( 2 * range ) );
+
+	position = std::min( std::max( position, 0.0 ), ( double ) tableSize );
+
+	unsigned int i = ( unsigned int ) position;
+	double t = position - i;
+
+	return table[ i ] + t * ( table[ i + 1 ] - table[ i ] );
 }
 
-NNet & NNet::operator=( const NNet & net )
+static const double *sigmoidTable()
 {
-	std::cout << __PRETTY_FUNCTION__ << " here i am" << std::endl;
+	static const double *table = createTable( Activation::SIGMOID, sigmoidRange );
+	return table;
+}
 
-	//for ( int i = 0; i < net.allCells.size();i++)
-	//{
-	//        Cell *cell = new Cell();
-	//        *cell = *net.allCells[i];
+static const double *tanhTable()
+{
+	static const double *table = createTable( Activation::TANH, tanhRange );
+	return table;
+}
 
-	//        allCells.push_back(cell);
-	//}
+Activation::Activation( Function function, Precision precision )
+{
+	_function = function;
+	_precision = precision;
 
-	std::cout << ">> not available yet" << std::endl;
+	// create tables before the forward pass is used by several threads
+	if ( precision == TABLE )
+	{
+		function == TANH ? tanhTable() : sigmoidTable();
+	}
 }
 
-NNet::NNet( int numberOfInputs, int numberOfOutputs, std::vector<int> layerSize )
+const Activation::Function Activation::function() const
 {
-	setMemory( false );
+	return _function;
+}
 
-	createNet( numberOfInputs, numberOfOutputs, layerSize );
+const Activation::Precision Activation::precision() const
+{
+	return _precision;
 }
 
-bool NNet::createNet( int numberOfInputs, int numberOfOutputs, std::vector<int> layerSize )
+double Activation::operator()( double x ) const
 {
-	int numberOfCells = 0;
+	double y;
 
-	std::vector<int> _layerSize;
+	apply( &x, &y, 1 );
 
-	std::vector<int> inputs;
-	std::vector<int> outputs;
+	return y;
+}
 
-	_layerSize.push_back( numberOfInputs );
+double Activation::derivative( double x ) const
+{
+	switch ( _function )
+	{
+		case SIGMOID:
+		{
+			double y = 1 / ( 1 + exp( -x ) );
+			return y * ( 1 - y );
+		}
+		case TANH:
+		{
+			double y = tanh( x );
+			return 1 - y * y;
+		}
+		case RELU:
+			return x > 0 ? 1 : 0;
 
-	// adding hidden layers
-	for ( int i = 0; i < layerSize.size();i++ )
+		case SOFTSIGN:
+			return 1 / ( ( 1 + fabs( x ) ) * ( 1 + fabs( x ) ) );
+	}
+
+	return 0;
+}
+
+void Activation::apply( const double *x, double *y, unsigned int n ) const
+{
+	switch ( _function )
 	{
-		_layerSize.push_back( layerSize[i] );
+		case SIGMOID:
+			if ( _precision == APPROXIMATE )
+			{
+				#pragma omp simd
+				for ( unsigned int i = 0; i < n; i++ )
+				{
+					y[ i ] = 0.5 + 0.5 * tanhApproximation( 0.5 * x[ i ] );
+				}
+			}
+			else if ( _precision == TABLE )
+			{
+				const double *table = sigmoidTable();
+
+				for ( unsigned int i = 0; i < n; i++ )
+				{
+					y[ i ] = tableLookup( table, sigmoidRange, x[ i ] );
+				}
+			}
+			else
+			{
+				for ( unsigned int i = 0; i < n; i++ )
+				{
+					y[ i ] = 1 / ( 1 + exp( -x[ i ] ) );
+				}
+			}
+			break;
+
+		case TANH:
+			if ( _precision == APPROXIMATE )
+			{
+				#pragma omp simd
+				for ( unsigned int i = 0; i < n; i++ )
+				{
+					y[ i ] = tanhApproximation( x[ i ] );
+				}
+			}
+			else if ( _precision == TABLE )
+			{
+				const double *table = tanhTable();
+
+				for ( unsigned int i = 0; i < n; i++ )
+				{
+					y[ i ] = tableLookup( table, tanhRange, x[ i ] );
+				}
+			}
+			else
+			{
+				for ( unsigned int i = 0; i < n; i++ )
+				{
+					y[ i ] = tanh( x[ i ] );
+				}
+			}
+			break;
+
+		case RELU:
+			#pragma omp simd
+			for ( unsigned int i = 0; i < n; i++ )
+			{
+				y[ i ] = x[ i ] > 0 ? x[ i ] : 0;
+			}
+			break;
+
+		case SOFTSIGN:
+			#pragma omp simd
+			for ( unsigned int i = 0; i < n; i++ )
+			{
+				y[ i ] = x[ i ] / ( 1 + fabs( x[ i ] ) );
+			}
+			break;
 	}
+}
 
-	_layerSize.push_back( numberOfOutputs );
 
-	std::vector<netConnection> connections;
 
-	// find out numberOfCells
-	for ( int i = 0; i < _layerSize.size(); i++ )
+NNetPlan::NNetPlan()
+{
+	isFeedForward = false;
+	isDense = false;
+	isRecurrent = false;
+	boundWeights = NULL;
+	rowStart.push_back( 0 );
+}
+
+bool NNetPlan::compile( const std::vector <Cell*> &allCells, const std::vector <Cell*> &inputCells,
+                        const std::vector <Cell*> &outputCells )
+{
+	unsigned int numberOfCells = allCells.size();
+
+	boundWeights = NULL;
+
+	order.clear();
+	rowStart.assign( numberOfCells + 1, 0 );
+	targets.clear();
+	weights.clear();
+	inputs.clear();
+	outputs.clear();
+
+	/*--------------------------------------------
+		Store connections in CSR format
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0; i < numberOfCells; i++ )
 	{
-		numberOfCells += _layerSize[i];
+		const Cell *cell = allCells[ i ];
+
+		for ( unsigned int j = 0; j < cell->connections.size(); j++ )
+		{
+			targets.push_back( cell->connections[ j ] ->netIndex );
+			weights.push_back( cell->weights[ j ] );
+		}
+
+		rowStart[ i + 1 ] = targets.size();
 	}
 
-	// create input indices
-	for ( int  i = 0; i < numberOfInputs; i++ )
+	for ( unsigned int i = 0; i < inputCells.size(); i++ )
 	{
-		inputs.push_back( i );
+		inputs.push_back( inputCells[ i ] ->netIndex );
 	}
 
-	// create output indices
-	for ( int  i = 0; i < numberOfOutputs; i++ )
+	for ( unsigned int i = 0; i < outputCells.size(); i++ )
 	{
-		outputs.push_back( numberOfCells - numberOfOutputs + i );
+		outputs.push_back( outputCells[ i ] ->netIndex );
 	}
 
-	// create connections
-	int offset = 0;
-	for ( int i = 0; i < _layerSize.size() - 1;i++ )
+	return compileTopology();
+}
+
+bool NNetPlan::compile( unsigned int numberOfCells, const std::vector <unsigned int> &inputs,
+                        const std::vector <unsigned int> &outputs, const unsigned int *rowStart,
+                        const unsigned int *targets, const double *weights )
+{
+	unsigned int numberOfConnections = rowStart[ numberOfCells ];
+
+	boundWeights = NULL;
+
+	this->inputs = inputs;
+	this->outputs = outputs;
+	this->rowStart.assign( rowStart, rowStart + numberOfCells + 1 );
+	this->targets.assign( targets, targets + numberOfConnections );
+	if ( weights != NULL )
 	{
-		int count = 0;
-		for ( int j = offset; j < offset + _layerSize[i];j++ )
+		this->weights.assign( weights, weights + numberOfConnections );
+	}
+	else
+	{
+		this->weights.clear();
+	}
+
+	return compileTopology();
+}
+
+bool NNetPlan::compileTopology()
+{
+	unsigned int numberOfCells = this->numberOfCells();
+
+	order.clear();
+
+	/*--------------------------------------------
+		Find all cells that can be reached
+		from the input cells
+	----------------------------------------------*/
+
+	std::vector <char> reached( numberOfCells, 0 );
+	std::vector <unsigned int> queue;
+
+	for ( unsigned int i = 0; i < inputs.size(); i++ )
+	{
+		if ( !reached[ inputs[ i ] ] )
 		{
-			int nextOffset = offset + _layerSize[i];
-			for ( int k = nextOffset; k < nextOffset + _layerSize[i+1];k++ )
+			reached[ inputs[ i ] ] = 1;
+			queue.push_back( inputs[ i ] );
+		}
+	}
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ queue[ i ] ]; e < rowStart[ queue[ i ] + 1 ]; e++ )
+		{
+			if ( !reached[ targets[ e ] ] )
 			{
-				//std::cout << "S: " << j << " R: " << k << std::endl;
-				connections.push_back( netConnection( j, k, 0 ) );
+				reached[ targets[ e ] ] = 1;
+				queue.push_back( targets[ e ] );
+			}
+		}
+	}
+
+	/*--------------------------------------------
+		Topological order of the reached cells
+		(Kahn's algorithm)
+	----------------------------------------------*/
+
+	std::vector <unsigned int> inDegree( numberOfCells, 0 );
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ queue[ i ] ]; e < rowStart[ queue[ i ] + 1 ]; e++ )
+		{
+			inDegree[ targets[ e ] ] ++;
+		}
+	}
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		if ( inDegree[ queue[ i ] ] == 0 )
+		{
+			order.push_back( queue[ i ] );
+		}
+	}
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ order[ i ] ]; e < rowStart[ order[ i ] + 1 ]; e++ )
+		{
+			if ( --inDegree[ targets[ e ] ] == 0 )
+			{
+				order.push_back( targets[ e ] );
 			}
-			count++;
 		}
-		offset += count;
 	}
 
+	isFeedForward = ( order.size() == queue.size() );
+
+	isDense = isFeedForward && detectLayers();
 
-	generateNet( inputs, outputs, connections );
+	isRecurrent = !isFeedForward && compileRecurrent( queue );
+
+	return isFeedForward;
 }
 
-void NNet::sendSignals()
+unsigned int NNetPlan::addCell()
 {
+	rowStart.push_back( rowStart.back() );
 
+	// the cell doesn't belong to a layer
+	isDense = false;
 
-	// Reset all cells if memory disabled
-	if ( !enableMemory )
+	return numberOfCells() - 1;
+}
+
+bool NNetPlan::addConnection( unsigned int sender, unsigned int receiver, double weight )
+{
+	unsigned int numberOfCells = this->numberOfCells();
+	unsigned int position = rowStart[ sender + 1 ];
+
+	/*--------------------------------------------
+		Insert the connection at the end of
+		the row of the sender
+	----------------------------------------------*/
+
+	if ( weights.size() == targets.size() )
 	{
+		weights.insert( weights.begin() + position, weight );
+	}
 
-// 		//Save activation values of all input cells
-// 		std::vector <double> tmpActivations;
-//
-// 		for ( unsigned int i = 0; i < this->inputCells.size();i++ )
-// 		{
-// 			tmpActivations.push_back( this->inputCells[ i ] ->finalOutput() );
-// 		}
-//
-// 		// Reset activations of all cells
-// 		for ( unsigned int i = 0; i < this->allCells.size();i++ )
-// 		{
-// 			this->allCells[ i ] ->firstInput( 0 );
-// 		}
-//
-// 		//restore Activation of output cells as they are
-// 		//resetted if memory disabled
-// 		for ( unsigned int i = 0; i < this->inputCells.size();i++ )
-// 		{
-// 			this->inputCells[ i ] ->firstInput( tmpActivations[ i ] ) ;
-// 		}
+	targets.insert( targets.begin() + position, receiver );
 
-		reset();
+	for ( unsigned int i = sender + 1; i <= numberOfCells; i++ )
+	{
+		rowStart[ i ] ++;
 	}
 
+	boundWeights = NULL;
+	isDense = false;
 
-	std::vector <Cell*> tmpCells1;
+	if ( !isFeedForward )
+	{
+		return compileTopology();
+	}
 
+	/*--------------------------------------------
+		Position of each cell in order
+	----------------------------------------------*/
 
-	tmpCells1 = inputCells;
+	const unsigned int notReached = UINT_MAX;
 
-// 		for ( unsigned int i = 0; i < inputCells.size();i++ )
-// 		{
-// 			std::cout << "Input (" << i << "):\t" << inputCells[ i ] ->signalSum << std::endl;
-// 		}
-// 		std::cout << "---------------------------" << std::endl;
-// 		for ( unsigned int i = 0; i < outputCells.size();i++ )
-// 		{
-// 			std::cout << "Output (" << i << "):\t" << outputCells[ i ] ->signalSum << std::endl;
-// 		}
-// 		std::cout << "---------------------------" << std::endl;
+	std::vector <unsigned int> rank( numberOfCells, notReached );
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		rank[ order[ i ] ] = i;
+	}
 
+	// the sender isn't evaluated, nothing changes
+	if ( rank[ sender ] == notReached ) return true;
 
-	tmpCells1 = inputCells;
+	std::vector <char> marked( numberOfCells, 0 );
+	std::vector <unsigned int> queue;
 
-	while ( tmpCells1.size() > 0 )
+	if ( rank[ receiver ] != notReached )
 	{
-		std::vector <Cell*> tmpCells2;
+		if ( rank[ sender ] < rank[ receiver ] ) return true;
 
-		for ( unsigned int i = 0; i < tmpCells1.size(); i++ )
+		/*--------------------------------------------
+			The receiver is in front of the sender:
+			the cells between them that depend on
+			the receiver are moved behind the
+			sender (keeping their relative order)
+		----------------------------------------------*/
+
+		marked[ receiver ] = 1;
+		queue.push_back( receiver );
+
+		for ( unsigned int i = 0; i < queue.size(); i++ )
 		{
-			for ( unsigned int j = 0; j < tmpCells1[ i ] ->connections.size();j++ )
+			for ( unsigned int e = rowStart[ queue[ i ] ]; e < rowStart[ queue[ i ] + 1 ]; e++ )
 			{
-				Cell * connectedCell = tmpCells1[ i ] ->connections[ j ];
+				unsigned int cell = targets[ e ];
 
-				// 				bool alreadyConnected = false;
-				// 				for (int k = 0;k < tmpCells2.size();k++)
-				// 				{
-				// 					if (tmpCells2[k]->netIndex == connectedCell->netIndex ) alreadyConnected = true;
-				// 				}
-				if ( !connectedCell->alreadyConnected )
+				// the connection closes a cycle
+				if ( cell == sender ) return compileTopology();
+
+				if ( !marked[ cell ] && rank[ cell ] < rank[ sender ] )
 				{
-					tmpCells2.push_back( connectedCell );
-					connectedCell->alreadyConnected = true;
+					marked[ cell ] = 1;
+					queue.push_back( cell );
 				}
 			}
-			tmpCells1[ i ] ->sendSignals();
 		}
-		for ( unsigned int k = 0;k < tmpCells2.size();k++ )
+
+		std::vector <unsigned int> moved;
+		unsigned int next = rank[ receiver ];
+
+		for ( unsigned int i = rank[ receiver ]; i <= rank[ sender ]; i++ )
 		{
-			tmpCells2[ k ] ->alreadyConnected = false;
+			if ( marked[ order[ i ] ] )
+			{
+				moved.push_back( order[ i ] );
+			}
+			else
+			{
+				order[ next++ ] = order[ i ];
+			}
 		}
-		tmpCells1 = tmpCells2;
 
+		std::copy( moved.begin(), moved.end(), order.begin() + next );
+
+		return true;
 	}
 
-// 				for ( unsigned int i = 0; i < inputCells.size();i++ )
-// 				{
-// 					std::cout << "Input (" << i << "):\t" << inputCells[ i ] ->signalSum << std::endl;
+	/*--------------------------------------------
+		The receiver (and the cells that are
+		only reached through it) are reached
+		now
+	----------------------------------------------*/
+
+	marked[ receiver ] = 1;
+	queue.push_back( receiver );
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ queue[ i ] ]; e < rowStart[ queue[ i ] + 1 ]; e++ )
+		{
+			unsigned int cell = targets[ e ];
+
+			if ( rank[ cell ] != notReached )
+			{
+				// they can't be inserted behind the sender
+				if ( rank[ cell ] <= rank[ sender ] ) return compileTopology();
+			}
+			else if ( !marked[ cell ] )
+			{
+				marked[ cell ] = 1;
+				queue.push_back( cell );
+			}
+		}
+	}
+
+	// topological order of the new cells (Kahn's algorithm)
+	std::vector <unsigned int> inDegree( numberOfCells, 0 );
+	std::vector <unsigned int> newCells;
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ queue[ i ] ]; e < rowStart[ queue[ i ] + 1 ]; e++ )
+		{
+			if ( marked[ targets[ e ] ] ) inDegree[ targets[ e ] ] ++;
+		}
+	}
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		if ( inDegree[ queue[ i ] ] == 0 ) newCells.push_back( queue[ i ] );
+	}
+
+	for ( unsigned int i = 0; i < newCells.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ newCells[ i ] ]; e < rowStart[ newCells[ i ] + 1 ]; e++ )
+		{
+			if ( marked[ targets[ e ] ] && --inDegree[ targets[ e ] ] == 0 )
+			{
+				newCells.push_back( targets[ e ] );
+			}
+		}
+	}
+
+	if ( newCells.size() != queue.size() ) return compileTopology();
+
+	order.insert( order.begin() + rank[ sender ] + 1, newCells.begin(), newCells.end() );
+
+	return true;
+}
+
+bool NNetPlan::compileRecurrent( const std::vector <unsigned int> &reachedCells )
+{
+	unsigned int numberOfCells = this->numberOfCells();
+
+	/*--------------------------------------------
+		Find back edges by depth first search
+		from the input cells. Without them the
+		net is a feed forward net.
+	----------------------------------------------*/
+
+	std::vector <char> state( numberOfCells, 0 );
+	std::vector <char> backEdge( targets.size(), 0 );
+	std::vector < std::pair <unsigned int, unsigned int> > stack;
+
+	for ( unsigned int i = 0; i < inputs.size(); i++ )
+	{
+		if ( state[ inputs[ i ] ] != 0 ) continue;
+
+		state[ inputs[ i ] ] = 1;
+		stack.push_back( std::make_pair( inputs[ i ], rowStart[ inputs[ i ] ] ) );
+
+		while ( !stack.empty() )
+		{
+			unsigned int cell = stack.back().first;
+			unsigned int e = stack.back().second;
+
+			if ( e == rowStart[ cell + 1 ] )
+			{
+				state[ cell ] = 2;
+				stack.pop_back();
+				continue;
+			}
+
+			stack.back().second++;
+
+			if ( state[ targets[ e ] ] == 1 )
+			{
+				backEdge[ e ] = 1;
+			}
+			else if ( state[ targets[ e ] ] == 0 )
+			{
+				state[ targets[ e ] ] = 1;
+				stack.push_back( std::make_pair( targets[ e ], rowStart[ targets[ e ] ] ) );
+			}
+		}
+	}
+
+	/*--------------------------------------------
+		Topological order without back edges
+	----------------------------------------------*/
+
+	std::vector <unsigned int> inDegree( numberOfCells, 0 );
+
+	for ( unsigned int i = 0; i < reachedCells.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ reachedCells[ i ] ]; e < rowStart[ reachedCells[ i ] + 1 ]; e++ )
+		{
+			if ( !backEdge[ e ] ) inDegree[ targets[ e ] ] ++;
+		}
+	}
+
+	order.clear();
+
+	for ( unsigned int i = 0; i < reachedCells.size(); i++ )
+	{
+		if ( inDegree[ reachedCells[ i ] ] == 0 )
+		{
+			order.push_back( reachedCells[ i ] );
+		}
+	}
+
+	sweepStart.assign( 1, 0 );
+	sweepEdges.clear();
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		for ( unsigned int e = rowStart[ order[ i ] ]; e < rowStart[ order[ i ] + 1 ]; e++ )
+		{
+			if ( backEdge[ e ] ) continue;
+
+			sweepEdges.push_back( e );
+
+			if ( --inDegree[ targets[ e ] ] == 0 )
+			{
+				order.push_back( targets[ e ] );
+			}
+		}
+
+		sweepStart.push_back( sweepEdges.size() );
+	}
+
+	/*--------------------------------------------
+		Back edges, sorted by sender
+	----------------------------------------------*/
+
+	recurrentEdges.clear();
+	recurrentSenders.clear();
+	recurrentStart.assign( 1, 0 );
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		bool sender = false;
+
+		for ( unsigned int e = rowStart[ order[ i ] ]; e < rowStart[ order[ i ] + 1 ]; e++ )
+		{
+			if ( !backEdge[ e ] ) continue;
+
+			recurrentEdges.push_back( e );
+			sender = true;
+		}
+
+		if ( sender )
+		{
+			recurrentSenders.push_back( order[ i ] );
+			recurrentStart.push_back( recurrentEdges.size() );
+		}
+	}
+
+	return order.size() == reachedCells.size();
+}
+
+const bool NNetPlan::recurrent() const
+{
+	return isRecurrent;
+}
+
+void NNetPlan::step( const double *previous, double *current, double *workspace, const double *weights ) const
+{
+	const unsigned int *t = &targets[ 0 ];
+	const double *w = weights != NULL ? weights : weightData();
+
+	/*--------------------------------------------
+		Signals of the previous time step
+		(back edges)
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0; i < recurrentSenders.size(); i++ )
+	{
+		workspace[ recurrentSenders[ i ] ] = activation( previous[ recurrentSenders[ i ] ] );
+	}
+
+	for ( unsigned int i = 0; i < recurrentSenders.size(); i++ )
+	{
+		double value = workspace[ recurrentSenders[ i ] ];
+
+		for ( unsigned int k = recurrentStart[ i ]; k < recurrentStart[ i + 1 ]; k++ )
+		{
+			current[ t[ recurrentEdges[ k ] ] ] += value * w[ recurrentEdges[ k ] ];
+		}
+	}
+
+	/*--------------------------------------------
+		Signals of the current time step
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		unsigned int begin = sweepStart[ i ];
+		unsigned int end = sweepStart[ i + 1 ];
+
+		if ( begin == end ) continue;
+
+		double value = activation( current[ order[ i ] ] );
+
+		for ( unsigned int k = begin; k < end; k++ )
+		{
+			current[ t[ sweepEdges[ k ] ] ] += value * w[ sweepEdges[ k ] ];
+		}
+	}
+}
+
+bool NNetPlan::detectLayers()
+{
+	/*--------------------------------------------
+		The input cells have to be the first
+		cells. Each layer is a contiguous range
+		of cells that is fully connected to the
+		next range. The last layer are the
+		output cells.
+	----------------------------------------------*/
+
+	unsigned int numberOfCells = this->numberOfCells();
+
+	layerStart.clear();
+
+	if ( inputs.empty() ) return false;
+
+	for ( unsigned int i = 0; i < inputs.size(); i++ )
+	{
+		if ( inputs[ i ] != i ) return false;
+	}
+
+	layerStart.push_back( 0 );
+	layerStart.push_back( inputs.size() );
+
+	while ( layerStart.back() < numberOfCells )
+	{
+		unsigned int begin = layerStart[ layerStart.size() - 2 ];
+		unsigned int end = layerStart.back();
+
+		unsigned int size = rowStart[ begin + 1 ] - rowStart[ begin ];
+
+		if ( size == 0 || end + size > numberOfCells ) break;
+
+		for ( unsigned int j = begin; j < end; j++ )
+		{
+			if ( rowStart[ j + 1 ] - rowStart[ j ] != size ) return false;
+
+			for ( unsigned int k = 0; k < size; k++ )
+			{
+				if ( targets[ rowStart[ j ] + k ] != end + k ) return false;
+			}
+		}
+
+		layerStart.push_back( end + size );
+	}
+
+	/*--------------------------------------------
+		All cells and connections have to be
+		covered and the last layer has to be
+		the output layer
+	----------------------------------------------*/
+
+	unsigned int last = layerStart[ layerStart.size() - 2 ];
+
+	if ( layerStart.size() < 3 || layerStart.back() != numberOfCells ) return false;
+
+	if ( rowStart[ last ] != targets.size() ) return false;
+
+	if ( outputs.size() != numberOfCells - last ) return false;
+
+	for ( unsigned int i = 0; i < outputs.size(); i++ )
+	{
+		if ( outputs[ i ] != last + i ) return false;
+	}
+
+	return true;
+}
+
+const bool NNetPlan::dense() const
+{
+	return isDense;
+}
+
+void NNetPlan::bindWeights( const double *weights )
+{
+	boundWeights = weights;
+}
+
+const double *NNetPlan::weightData() const
+{
+	if ( boundWeights != NULL ) return boundWeights;
+
+	return weights.empty() ? NULL : &weights[ 0 ];
+}
+
+const bool NNetPlan::feedForward() const
+{
+	return isFeedForward;
+}
+
+const unsigned int NNetPlan::numberOfCells() const
+{
+	return rowStart.size() - 1;
+}
+
+const unsigned int NNetPlan::numberOfConnections() const
+{
+	return targets.size();
+}
+
+void NNetPlan::forward( double *activations, double *workspace, const double *weights ) const
+{
+	if ( isDense )
+	{
+		forwardDense( activations, workspace, weights );
+		return;
+	}
+
+	const unsigned int *t = targets.empty() ? NULL : &targets[ 0 ];
+	const double *w = weights != NULL ? weights : weightData();
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		unsigned int cell = order[ i ];
+		unsigned int begin = rowStart[ cell ];
+		unsigned int end = rowStart[ cell + 1 ];
+
+		if ( begin == end ) continue;
+
+		double value = activation( activations[ cell ] );
+
+		for ( unsigned int e = begin; e < end; e++ )
+		{
+			activations[ t[ e ] ] += value * w[ e ];
+		}
+	}
+}
+
+void NNetPlan::forwardBatch( double *activations, unsigned int count, double *workspace,
+                             const double *weights ) const
+{
+	if ( isDense )
+	{
+		forwardBatchDense( activations, count, workspace, weights );
+		return;
+	}
+
+	const unsigned int *t = targets.empty() ? NULL : &targets[ 0 ];
+	const double *w = weights != NULL ? weights : weightData();
+	double *s = workspace;
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		unsigned int cell = order[ i ];
+		unsigned int begin = rowStart[ cell ];
+		unsigned int end = rowStart[ cell + 1 ];
+
+		if ( begin == end ) continue;
+
+		const double *x = activations + cell * count;
+
+		activation.apply( x, s, count );
+
+		for ( unsigned int e = begin; e < end; e++ )
+		{
+			double *y = activations + t[ e ] * count;
+			const double weight = w[ e ];
+
+			#pragma omp simd
+			for ( unsigned int k = 0; k < count; k++ )
+			{
+				y[ k ] += weight * s[ k ];
+			}
+		}
+	}
+}
+
+void NNetPlan::forwardDelta( const double *baseActivations, const double *baseWeights, double *activations,
+                             unsigned int count, double *workspace, const double *weights ) const
+{
+	const unsigned int *t = targets.empty() ? NULL : &targets[ 0 ];
+	const double *w = weights != NULL ? weights : weightData();
+	double *oldSignals = workspace;
+	double *newSignals = workspace + count;
+
+	std::copy( baseActivations, baseActivations + numberOfCells() * count, activations );
+
+	/*--------------------------------------------
+		Cells behind the changed weights
+	----------------------------------------------*/
+
+	std::vector <char> changed( numberOfCells(), 0 );
+	std::vector <char> affected( numberOfCells(), 0 );
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		unsigned int cell = order[ i ];
+
+		for ( unsigned int e = rowStart[ cell ]; e < rowStart[ cell + 1 ]; e++ )
+		{
+			if ( w[ e ] != baseWeights[ e ] )
+			{
+				changed[ cell ] = 1;
+				affected[ t[ e ] ] = 1;
+			}
+			else if ( affected[ cell ] )
+			{
+				affected[ t[ e ] ] = 1;
+			}
+		}
+	}
+
+	/*--------------------------------------------
+		Add the differences of the signals, the
+		senders of a cell are complete before
+		(topological order)
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		unsigned int cell = order[ i ];
+
+		if ( !changed[ cell ] && !affected[ cell ] ) continue;
+
+		unsigned int begin = rowStart[ cell ];
+		unsigned int end = rowStart[ cell + 1 ];
+
+		activation.apply( baseActivations + cell * count, oldSignals, count );
+
+		if ( !affected[ cell ] )
+		{
+			for ( unsigned int e = begin; e < end; e++ )
+			{
+				if ( w[ e ] == baseWeights[ e ] ) continue;
+
+				double *y = activations + t[ e ] * count;
+				const double difference = w[ e ] - baseWeights[ e ];
+
+				#pragma omp simd
+				for ( unsigned int k = 0; k < count; k++ )
+				{
+					y[ k ] += difference * oldSignals[ k ];
+				}
+			}
+
+			continue;
+		}
+
+		activation.apply( activations + cell * count, newSignals, count );
+
+		for ( unsigned int e = begin; e < end; e++ )
+		{
+			double *y = activations + t[ e ] * count;
+			const double weight = w[ e ];
+			const double baseWeight = baseWeights[ e ];
+
+			#pragma omp simd
+			for ( unsigned int k = 0; k < count; k++ )
+			{
+				y[ k ] += weight * newSignals[ k ] - baseWeight * oldSignals[ k ];
+			}
+		}
+	}
+}
+
+void NNetPlan::forwardPopulation( double *activations, const double *weights, unsigned int count,
+                                  unsigned int numberOfSamples, double *workspace ) const
+{
+	const unsigned int *t = targets.empty() ? NULL : &targets[ 0 ];
+	const unsigned int stride = numberOfSamples * count;
+	double *s = workspace;
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		unsigned int cell = order[ i ];
+		unsigned int begin = rowStart[ cell ];
+		unsigned int end = rowStart[ cell + 1 ];
+
+		if ( begin == end ) continue;
+
+		const double *x = activations + cell * stride;
+
+		activation.apply( x, s, stride );
+
+		for ( unsigned int e = begin; e < end; e++ )
+		{
+			double *y = activations + t[ e ] * stride;
+			const double *w = weights + e * count;
+
+			for ( unsigned int n = 0; n < numberOfSamples; n++ )
+			{
+				double *yn = y + n * count;
+				const double *sn = s + n * count;
+
+				#pragma omp simd
+				for ( unsigned int k = 0; k < count; k++ )
+				{
+					yn[ k ] += w[ k ] * sn[ k ];
+				}
+			}
+		}
+	}
+}
+
+void NNetPlan::backward( const double *activations, double *deltas, double *gradient,
+                         const double *weights ) const
+{
+	/*--------------------------------------------
+		Cells in reverse topological order,
+		i.e. the deltas of all receivers are
+		complete when a cell is visited:
+
+		delta( cell ) += f'( a ) * sum w * delta( receiver )
+		gradient( w ) += f( a ) * delta( receiver )
+	----------------------------------------------*/
+
+	const unsigned int *t = targets.empty() ? NULL : &targets[ 0 ];
+	const double *w = weights != NULL ? weights : weightData();
+
+	for ( unsigned int i = order.size(); i-- > 0; )
+	{
+		unsigned int cell = order[ i ];
+		unsigned int begin = rowStart[ cell ];
+		unsigned int end = rowStart[ cell + 1 ];
+
+		if ( begin == end ) continue;
+
+		const double value = activation( activations[ cell ] );
+		double sum = 0;
+
+		#pragma omp simd reduction(+:sum)
+		for ( unsigned int e = begin; e < end; e++ )
+		{
+			const double delta = deltas[ t[ e ] ];
+
+			sum += w[ e ] * delta;
+			gradient[ e ] += value * delta;
+		}
+
+		deltas[ cell ] += activation.derivative( activations[ cell ] ) * sum;
+	}
+}
+
+void NNetPlan::forwardBatchDense( double *activations, unsigned int count, double *workspace,
+                                  const double *weights ) const
+{
+	/*--------------------------------------------
+		Y += W^T S for each layer, S holds the
+		sigmoids of the sender layer (one row
+		per cell, one column per sample).
+		Blocks of 4 receivers x 4 samples are
+		accumulated in registers over all
+		senders. The senders are added in the
+		same order as in the generic pass.
+	----------------------------------------------*/
+
+	const unsigned int rows = 4;
+	const unsigned int columns = 4;
+
+	for ( unsigned int l = 0; l + 2 < layerStart.size(); l++ )
+	{
+		const unsigned int n = layerStart[ l + 1 ] - layerStart[ l ];
+		const unsigned int m = layerStart[ l + 2 ] - layerStart[ l + 1 ];
+
+		const double *x = activations + layerStart[ l ] * count;
+		double *y = activations + layerStart[ l + 1 ] * count;
+		double *s = workspace;
+		const double *w = ( weights != NULL ? weights : weightData() ) + rowStart[ layerStart[ l ] ];
+
+		activation.apply( x, s, n * count );
+
+		for ( unsigned int k = 0; k < m; k += rows )
+		{
+			const unsigned int kc = std::min( rows, m - k );
+
+			for ( unsigned int i = 0; i < count; i += columns )
+			{
+				const unsigned int ic = std::min( columns, count - i );
+
+				if ( kc == rows && ic == columns )
+				{
+					double *y0 = y + k * count + i;
+					double *y1 = y0 + count;
+					double *y2 = y1 + count;
+					double *y3 = y2 + count;
+
+					double a00 = y0[ 0 ], a01 = y0[ 1 ], a02 = y0[ 2 ], a03 = y0[ 3 ];
+					double a10 = y1[ 0 ], a11 = y1[ 1 ], a12 = y1[ 2 ], a13 = y1[ 3 ];
+					double a20 = y2[ 0 ], a21 = y2[ 1 ], a22 = y2[ 2 ], a23 = y2[ 3 ];
+					double a30 = y3[ 0 ], a31 = y3[ 1 ], a32 = y3[ 2 ], a33 = y3[ 3 ];
+
+					for ( unsigned int j = 0; j < n; j++ )
+					{
+						const double *wj = w + j * m + k;
+						const double *sj = s + j * count + i;
+
+						const double s0 = sj[ 0 ], s1 = sj[ 1 ], s2 = sj[ 2 ], s3 = sj[ 3 ];
+						const double w0 = wj[ 0 ], w1 = wj[ 1 ], w2 = wj[ 2 ], w3 = wj[ 3 ];
+
+						a00 += w0 * s0; a01 += w0 * s1; a02 += w0 * s2; a03 += w0 * s3;
+						a10 += w1 * s0; a11 += w1 * s1; a12 += w1 * s2; a13 += w1 * s3;
+						a20 += w2 * s0; a21 += w2 * s1; a22 += w2 * s2; a23 += w2 * s3;
+						a30 += w3 * s0; a31 += w3 * s1; a32 += w3 * s2; a33 += w3 * s3;
+					}
+
+					y0[ 0 ] = a00; y0[ 1 ] = a01; y0[ 2 ] = a02; y0[ 3 ] = a03;
+					y1[ 0 ] = a10; y1[ 1 ] = a11; y1[ 2 ] = a12; y1[ 3 ] = a13;
+					y2[ 0 ] = a20; y2[ 1 ] = a21; y2[ 2 ] = a22; y2[ 3 ] = a23;
+					y3[ 0 ] = a30; y3[ 1 ] = a31; y3[ 2 ] = a32; y3[ 3 ] = a33;
+				}
+				else
+				{
+					for ( unsigned int r = 0; r < kc; r++ )
+					{
+						for ( unsigned int q = 0; q < ic; q++ )
+						{
+							double acc = y[ ( k + r ) * count + i + q ];
+
+							for ( unsigned int j = 0; j < n; j++ )
+							{
+								acc += w[ j * m + k + r ] * s[ j * count + i + q ];
+							}
+
+							y[ ( k + r ) * count + i + q ] = acc;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void NNetPlan::forwardDense( double *activations, double *workspace, const double *weights ) const
+{
+	/*--------------------------------------------
+		y += W^T sigmoid( x ) for each layer,
+		W is stored row-major (one row per
+		sender). The receivers are processed
+		in blocks that fit into the L1 cache,
+		four rows are added per pass. The
+		rows are added in the same order as
+		in the generic pass, i.e. the results
+		are identical.
+	----------------------------------------------*/
+
+	const unsigned int blockSize = 512;
+
+	if ( weights == NULL ) weights = weightData();
+
+	for ( unsigned int l = 0; l + 2 < layerStart.size(); l++ )
+	{
+		const unsigned int n = layerStart[ l + 1 ] - layerStart[ l ];
+		const unsigned int m = layerStart[ l + 2 ] - layerStart[ l + 1 ];
+
+		const double *x = activations + layerStart[ l ];
+		double *y = activations + layerStart[ l + 1 ];
+		double *s = workspace;
+		const double *w = weights + rowStart[ layerStart[ l ] ];
+
+		activation.apply( x, s, n );
+
+		for ( unsigned int kBegin = 0; kBegin < m; kBegin += blockSize )
+		{
+			const unsigned int kEnd = std::min( kBegin + blockSize, m );
+
+			unsigned int j = 0;
+
+			for ( ; j + 4 <= n; j += 4 )
+			{
+				const double s0 = s[ j ], s1 = s[ j + 1 ], s2 = s[ j + 2 ], s3 = s[ j + 3 ];
+				const double *w0 = w + j * m;
+				const double *w1 = w0 + m;
+				const double *w2 = w1 + m;
+				const double *w3 = w2 + m;
+
+				#pragma omp simd
+				for ( unsigned int k = kBegin; k < kEnd; k++ )
+				{
+					y[ k ] = ( ( ( y[ k ] + s0 * w0[ k ] ) + s1 * w1[ k ] ) + s2 * w2[ k ] ) + s3 * w3[ k ];
+				}
+			}
+
+			for ( ; j < n; j++ )
+			{
+				const double s0 = s[ j ];
+				const double *w0 = w + j * m;
+
+				#pragma omp simd
+				for ( unsigned int k = kBegin; k < kEnd; k++ )
+				{
+					y[ k ] += s0 * w0[ k ];
+				}
+			}
+		}
+	}
+}
+
+
+
+NNet::NNet()
+{
+	setMemory( false );
+}
+
+NNet::NNet( std::string fileName )
+{
+	setMemory( false );
+
+	this->loadNet( fileName );
+}
+
+NNet::NNet( const NNet &net )
+{
+	setMemory( false );
+
+	*this = net;
+}
+
+NNet & NNet::operator=( const NNet & net )
+{
+	if ( this == &net ) return *this;
+
+	clear();
+
+	inputList = net.inputList;
+	outputList = net.outputList;
+	connectionList = net.connectionList;
+	enableMemory = net.enableMemory;
+
+	/*--------------------------------------------
+		Copy cells, connections are mapped
+		by the index of the cell in allCells
+	----------------------------------------------*/
+
+	std::map <const Cell*, int> index;
+
+	for ( unsigned int i = 0; i < net.allCells.size(); i++ )
+	{
+		index[ net.allCells[ i ] ] = i;
+	}
+
+	generateCells( net.allCells.size() );
+
+	for ( unsigned int i = 0; i < net.allCells.size(); i++ )
+	{
+		const Cell *cell = net.allCells[ i ];
+
+		allCells[ i ] ->signalSum = cell->signalSum;
+
+		for ( unsigned int j = 0; j < cell->connections.size(); j++ )
+		{
+			allCells[ i ] ->connect( allCells[ index[ cell->connections[ j ] ] ], cell->weights[ j ] );
+		}
+	}
+
+	for ( unsigned int i = 0; i < net.inputCells.size(); i++ )
+	{
+		inputCells.push_back( allCells[ index[ net.inputCells[ i ] ] ] );
+	}
+
+	for ( unsigned int i = 0; i < net.outputCells.size(); i++ )
+	{
+		outputCells.push_back( allCells[ index[ net.outputCells[ i ] ] ] );
+	}
+
+	compile();
+
+	plan.activation = net.plan.activation;
+
+	// copy bound weights
+	const double *weights = net.plan.weightData();
+
+	if ( weights != NULL && plan.numberOfConnections() == net.plan.numberOfConnections() )
+	{
+		setWeights( std::vector<double>( weights, weights + plan.numberOfConnections() ) );
+	}
+
+	return *this;
+}
+
+NNet::NNet( int numberOfInputs, int numberOfOutputs, std::vector<int> layerSize )
+{
+	setMemory( false );
+
+	createNet( numberOfInputs, numberOfOutputs, layerSize );
+}
+
+bool NNet::createNet( int numberOfInputs, int numberOfOutputs, std::vector<int> layerSize )
+{
+	int numberOfCells = 0;
+
+	std::vector<int> _layerSize;
+
+	std::vector<int> inputs;
+	std::vector<int> outputs;
+
+	_layerSize.push_back( numberOfInputs );
+
+	// adding hidden layers
+	for ( int i = 0; i < layerSize.size();i++ )
+	{
+		_layerSize.push_back( layerSize[i] );
+	}
+
+	_layerSize.push_back( numberOfOutputs );
+
+	std::vector<netConnection> connections;
+
+	// find out numberOfCells
+	for ( int i = 0; i < _layerSize.size(); i++ )
+	{
+		numberOfCells += _layerSize[i];
+	}
+
+	// create input indices
+	for ( int  i = 0; i < numberOfInputs; i++ )
+	{
+		inputs.push_back( i );
+	}
+
+	// create output indices
+	for ( int  i = 0; i < numberOfOutputs; i++ )
+	{
+		outputs.push_back( numberOfCells - numberOfOutputs + i );
+	}
+
+	// create connections
+	int offset = 0;
+	for ( int i = 0; i < _layerSize.size() - 1;i++ )
+	{
+		int count = 0;
+		for ( int j = offset; j < offset + _layerSize[i];j++ )
+		{
+			int nextOffset = offset + _layerSize[i];
+			for ( int k = nextOffset; k < nextOffset + _layerSize[i+1];k++ )
+			{
+				//std::cout << "S: " << j << " R: " << k << std::endl;
+				connections.push_back( netConnection( j, k, 0 ) );
+			}
+			count++;
+		}
+		offset += count;
+	}
+
+
+	return generateNet( inputs, outputs, connections );
+}
+
+void NNet::sendSignals()
+{
+	if ( plan.recurrent() )
+	{
+		sendSignalsRecurrent();
+		return;
+	}
+
+	if ( !plan.feedForward() )
+	{
+		sendSignalsWavefront();
+		return;
+	}
+
+	if ( activations.empty() ) return;
+
+	/*--------------------------------------------
+		Gather activations. The input cells
+		keep their values, all other cells are
+		resetted if memory is disabled
+	----------------------------------------------*/
+
+	double *a = &activations[ 0 ];
+
+	if ( enableMemory )
+	{
+		for ( unsigned int i = 0; i < allCells.size(); i++ )
+		{
+			a[ i ] = allCells[ i ] ->signalSum;
+		}
+	}
+	else
+	{
+		std::fill( activations.begin(), activations.end(), 0.0 );
+
+		for ( unsigned int i = 0; i < plan.inputs.size(); i++ )
+		{
+			a[ plan.inputs[ i ] ] = allCells[ plan.inputs[ i ] ] ->signalSum;
+		}
+	}
+
+	plan.forward( a, &workspace[ 0 ] );
+
+	/*--------------------------------------------
+		Scatter activations, i.e. keep
+		Cell::signalSum valid
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0; i < allCells.size(); i++ )
+	{
+		allCells[ i ] ->signalSum = a[ i ];
+	}
+}
+
+bool NNet::sendSignals( const double *inputs, double *outputs, unsigned int numberOfSamples )
+{
+	if ( !plan.feedForward() )
+	{
+		std::cerr << "Error: Batched send process requires a feed forward net!" << std::endl;
+		return false;
+	}
+
+	unsigned int numberOfCells = allCells.size();
+	unsigned int numberOfInputs = plan.inputs.size();
+	unsigned int numberOfOutputs = plan.outputs.size();
+
+	/*--------------------------------------------
+		Samples are processed in blocks, the
+		activations of one block should fit
+		into the L2 cache
+	----------------------------------------------*/
+
+	unsigned int blockSize = 32768 / ( numberOfCells + 1 );
+
+	blockSize = std::max( 8u, std::min( 256u, blockSize ) ) & ~7u;
+	blockSize = std::min( blockSize, numberOfSamples );
+
+	if ( batchActivations.size() < numberOfCells * blockSize )
+	{
+		batchActivations.resize( numberOfCells * blockSize );
+		batchWorkspace.resize( numberOfCells * blockSize );
+	}
+
+	for ( unsigned int first = 0; first < numberOfSamples; first += blockSize )
+	{
+		unsigned int count = std::min( blockSize, numberOfSamples - first );
+
+		double *a = &batchActivations[ 0 ];
+
+		std::fill( a, a + numberOfCells * count, 0.0 );
+
+		for ( unsigned int i = 0; i < count; i++ )
+		{
+			const double *row = inputs + ( first + i ) * numberOfInputs;
+
+			for ( unsigned int j = 0; j < numberOfInputs; j++ )
+			{
+				a[ plan.inputs[ j ] * count + i ] = row[ j ];
+			}
+		}
+
+		plan.forwardBatch( a, count, &batchWorkspace[ 0 ] );
+
+		for ( unsigned int i = 0; i < count; i++ )
+		{
+			double *row = outputs + ( first + i ) * numberOfOutputs;
+
+			for ( unsigned int j = 0; j < numberOfOutputs; j++ )
+			{
+				row[ j ] = a[ plan.outputs[ j ] * count + i ];
+			}
+		}
+	}
+
+	return true;
+}
+
+bool NNet::recordSignals( const double *inputs, unsigned int numberOfSamples, double *activations )
+{
+	if ( !plan.feedForward() )
+	{
+		std::cerr << "Error: Batched send process requires a feed forward net!" << std::endl;
+		return false;
+	}
+
+	unsigned int numberOfCells = allCells.size();
+	unsigned int numberOfInputs = plan.inputs.size();
+
+	if ( batchWorkspace.size() < numberOfCells * numberOfSamples )
+	{
+		batchWorkspace.resize( numberOfCells * numberOfSamples );
+	}
+
+	std::fill( activations, activations + numberOfCells * numberOfSamples, 0.0 );
+
+	for ( unsigned int i = 0; i < numberOfSamples; i++ )
+	{
+		const double *row = inputs + i * numberOfInputs;
+
+		for ( unsigned int j = 0; j < numberOfInputs; j++ )
+		{
+			activations[ plan.inputs[ j ] * numberOfSamples + i ] = row[ j ];
+		}
+	}
+
+	plan.forwardBatch( activations, numberOfSamples, &batchWorkspace[ 0 ] );
+
+	return true;
+}
+
+bool NNet::updateSignals( const double *baseActivations, const double *baseWeights,
+                          unsigned int numberOfSamples, double *activations )
+{
+	if ( !plan.feedForward() )
+	{
+		std::cerr << "Error: Batched send process requires a feed forward net!" << std::endl;
+		return false;
+	}
+
+	if ( batchWorkspace.size() < 2 * numberOfSamples )
+	{
+		batchWorkspace.resize( 2 * numberOfSamples );
+	}
+
+	plan.forwardDelta( baseActivations, baseWeights, activations, numberOfSamples, &batchWorkspace[ 0 ] );
+
+	return true;
+}
+
+bool NNet::sendSignals( const std::vector<double> &inputs, std::vector<double> &outputs )
+{
+	if ( inputCells.empty() || inputs.size() % inputCells.size() != 0 )
+	{
+		std::cerr << "Error: Size of input matrix doesn't match number of input cells!" << std::endl;
+		return false;
+	}
+
+	unsigned int numberOfSamples = inputs.size() / inputCells.size();
+
+	outputs.resize( numberOfSamples * outputCells.size() );
+
+	if ( numberOfSamples == 0 ) return true;
+
+	return sendSignals( &inputs[ 0 ], outputs.empty() ? NULL : &outputs[ 0 ], numberOfSamples );
+}
+
+bool NNet::sendSignals( const double *inputs, unsigned int numberOfSamples, const double *weights,
+                        unsigned int numberOfNets, double *outputs )
+{
+	if ( !plan.feedForward() )
+	{
+		std::cerr << "Error: Batched send process requires a feed forward net!" << std::endl;
+		return false;
+	}
+
+	if ( numberOfSamples == 0 || numberOfNets == 0 ) return true;
+
+	unsigned int numberOfCells = allCells.size();
+	unsigned int numberOfInputs = plan.inputs.size();
+	unsigned int numberOfOutputs = plan.outputs.size();
+
+	/*--------------------------------------------
+		Samples are processed in blocks, the
+		activations of one block should fit
+		into the L2 cache
+	----------------------------------------------*/
+
+	unsigned int blockSize = 262144 / ( ( numberOfCells + 1 ) * numberOfNets );
+
+	blockSize = std::max( 1u, std::min( blockSize, numberOfSamples ) );
+
+	if ( batchActivations.size() < numberOfCells * blockSize * numberOfNets )
+	{
+		batchActivations.resize( numberOfCells * blockSize * numberOfNets );
+		batchWorkspace.resize( blockSize * numberOfNets );
+	}
+
+	for ( unsigned int first = 0; first < numberOfSamples; first += blockSize )
+	{
+		unsigned int count = std::min( blockSize, numberOfSamples - first );
+		unsigned int stride = count * numberOfNets;
+
+		double *a = &batchActivations[ 0 ];
+
+		std::fill( a, a + numberOfCells * stride, 0.0 );
+
+		for ( unsigned int i = 0; i < count; i++ )
+		{
+			for ( unsigned int j = 0; j < numberOfInputs; j++ )
+			{
+				double *row = a + plan.inputs[ j ] * stride + i * numberOfNets;
+
+				std::fill( row, row + numberOfNets, inputs[ ( first + i ) * numberOfInputs + j ] );
+			}
+		}
+
+		plan.forwardPopulation( a, weights, numberOfNets, count, &batchWorkspace[ 0 ] );
+
+		for ( unsigned int i = 0; i < count; i++ )
+		{
+			for ( unsigned int p = 0; p < numberOfNets; p++ )
+			{
+				double *row = outputs + ( ( first + i ) * numberOfNets + p ) * numberOfOutputs;
+
+				for ( unsigned int j = 0; j < numberOfOutputs; j++ )
+				{
+					row[ j ] = a[ plan.outputs[ j ] * stride + i * numberOfNets + p ];
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+void NNet::sendSignalsRecurrent()
+{
+	/*--------------------------------------------
+		The activations of the cells are the
+		state of the previous time step
+	----------------------------------------------*/
+
+	double *a = &activations[ 0 ];
+	double *previous = &previousActivations[ 0 ];
+
+	for ( unsigned int i = 0; i < allCells.size(); i++ )
+	{
+		previous[ i ] = allCells[ i ] ->signalSum;
+	}
+
+	std::fill( activations.begin(), activations.end(), 0.0 );
+
+	for ( unsigned int i = 0; i < plan.inputs.size(); i++ )
+	{
+		a[ plan.inputs[ i ] ] = allCells[ plan.inputs[ i ] ] ->signalSum;
+	}
+
+	plan.step( previous, a, &workspace[ 0 ] );
+
+	for ( unsigned int i = 0; i < allCells.size(); i++ )
+	{
+		allCells[ i ] ->signalSum = a[ i ];
+	}
+}
+
+bool NNet::sendSequence( const double *inputs, double *outputs, unsigned int numberOfSteps )
+{
+	if ( !plan.feedForward() && !plan.recurrent() )
+	{
+		std::cerr << "Error: Net is not compiled!" << std::endl;
+		return false;
+	}
+
+	for ( unsigned int t = 0; t < numberOfSteps; t++ )
+	{
+		for ( unsigned int i = 0; i < inputCells.size(); i++ )
+		{
+			inputCells[ i ] ->firstInput( inputs[ t * inputCells.size() + i ] );
+		}
+
+		sendSignals();
+
+		for ( unsigned int i = 0; i < outputCells.size(); i++ )
+		{
+			outputs[ t * outputCells.size() + i ] = outputCells[ i ] ->finalOutput();
+		}
+	}
+
+	return true;
+}
+
+bool NNet::gradient( const double *inputs, const double *targets, unsigned int numberOfSamples,
+                     double *gradient, double &error, const double *weights )
+{
+	if ( !plan.feedForward() )
+	{
+		std::cerr << "Error: Backpropagation requires a feed forward net!" << std::endl;
+		return false;
+	}
+
+	error = backpropagate( inputs, targets, numberOfSamples, gradient, weights );
+
+	return true;
+}
+
+bool NNet::gradientDescent( double *weights, const double *inputs, const double *targets,
+                            unsigned int numberOfSamples, unsigned int steps, double learningRate,
+                            double &error )
+{
+	if ( !plan.feedForward() )
+	{
+		std::cerr << "Error: Backpropagation requires a feed forward net!" << std::endl;
+		return false;
+	}
+
+	unsigned int numberOfConnections = plan.numberOfConnections();
+
+	/*--------------------------------------------
+		Steps that increase the error are
+		taken back and the learning rate is
+		halved, successful steps increase it
+		by 10 % ("bold driver"), i.e. the
+		error never increases
+	----------------------------------------------*/
+
+	gradients.resize( 2 * numberOfConnections );
+	previousWeights.resize( numberOfConnections );
+
+	double *g = &gradients[ 0 ];
+	double *trialGradient = g + numberOfConnections;
+	double rate = learningRate;
+
+	error = backpropagate( inputs, targets, numberOfSamples, g, weights );
+
+	for ( unsigned int step = 0; step < steps; step++ )
+	{
+		std::copy( weights, weights + numberOfConnections, previousWeights.begin() );
+
+		for ( unsigned int e = 0; e < numberOfConnections; e++ )
+		{
+			weights[ e ] -= rate * g[ e ];
+		}
+
+		double trialError = backpropagate( inputs, targets, numberOfSamples, trialGradient, weights );
+
+		if ( trialError <= error )
+		{
+			error = trialError;
+			std::swap( g, trialGradient );
+			rate *= 1.1;
+		}
+		else
+		{
+			std::copy( previousWeights.begin(), previousWeights.end(), weights );
+			rate *= 0.5;
+		}
+	}
+
+	return true;
+}
+
+double NNet::backpropagate( const double *inputs, const double *targets, unsigned int numberOfSamples,
+                            double *gradient, const double *weights )
+{
+	const unsigned int numberOfCells = plan.numberOfCells();
+	const unsigned int numberOfInputs = plan.inputs.size();
+	const unsigned int numberOfOutputs = plan.outputs.size();
+
+	if ( weights == NULL ) weights = plan.weightData();
+
+	if ( gradient != NULL )
+	{
+		std::fill( gradient, gradient + plan.numberOfConnections(), 0.0 );
+	}
+
+	if ( numberOfCells == 0 || numberOfSamples == 0 ) return 0;
+
+	double *a = &activations[ 0 ];
+
+	deltas.resize( numberOfCells );
+
+	double error = 0;
+
+	/*--------------------------------------------
+		Forward pass, then the derivatives of
+		E with respect to the output cells
+		( output - target ) / numberOfSamples
+		are propagated back
+	----------------------------------------------*/
+
+	for ( unsigned int n = 0; n < numberOfSamples; n++ )
+	{
+		std::fill( activations.begin(), activations.end(), 0.0 );
+
+		for ( unsigned int i = 0; i < numberOfInputs; i++ )
+		{
+			a[ plan.inputs[ i ] ] = inputs[ n * numberOfInputs + i ];
+		}
+
+		plan.forward( a, &workspace[ 0 ], weights );
+
+		std::fill( deltas.begin(), deltas.end(), 0.0 );
+
+		for ( unsigned int j = 0; j < numberOfOutputs; j++ )
+		{
+			double difference = a[ plan.outputs[ j ] ] - targets[ n * numberOfOutputs + j ];
+
+			error += difference * difference;
+			deltas[ plan.outputs[ j ] ] += difference / numberOfSamples;
+		}
+
+		if ( gradient != NULL )
+		{
+			plan.backward( a, &deltas[ 0 ], gradient, weights );
+		}
+	}
+
+	return error / ( 2.0 * numberOfSamples );
+}
+
+void NNet::sendSignalsWavefront()
+{
+
+
+	// Reset all cells if memory disabled
+	if ( !enableMemory )
+	{
+
+// 		//Save activation values of all input cells
+// 		std::vector <double> tmpActivations;
+//
+// 		for ( unsigned int i = 0; i < this->inputCells.size();i++ )
+// 		{
+// 			tmpActivations.push_back( this->inputCells[ i ] ->finalOutput() );
+// 		}
+//
+// 		// Reset activations of all cells
+// 		for ( unsigned int i = 0; i < this->allCells.size();i++ )
+// 		{
+// 			this->allCells[ i ] ->firstInput( 0 );
+// 		}
+//
+// 		//restore Activation of output cells as they are
+// 		//resetted if memory disabled
+// 		for ( unsigned int i = 0; i < this->inputCells.size();i++ )
+// 		{
+// 			this->inputCells[ i ] ->firstInput( tmpActivations[ i ] ) ;
+// 		}
+
+		reset();
+	}
+
+
+	std::vector <Cell*> tmpCells1;
+
+
+	tmpCells1 = inputCells;
+
+// 		for ( unsigned int i = 0; i < inputCells.size();i++ )
+// 		{
+// 			std::cout << "Input (" << i << "):\t" << inputCells[ i ] ->signalSum << std::endl;
+// 		}
+// 		std::cout << "---------------------------" << std::endl;
+// 		for ( unsigned int i = 0; i < outputCells.size();i++ )
+// 		{
+// 			std::cout << "Output (" << i << "):\t" << outputCells[ i ] ->signalSum << std::endl;
+// 		}
+// 		std::cout << "---------------------------" << std::endl;
+
+
+	tmpCells1 = inputCells;
+
+	while ( tmpCells1.size() > 0 )
+	{
+		std::vector <Cell*> tmpCells2;
+
+		for ( unsigned int i = 0; i < tmpCells1.size(); i++ )
+		{
+			for ( unsigned int j = 0; j < tmpCells1[ i ] ->connections.size();j++ )
+			{
+				Cell * connectedCell = tmpCells1[ i ] ->connections[ j ];
+
+				// 				bool alreadyConnected = false;
+				// 				for (int k = 0;k < tmpCells2.size();k++)
+				// 				{
+				// 					if (tmpCells2[k]->netIndex == connectedCell->netIndex ) alreadyConnected = true;
+				// 				}
+				if ( !connectedCell->alreadyConnected )
+				{
+					tmpCells2.push_back( connectedCell );
+					connectedCell->alreadyConnected = true;
+				}
+			}
+			tmpCells1[ i ] ->sendSignals();
+		}
+		for ( unsigned int k = 0;k < tmpCells2.size();k++ )
+		{
+			tmpCells2[ k ] ->alreadyConnected = false;
+		}
+		tmpCells1 = tmpCells2;
+
+	}
+
+// 				for ( unsigned int i = 0; i < inputCells.size();i++ )
+// 				{
+// 					std::cout << "Input (" << i << "):\t" << inputCells[ i ] ->signalSum << std::endl;
 // 				}
 // 				std::cout << "---------------------------" << std::endl;
 // 				for ( unsigned int i = 0; i < outputCells.size();i++ )
@@ -288,588 +1994,2453 @@ void NNet::sendSignals()
 
 
 
-// 	//Save activation values of all output cells
-// 	std::vector <double> tmpActivations;
-//
-// 	for ( unsigned int i = 0; i < this->outputCells.size();i++ )
-// 	{
-// 		tmpActivations.push_back( this->outputCells[ i ] ->finalOutput() );
-// 	}
+// 	//Save activation values of all output cells
+// 	std::vector <double> tmpActivations;
+//
+// 	for ( unsigned int i = 0; i < this->outputCells.size();i++ )
+// 	{
+// 		tmpActivations.push_back( this->outputCells[ i ] ->finalOutput() );
+// 	}
+
+
+// 	// Reset all cells if memory disabled
+// 	if ( !enableMemory )
+// 	{
+//
+// 	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+// 	{
+// 		this->allCells[ i ] ->firstInput( 0 );
+// 	}
+//
+// 	}
+
+
+	// restore Activation of output cells as they are
+	// resetted if memory disabled
+// 	for ( unsigned int i = 0; i < this->outputCells.size();i++ )
+// 	{
+// 		this->outputCells[ i ] ->firstInput( tmpActivations[ i ] ) ;
+// 	}
+}
+
+bool NNet::readHeaderSection( TextReader &reader )
+{
+	/*-----------------------------------------
+		  Read Header Information
+	------------------------------------------*/
+
+	if ( !reader.next() || !reader.is( "<header>" ) )
+	{
+		std::cerr << "Error: Unknown file format!" << std::endl;
+		return false;
+	}
+
+	if ( !reader.next() || !reader.is( "#NNet-File" ) )
+	{
+		std::cerr << "Error: Unknown file format!" << std::endl;
+		return false;
+	}
+
+	double version = 0;
+
+	if ( !reader.next() || !reader.toDouble( version ) || version == 0 )
+	{
+		std::cerr << "Error: Can't verify version of file format!" << std::endl;
+		return false;
+	}
+
+	if ( version > 0.1 )
+	{
+		std::cerr << "Error: File is made by newer version of this program!" << std::endl;
+		return false;
+	}
+
+	// skip unknown entries
+	while ( reader.next() )
+	{
+		if ( reader.is( "</header>" ) ) return true;
+	}
+
+	std::cerr << "Error: Missing </header>!" << std::endl;
+	return false;
+}
+
+bool NNet::readInputSection( TextReader &reader )
+{
+	/*-----------------------------------------
+		   Read Input-Cell Indices
+	------------------------------------------*/
+
+	if ( !reader.next() || !reader.is( "<inputs>" ) )
+	{
+		std::cerr << "Error: Input section missing!" << std::endl;
+		return false;
+	}
+
+	for ( unsigned int i = 1; reader.next(); i++ )
+	{
+		if ( reader.is( "</inputs>" ) ) return true;
+
+		int tmpVal = 0;
+		if ( !reader.toInt( tmpVal ) )
+		{
+			std::cerr << "Error: Entry " << i << " in \"<inputs> </inputs>\" - Section is not a valid integer number!" << std::endl;
+			return false;
+		}
+		inputList.push_back( tmpVal );
+	}
+
+	std::cerr << "Error: Missing </inputs>!" << std::endl;
+	return false;
+}
+
+bool NNet::readOutputSection( TextReader &reader )
+{
+	/*-----------------------------------------
+		   Read Output-Cell Indices
+	------------------------------------------*/
+
+	if ( !reader.next() || !reader.is( "<outputs>" ) )
+	{
+		std::cerr << "Error: Output section missing!" << std::endl;
+		return false;
+	}
+
+	for ( unsigned int i = 1; reader.next(); i++ )
+	{
+		if ( reader.is( "</outputs>" ) ) return true;
+
+		int tmpVal = 0;
+		if ( !reader.toInt( tmpVal ) )
+		{
+			std::cerr << "Error: Entry " << i << " in \"<outputs> </outputs>\" - Section is not a valid integer number!" << std::endl;
+			return false;
+		}
+		outputList.push_back( tmpVal );
+	}
+
+	std::cerr << "Error: Missing </outputs>!" << std::endl;
+	return false;
+}
+
+bool NNet::readConnectionSection( TextReader &reader )
+{
+	/*-----------------------------------------
+		Read Connection Information
+
+		Each connection consists of three
+		entries (sender, receiver, weight),
+		the rest of a line that starts with
+		'#' is a comment.
+	------------------------------------------*/
+
+	if ( !reader.next() || !reader.is( "<connections>" ) )
+	{
+		std::cerr << "Error: Connections section missing!" << std::endl;
+		return false;
+	}
+
+	netConnection connection( 0, 0, 0 );
+
+	for ( unsigned int i = 1; reader.next(); )
+	{
+		if ( reader.token()[ 0 ] == '#' )
+		{
+			reader.skipLine();
+			continue;
+		}
+
+		if ( reader.is( "</connections>" ) )
+		{
+			if ( ( i - 1 ) % 3 != 0 )
+			{
+				std::cerr << "Error: Wrong number of Entries in \"<connections> </connections>\" - Section!" << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+		switch ( ( i - 1 ) % 3 )
+		{
+			case 0:
+				if ( !reader.toInt( connection.sender ) )
+				{
+					std::cerr << "Error: Entry " << i << " in \"<connections> </connections>\" - Section is not a valid integer number!" << std::endl;
+					return false;
+				}
+				break;
+			case 1:
+				if ( !reader.toInt( connection.receiver ) )
+				{
+					std::cerr << "Error: Entry " << i << " in \"<connections> </connections>\" - Section is not a valid integer number!" << std::endl;
+					return false;
+				}
+				break;
+			default:
+				if ( !reader.toDouble( connection.weight ) )
+				{
+					std::cerr << "Error: Entry " << i << " in \"<connections> </connections>\" - Section is not a valid floating point number!" << std::endl;
+					return false;
+				}
+				connectionList.push_back( connection );
+				break;
+		}
+
+		i++;
+	}
+
+	std::cerr << "Error: Missing </connections>!" << std::endl;
+	return false;
+}
+
+const int NNet::getNumberOfCells() const
+{
+	/*--------------------------------------------
+		Get number of cells
+	----------------------------------------------*/
+
+	int numberOfCells = 0;
+
+	for ( unsigned int i = 0; i < connectionList.size();i++ )
+	{
+		if ( numberOfCells < connectionList[ i ].sender )
+		{
+			numberOfCells = connectionList[ i ].sender;
+		}
+		if ( numberOfCells < connectionList[ i ].receiver )
+		{
+			numberOfCells = connectionList[ i ].receiver;
+		}
+	}
+
+	for ( unsigned int i = 0; i < inputList.size();i++ )
+	{
+		if ( numberOfCells < inputList[ i ] )
+		{
+			numberOfCells = inputList[ i ];
+		}
+	}
+
+	for ( unsigned int i = 0; i < outputList.size();i++ )
+	{
+		if ( numberOfCells < outputList[ i ] )
+		{
+			numberOfCells = outputList[ i ];
+		}
+	}
+
+	return numberOfCells + 1;
+}
+
+void NNet::generateCells( unsigned int numberOfCells )
+{
+	/*--------------------------------------------
+		Store cells in NNet::allCells
+	----------------------------------------------*/
+
+	//std::vector <Cell*> cellList;
+
+	for ( unsigned int i = 0;i < numberOfCells;i++ )
+	{
+		Cell *tmpCell = new Cell;
+		tmpCell->netIndex = i;
+		this->allCells.push_back( tmpCell );
+	}
+}
+
+void NNet::storeInputCells()
+{
+	/*--------------------------------------------
+		Store input cells
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0;i < inputList.size();i++ )
+	{
+		this->inputCells.push_back( this->allCells[ inputList[ i ] ] );
+	}
+}
+
+void NNet::storeOutputCells()
+{
+	/*--------------------------------------------
+		Store output cells
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0;i < outputList.size();i++ )
+	{
+		this->outputCells.push_back( this->allCells[ outputList[ i ] ] );
+	}
+}
+
+void NNet::connectCells()
+{
+	/*--------------------------------------------
+		Connect cells
+	----------------------------------------------*/
+
+	for ( unsigned int i = 0; i < connectionList.size();i++ )
+	{
+		this->allCells[ connectionList[ i ].sender ] ->connect( this->allCells[ connectionList[ i ].receiver ], connectionList[ i ].weight );
+//  		std::cout << "Connect: " << connectionList[ i ].sender << " -> " << connectionList[ i ].receiver << std::endl;
+	}
+}
+
+bool NNet::generateNet( std::vector<int>inputs, std::vector<int>outputs, std::vector<netConnection>connections )
+{
+	// replaces the current net
+	this->clear();
+
+	this->inputList = inputs;
+	this->outputList = outputs;
+	this->connectionList = connections;
+
+	int numberOfCells = this->getNumberOfCells();
+
+	this->generateCells( numberOfCells );
+
+	this->storeInputCells();
+
+	this->storeOutputCells();
+
+	this->connectCells();
+
+	this->compile();
+
+	return true;
+}
+
+const NNetPlan &NNet::getPlan() const
+{
+	return plan;
+}
+
+void NNet::compile()
+{
+	// the plan is compiled from Cell::weights
+	releaseWeights();
+
+	plan.compile( allCells, inputCells, outputCells );
+
+	activations.assign( allCells.size(), 0.0 );
+	previousActivations.assign( allCells.size(), 0.0 );
+	workspace.assign( allCells.size(), 0.0 );
+}
+
+unsigned int NNet::addCell()
+{
+	Cell *cell = new Cell;
+	cell->netIndex = allCells.size();
+	allCells.push_back( cell );
+
+	if ( plan.numberOfCells() + 1 == allCells.size() )
+	{
+		plan.addCell();
+
+		activations.push_back( 0 );
+		previousActivations.push_back( 0 );
+		workspace.push_back( 0 );
+	}
+	else
+	{
+		compile();
+	}
+
+	return cell->netIndex;
+}
+
+bool NNet::addConnection( unsigned int sender, unsigned int receiver, double weight )
+{
+	if ( sender >= allCells.size() || receiver >= allCells.size() )
+	{
+		std::cerr << "Error: Cell doesn't exist!" << std::endl;
+		return false;
+	}
+
+	// the number of weights changes
+	releaseWeights();
+
+	allCells[ sender ] ->connect( allCells[ receiver ], weight );
+
+	netConnection connection( ( int ) sender, ( int ) receiver, 0 );
+	connection.weight = weight;
+
+	if ( plan.numberOfCells() != allCells.size() )
+	{
+		connectionList.push_back( connection );
+		compile();
+		return true;
+	}
+
+	// the connections are stored in the order of the weights
+	connectionList.insert( connectionList.begin() + plan.rowStart[ sender + 1 ], connection );
+
+	plan.addConnection( sender, receiver, weight );
+
+	return true;
+}
+
+
+
+/*--------------------------------------------
+	Header of the binary file format
+	(see MappedNNet)
+----------------------------------------------*/
+
+static const char binaryMagic[ 8 ] = { '#', 'N', 'N', 'e', 't', 'B', 'i', 'n' };
+static const uint32_t binaryVersion = 1;
+static const uint32_t byteOrderMark = 0x01020304;
+
+struct NNetBinaryHeader
+{
+	char magic[ 8 ];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint64_t numberOfCells;
+	uint64_t numberOfInputs;
+	uint64_t numberOfOutputs;
+	uint64_t numberOfConnections;
+	uint64_t inputOffset;
+	uint64_t outputOffset;
+	uint64_t rowStartOffset;
+	uint64_t targetOffset;
+	uint64_t weightOffset;
+	uint64_t fileSize;
+};
+
+static uint64_t align8( uint64_t value )
+{
+	return ( value + 7 ) & ~( uint64_t ) 7;
+}
+
+bool NNet::loadNet( std::string fileName )
+{
+	// binary file?
+	char magic[ 8 ] = { 0 };
+
+	FILE *file = fopen( fileName.c_str(), "rb" );
+
+	if ( file == NULL )
+	{
+		std::cerr << "Error: File doesn't exist!" << std::endl;
+		return false;
+	};
+
+	size_t bytes = fread( magic, 1, 8, file );
+
+	fclose( file );
+
+	if ( bytes == 8 && std::memcmp( magic, binaryMagic, 8 ) == 0 )
+	{
+		return loadBinaryNet( fileName );
+	}
+
+	/*--------------------------------------------
+		Text file, read in one pass
+	----------------------------------------------*/
+
+	TextReader reader;
+
+	if ( !reader.open( fileName ) )
+	{
+		std::cerr << "Error: File doesn't exist!" << std::endl;
+		return false;
+	}
+
+	clear();
+
+	if ( !this->readHeaderSection( reader ) ) return false;
+
+	if ( !this->readInputSection( reader ) ) return false;
+
+	if ( !this->readOutputSection( reader ) ) return false;
+
+	if ( !this->readConnectionSection( reader ) ) return false;
+
+	reader.close();
+
+	// the lists are already stored, i.e. no need to copy them (generateNet())
+	this->generateCells( this->getNumberOfCells() );
+
+	this->storeInputCells();
+
+	this->storeOutputCells();
+
+	this->connectCells();
+
+	this->compile();
+
+	return true;
+}
+
+bool NNet::loadBinaryNet( std::string fileName )
+{
+	MappedNNet file;
+
+	if ( !file.open( fileName ) ) return false;
+
+	std::vector <unsigned int> inputs( file.inputs(), file.inputs() + file.numberOfInputs() );
+	std::vector <unsigned int> outputs( file.outputs(), file.outputs() + file.numberOfOutputs() );
+
+	clear();
+
+	generateNet( file.numberOfCells(), inputs, outputs, file.rowStart(), file.targets(), file.weights() );
+
+	return true;
+}
+
+void NNet::generateNet( unsigned int numberOfCells, const std::vector <unsigned int> &inputs,
+                        const std::vector <unsigned int> &outputs, const unsigned int *rowStart,
+                        const unsigned int *targets, const double *weights )
+{
+	inputList.assign( inputs.begin(), inputs.end() );
+	outputList.assign( outputs.begin(), outputs.end() );
+
+	connectionList.clear();
+	connectionList.reserve( rowStart[ numberOfCells ] );
+
+	for ( unsigned int i = 0; i < numberOfCells; i++ )
+	{
+		for ( unsigned int e = rowStart[ i ]; e < rowStart[ i + 1 ]; e++ )
+		{
+			netConnection connection( ( int ) i, ( int ) targets[ e ], 0 );
+			connection.weight = weights[ e ];
+			connectionList.push_back( connection );
+		}
+	}
+
+	generateCells( numberOfCells );
+
+	storeInputCells();
+
+	storeOutputCells();
+
+	connectCells();
+
+	compile();
+}
+
+bool NNet::saveBinaryNet( std::string fileName )
+{
+	if ( plan.numberOfCells() != allCells.size() )
+	{
+		std::cerr << "Error: Net is not compiled!" << std::endl;
+		return false;
+	}
+
+	/*-----------------------------------------
+		  Layout of the file
+	------------------------------------------*/
+
+	NNetBinaryHeader header;
+
+	std::memset( &header, 0, sizeof( header ) );
+	std::memcpy( header.magic, binaryMagic, 8 );
+	header.version = binaryVersion;
+	header.byteOrder = byteOrderMark;
+	header.numberOfCells = plan.numberOfCells();
+	header.numberOfInputs = plan.inputs.size();
+	header.numberOfOutputs = plan.outputs.size();
+	header.numberOfConnections = plan.numberOfConnections();
+
+	header.inputOffset = align8( sizeof( header ) );
+	header.outputOffset = align8( header.inputOffset + 4 * header.numberOfInputs );
+	header.rowStartOffset = align8( header.outputOffset + 4 * header.numberOfOutputs );
+	header.targetOffset = align8( header.rowStartOffset + 4 * ( header.numberOfCells + 1 ) );
+	header.weightOffset = align8( header.targetOffset + 4 * header.numberOfConnections );
+	header.fileSize = header.weightOffset + 8 * header.numberOfConnections;
+
+	/*-----------------------------------------
+		  Write sections
+	------------------------------------------*/
+
+	std::ofstream f( fileName.c_str(), std::ios::out | std::ios::binary );
+
+	if ( !f )
+	{
+		std::cerr << "Error: Can't write file!" << std::endl;
+		return false;
+	}
+
+	const char padding[ 8 ] = { 0 };
+
+	f.write( ( const char* ) &header, sizeof( header ) );
+
+	f.write( padding, header.inputOffset - sizeof( header ) );
+	f.write( ( const char* ) plan.inputs.data(), 4 * header.numberOfInputs );
+
+	f.write( padding, header.outputOffset - header.inputOffset - 4 * header.numberOfInputs );
+	f.write( ( const char* ) plan.outputs.data(), 4 * header.numberOfOutputs );
+
+	f.write( padding, header.rowStartOffset - header.outputOffset - 4 * header.numberOfOutputs );
+	f.write( ( const char* ) plan.rowStart.data(), 4 * ( header.numberOfCells + 1 ) );
+
+	f.write( padding, header.targetOffset - header.rowStartOffset - 4 * ( header.numberOfCells + 1 ) );
+	f.write( ( const char* ) plan.targets.data(), 4 * header.numberOfConnections );
+
+	f.write( padding, header.weightOffset - header.targetOffset - 4 * header.numberOfConnections );
+	f.write( ( const char* ) plan.weightData(), 8 * header.numberOfConnections );
+
+	f.close();
+
+	if ( !f )
+	{
+		std::cerr << "Error: Can't write file!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool NNet::convertNet( std::string textFileName, std::string binaryFileName )
+{
+	NNet net;
+
+	if ( !net.loadNet( textFileName ) ) return false;
+
+	return net.saveBinaryNet( binaryFileName );
+}
+
+PruningReport::PruningReport()
+{
+	cellsBefore = 0;
+	cellsAfter = 0;
+	connectionsBefore = 0;
+	connectionsAfter = 0;
+	secondsBefore = 0;
+	secondsAfter = 0;
+	speedup = 0;
+	maxOutputChange = 0;
+}
+
+void PruningReport::print( std::ostream &out ) const
+{
+	out << "Cells:          " << cellsBefore << " -> " << cellsAfter << std::endl;
+	out << "Connections:    " << connectionsBefore << " -> " << connectionsAfter << std::endl;
+	out << "Forward pass:   " << secondsBefore * 1e6 << " us -> " << secondsAfter * 1e6
+	<< " us (speedup " << speedup << ")" << std::endl;
+	out << "Output change:  " << maxOutputChange << std::endl;
+}
+
+static double currentTime()
+{
+	timespec t;
+	clock_gettime( CLOCK_MONOTONIC, &t );
+
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/*--------------------------------------------
+	Evaluates the samples (memory disabled)
+	for at least 20 ms, three times, and
+	returns the fastest time of one pass
+----------------------------------------------*/
+
+static double timeForwardPass( const NNetPlan &plan, const double *samples, unsigned int numberOfSamples,
+                               double *outputs )
+{
+	const unsigned int numberOfCells = plan.numberOfCells();
+	const unsigned int numberOfInputs = plan.inputs.size();
+
+	std::vector <double> buffer( 3 * numberOfCells + 1, 0.0 );
+
+	double *a = &buffer[ 0 ];
+	double *workspace = a + numberOfCells;
+	double *previous = a + 2 * numberOfCells;
+
+	double best = 0;
+
+	// the fastest of three rounds (the first one also warms up the caches)
+	for ( unsigned int round = 0; round < 3; round++ )
+	{
+		unsigned long passes = 0;
+		double start = currentTime();
+		double seconds = 0;
+
+		do
+		{
+			for ( unsigned int n = 0; n < numberOfSamples; n++ )
+			{
+				std::fill( a, a + numberOfCells, 0.0 );
+
+				for ( unsigned int i = 0; i < numberOfInputs; i++ )
+				{
+					a[ plan.inputs[ i ] ] = samples[ n * numberOfInputs + i ];
+				}
+
+				if ( plan.recurrent() )
+				{
+					plan.step( previous, a, workspace );
+				}
+				else
+				{
+					plan.forward( a, workspace );
+				}
+
+				for ( unsigned int j = 0; j < plan.outputs.size(); j++ )
+				{
+					outputs[ n * plan.outputs.size() + j ] = a[ plan.outputs[ j ] ];
+				}
+			}
+
+			passes += numberOfSamples;
+			seconds = currentTime() - start;
+		}
+		while ( seconds < 0.02 );
+
+		if ( round == 0 || seconds / passes < best ) best = seconds / passes;
+	}
+
+	return best;
+}
+
+bool NNet::prune( double threshold, PruningReport *report, const double *samples, unsigned int numberOfSamples )
+{
+	if ( !plan.feedForward() && !plan.recurrent() )
+	{
+		std::cerr << "Error: Net is not compiled!" << std::endl;
+		return false;
+	}
+
+	const unsigned int numberOfCells = plan.numberOfCells();
+	const double *w = plan.weightData();
+
+	if ( plan.numberOfConnections() > 0 && w == NULL )
+	{
+		std::cerr << "Error: Net has no weights!" << std::endl;
+		return false;
+	}
+
+	/*--------------------------------------------
+		Cells that are reached from the input
+		cells over the remaining connections
+	----------------------------------------------*/
+
+	std::vector <char> keepConnection( plan.numberOfConnections(), 0 );
+
+	for ( unsigned int e = 0; e < plan.numberOfConnections(); e++ )
+	{
+		keepConnection[ e ] = fabs( w[ e ] ) > threshold;
+	}
+
+	std::vector <char> reached( numberOfCells, 0 );
+	std::vector <unsigned int> queue;
+
+	for ( unsigned int i = 0; i < plan.inputs.size(); i++ )
+	{
+		if ( !reached[ plan.inputs[ i ] ] )
+		{
+			reached[ plan.inputs[ i ] ] = 1;
+			queue.push_back( plan.inputs[ i ] );
+		}
+	}
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		for ( unsigned int e = plan.rowStart[ queue[ i ] ]; e < plan.rowStart[ queue[ i ] + 1 ]; e++ )
+		{
+			if ( keepConnection[ e ] && !reached[ plan.targets[ e ] ] )
+			{
+				reached[ plan.targets[ e ] ] = 1;
+				queue.push_back( plan.targets[ e ] );
+			}
+		}
+	}
+
+	/*--------------------------------------------
+		Cells that reach an output cell
+		(backwards over the incoming
+		connections of the reached cells)
+	----------------------------------------------*/
+
+	std::vector <unsigned int> inStart( numberOfCells + 1, 0 );
+	std::vector <unsigned int> inSenders;
+
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
+	{
+		for ( unsigned int e = plan.rowStart[ cell ]; e < plan.rowStart[ cell + 1 ]; e++ )
+		{
+			if ( keepConnection[ e ] && reached[ cell ] ) inStart[ plan.targets[ e ] + 1 ] ++;
+		}
+	}
+
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
+	{
+		inStart[ cell + 1 ] += inStart[ cell ];
+	}
+
+	inSenders.resize( inStart[ numberOfCells ] );
+
+	std::vector <unsigned int> fill( inStart.begin(), inStart.end() - 1 );
+
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
+	{
+		for ( unsigned int e = plan.rowStart[ cell ]; e < plan.rowStart[ cell + 1 ]; e++ )
+		{
+			if ( keepConnection[ e ] && reached[ cell ] ) inSenders[ fill[ plan.targets[ e ] ] ++ ] = cell;
+		}
+	}
+
+	std::vector <char> useful( numberOfCells, 0 );
+
+	queue.clear();
+
+	for ( unsigned int i = 0; i < plan.outputs.size(); i++ )
+	{
+		if ( !useful[ plan.outputs[ i ] ] )
+		{
+			useful[ plan.outputs[ i ] ] = 1;
+			queue.push_back( plan.outputs[ i ] );
+		}
+	}
+
+	for ( unsigned int i = 0; i < queue.size(); i++ )
+	{
+		for ( unsigned int k = inStart[ queue[ i ] ]; k < inStart[ queue[ i ] + 1 ]; k++ )
+		{
+			if ( !useful[ inSenders[ k ] ] )
+			{
+				useful[ inSenders[ k ] ] = 1;
+				queue.push_back( inSenders[ k ] );
+			}
+		}
+	}
+
+	/*--------------------------------------------
+		Renumber the remaining cells, input and
+		output cells are always kept
+	----------------------------------------------*/
+
+	std::vector <unsigned int> newIndex( numberOfCells, 0xffffffff );
+	unsigned int numberOfRemainingCells = 0;
+
+	for ( unsigned int i = 0; i < plan.inputs.size(); i++ ) useful[ plan.inputs[ i ] ] = 1;
+	for ( unsigned int i = 0; i < plan.outputs.size(); i++ ) reached[ plan.outputs[ i ] ] = 1;
+
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
+	{
+		if ( reached[ cell ] && useful[ cell ] )
+		{
+			newIndex[ cell ] = numberOfRemainingCells++;
+		}
+	}
+
+	std::vector <unsigned int> rowStart( 1, 0 );
+	std::vector <unsigned int> targets;
+	std::vector <double> weights;
+
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
+	{
+		if ( newIndex[ cell ] == 0xffffffff ) continue;
+
+		for ( unsigned int e = plan.rowStart[ cell ]; e < plan.rowStart[ cell + 1 ]; e++ )
+		{
+			if ( keepConnection[ e ] && newIndex[ plan.targets[ e ] ] != 0xffffffff )
+			{
+				targets.push_back( newIndex[ plan.targets[ e ] ] );
+				weights.push_back( w[ e ] );
+			}
+		}
+
+		rowStart.push_back( targets.size() );
+	}
+
+	std::vector <unsigned int> inputs( plan.inputs.size() );
+	std::vector <unsigned int> outputs( plan.outputs.size() );
+
+	for ( unsigned int i = 0; i < inputs.size(); i++ ) inputs[ i ] = newIndex[ plan.inputs[ i ] ];
+	for ( unsigned int i = 0; i < outputs.size(); i++ ) outputs[ i ] = newIndex[ plan.outputs[ i ] ];
+
+	/*--------------------------------------------
+		Rebuild the net
+	----------------------------------------------*/
+
+	NNetPlan before;
+
+	if ( report != NULL ) before = plan;
+
+	clear();
+
+	generateNet( numberOfRemainingCells, inputs, outputs, &rowStart[ 0 ],
+	             targets.empty() ? NULL : &targets[ 0 ], weights.empty() ? NULL : &weights[ 0 ] );
+
+	if ( report == NULL ) return true;
+
+	/*--------------------------------------------
+		Report
+	----------------------------------------------*/
+
+	std::vector <double> zeros;
+
+	if ( samples == NULL || numberOfSamples == 0 )
+	{
+		zeros.assign( inputs.size() + 1, 0.0 );
+		samples = &zeros[ 0 ];
+		numberOfSamples = 1;
+	}
+
+	std::vector <double> outputsBefore( numberOfSamples * outputs.size() + 1 );
+	std::vector <double> outputsAfter( numberOfSamples * outputs.size() + 1 );
+
+	report->cellsBefore = before.numberOfCells();
+	report->cellsAfter = plan.numberOfCells();
+	report->connectionsBefore = before.numberOfConnections();
+	report->connectionsAfter = plan.numberOfConnections();
+
+	report->secondsBefore = timeForwardPass( before, samples, numberOfSamples, &outputsBefore[ 0 ] );
+	report->secondsAfter = timeForwardPass( plan, samples, numberOfSamples, &outputsAfter[ 0 ] );
+	report->speedup = report->secondsAfter > 0 ? report->secondsBefore / report->secondsAfter : 0;
+
+	report->maxOutputChange = 0;
+
+	if ( zeros.empty() )
+	{
+		for ( unsigned int k = 0; k < numberOfSamples * outputs.size(); k++ )
+		{
+			report->maxOutputChange = std::max( report->maxOutputChange, fabs( outputsBefore[ k ] - outputsAfter[ k ] ) );
+		}
+	}
+
+	return true;
+}
+
+void NNet::writeHeaderSection( std::ofstream &f, double version ) const
+{
+	/*-----------------------------------------
+		  Write Header-Section
+	------------------------------------------*/
+
+	f << "<header>\n";
+	f << "#NNet-File " << version;
+	f << "\n</header>\n";
+
+}
+
+void NNet::writeInputSection( std::ofstream &f ) const
+{
+	/*-----------------------------------------
+		  Write Input-Section
+	------------------------------------------*/
+
+	f << "<inputs>\n";
+
+	for ( unsigned int i = 0;i < this->inputList.size();i++ )
+	{
+		f << this->inputList[ i ] << " ";
+	}
+
+	f << "\n</inputs>\n";
+
+}
+
+void NNet::writeOutputSection( std::ofstream &f ) const
+{
+	/*-----------------------------------------
+		  Write Output-Section
+	------------------------------------------*/
+
+	f << "<outputs>\n";
+
+	for ( unsigned int i = 0;i < this->outputList.size();i++ )
+	{
+		f << this->outputList[ i ] << " ";
+	}
+
+	f << "\n</outputs>\n";
+}
+
+void NNet::writeConnectionSection( std::ofstream &f ) const
+{
+	/*-----------------------------------------
+		  Write Connection-Section
+	------------------------------------------*/
+
+	f << "<connections>\n";
+
+	int weightIndex = 0;
+	int senderTmp = 0;
+
+	// bound weights are not stored in the cells (see bindWeights())
+	const double *boundWeights = weightsBound() ? plan.weightData() : NULL;
+
+	for ( unsigned int i = 0;i < this->connectionList.size();i++ )
+	{
+		int sender = this->connectionList[ i ].sender;
+		int receiver = this->connectionList[ i ].receiver;
+
+		if ( senderTmp != sender )
+		{
+			weightIndex = 0;
+			senderTmp = sender;
+		}
+
+		double weight = boundWeights != NULL ? boundWeights[ plan.rowStart[ sender ] + weightIndex ] :
+		                this->allCells[ sender ] ->weights[ weightIndex ];
+
+		f << sender << " " << receiver
+		<< " " << weight << std::endl;
+
+// 		std::cout << sender << " " << receiver
+// 		<< " " << this->allCells[ sender ] ->weights[ weightIndex ] << std::endl;
+
+		weightIndex++;
+	}
+
+	f << "</connections>\n";
+}
+
+bool NNet::saveNet( std::string fileName )
+{
+
+	// The file stream
+	std::ofstream f( fileName.c_str(), std::ios::out );
+
+	this->writeHeaderSection( f, 0.1 );
+	this->writeInputSection( f );
+	this->writeOutputSection( f );
+	this->writeConnectionSection( f );
+
+	f.close();
+
+	return true;
+}
+
+Cell * NNet::input( int i )
+{
+	return this->inputCells[ i ];
+}
+
+Cell * NNet::output( int i )
+{
+	return this->outputCells[ i ];
+}
+
+const int NNet::numberOfConnections() const
+{
+	return connectionList.size();
+}
+
+void NNet::setWeights( std::vector<double>newWeights )
+{
+	int indexOffset = 0;
+
+	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+	{
+		for ( unsigned int j = 0; j < this->allCells[ i ] ->weights.size(); j++ )
+		{
+			this->allCells[ i ] ->weights[ j ] = newWeights[ j + indexOffset ];
+		}
+		indexOffset += this->allCells[ i ] ->weights.size();
+	}
+
+	// the plan stores the weights in the same order
+	if ( plan.weights.size() == newWeights.size() )
+	{
+		std::copy( newWeights.begin(), newWeights.end(), plan.weights.begin() );
+	}
+
+	plan.bindWeights( NULL );
+}
+
+bool NNet::bindWeights( const double *weights )
+{
+	if ( !plan.feedForward() && !plan.recurrent() )
+	{
+		return false;
+	}
+
+	plan.bindWeights( weights );
+
+	return true;
+}
+
+void NNet::releaseWeights()
+{
+	if ( !weightsBound() ) return;
+
+	const double *weights = plan.weightData();
+
+	setWeights( std::vector<double>( weights, weights + plan.numberOfConnections() ) );
+}
+
+bool NNet::weightsBound() const
+{
+	const double *weights = plan.weightData();
+
+	return weights != NULL && !plan.weights.empty() && weights != &plan.weights[ 0 ];
+}
+
+void NNet::copyWeightsToCells()
+{
+	if ( !weightsBound() ) return;
+
+	const double *weights = plan.weightData();
+
+	for ( unsigned int i = 0; i < allCells.size() && i < plan.numberOfCells(); i++ )
+	{
+		std::vector <double> &cellWeights = allCells[ i ] ->weights;
+
+		for ( unsigned int j = 0; j < cellWeights.size(); j++ )
+		{
+			cellWeights[ j ] = weights[ plan.rowStart[ i ] + j ];
+		}
+	}
+}
+
+NNet::~ NNet()
+{
+	clear();
+}
+
+void NNet::clear()
+{
+	//delete memory of all cells
+	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+	{
+		if ( allCells[i] != NULL )
+		{
+			delete allCells[ i ];
+			allCells[i] = NULL;
+		}
+	}
+
+	allCells.clear();
+	inputCells.clear();
+	outputCells.clear();
+	inputList.clear();
+	outputList.clear();
+	connectionList.clear();
+}
+
+void NNet::setActivation( Activation::Function function, Activation::Precision precision )
+{
+	plan.activation = Activation( function, precision );
+}
+
+const Activation &NNet::activation() const
+{
+	return plan.activation;
+}
+
+void NNet::setMemory( bool value )
+{
+	enableMemory = value;
+}
+
+void NNet::reset()
+{
+	//Save activation values of all input cells
+	std::vector <double> tmpActivations;
+
+	for ( unsigned int i = 0; i < this->inputCells.size();i++ )
+	{
+		tmpActivations.push_back( this->inputCells[ i ] ->finalOutput() );
+	}
+
+	// Reset activations of all cells
+	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+	{
+		this->allCells[ i ] ->firstInput( 0 );
+	}
+
+	//restore Activation of output cells as they are
+	//resetted if memory disabled
+	for ( unsigned int i = 0; i < this->inputCells.size();i++ )
+	{
+		this->inputCells[ i ] ->firstInput( tmpActivations[ i ] ) ;
+	}
+}
+
+void NNet::setInputs( NNetInput &input )
+{
+	for ( int i = 0; i < inputCells.size();i++ )
+	{
+		inputCells[i]->firstInput( input.getValue( i ) );
+	}
+}
+
+void NNet::setInputs( const NNetDataset &data, unsigned int n )
+{
+	const double *values = data.inputs( n );
 
+	for ( unsigned int i = 0; i < inputCells.size() && i < data.numberOfInputs(); i++ )
+	{
+		inputCells[ i ] ->firstInput( values[ i ] );
+	}
+}
 
-// 	// Reset all cells if memory disabled
-// 	if ( !enableMemory )
-// 	{
-//
-// 	for ( unsigned int i = 0; i < this->allCells.size();i++ )
-// 	{
-// 		this->allCells[ i ] ->firstInput( 0 );
-// 	}
-//
-// 	}
+NNetContext::NNetContext( const NNet &net )
+{
+	plan = &net.getPlan();
+	initialize();
+}
 
+NNetContext::NNetContext( const NNetPlan &plan )
+{
+	this->plan = &plan;
+	initialize();
+}
 
-	// restore Activation of output cells as they are
-	// resetted if memory disabled
-// 	for ( unsigned int i = 0; i < this->outputCells.size();i++ )
-// 	{
-// 		this->outputCells[ i ] ->firstInput( tmpActivations[ i ] ) ;
-// 	}
+void NNetContext::initialize()
+{
+	weights = NULL;
+	enableMemory = false;
+
+	buffer.assign( 3 * plan->numberOfCells() + plan->inputs.size(), 0.0 );
+}
+
+void NNetContext::setInput( unsigned int i, double value )
+{
+	buffer[ 3 * plan->numberOfCells() + i ] = value;
+}
+
+void NNetContext::setInputs( const double *values )
+{
+	std::copy( values, values + plan->inputs.size(), buffer.begin() + 3 * plan->numberOfCells() );
+}
+
+bool NNetContext::sendSignals()
+{
+	if ( !plan->feedForward() && !plan->recurrent() )
+	{
+		return false;
+	}
+
+	unsigned int numberOfCells = plan->numberOfCells();
+
+	if ( numberOfCells == 0 ) return true;
+
+	double *a = &buffer[ 0 ];
+	double *workspace = a + numberOfCells;
+	double *previous = a + 2 * numberOfCells;
+	const double *values = a + 3 * numberOfCells;
+
+	if ( plan->recurrent() )
+	{
+		std::copy( a, a + numberOfCells, previous );
+	}
+
+	if ( !enableMemory || plan->recurrent() )
+	{
+		std::fill( a, a + numberOfCells, 0.0 );
+	}
+
+	for ( unsigned int i = 0; i < plan->inputs.size(); i++ )
+	{
+		a[ plan->inputs[ i ] ] = values[ i ];
+	}
+
+	if ( plan->recurrent() )
+	{
+		plan->step( previous, a, workspace, weights );
+	}
+	else
+	{
+		plan->forward( a, workspace, weights );
+	}
+
+	return true;
+}
+
+bool NNetContext::sendSequence( const double *inputs, double *outputs, unsigned int numberOfSteps )
+{
+	unsigned int numberOfInputs = plan->inputs.size();
+	unsigned int numberOfOutputs = plan->outputs.size();
+
+	for ( unsigned int t = 0; t < numberOfSteps; t++ )
+	{
+		setInputs( inputs + t * numberOfInputs );
+
+		if ( !sendSignals() ) return false;
+
+		for ( unsigned int i = 0; i < numberOfOutputs; i++ )
+		{
+			outputs[ t * numberOfOutputs + i ] = output( i );
+		}
+	}
+
+	return true;
+}
+
+const double NNetContext::output( unsigned int i ) const
+{
+	return buffer[ plan->outputs[ i ] ];
+}
+
+const double NNetContext::activation( unsigned int i ) const
+{
+	return buffer[ i ];
+}
+
+void NNetContext::bindWeights( const double *weights )
+{
+	this->weights = weights;
+}
+
+void NNetContext::setMemory( bool value )
+{
+	enableMemory = value;
+}
+
+void NNetContext::reset()
+{
+	std::fill( buffer.begin(), buffer.begin() + plan->numberOfCells(), 0.0 );
+}
+
+MappedNNet::MappedNNet()
+{
+	mapping = NULL;
+	mappingSize = 0;
+}
+
+MappedNNet::MappedNNet( std::string fileName )
+{
+	mapping = NULL;
+	mappingSize = 0;
+
+	open( fileName );
+}
+
+MappedNNet::~MappedNNet()
+{
+	close();
+}
+
+bool MappedNNet::open( std::string fileName )
+{
+	close();
+
+	int fileDescriptor = ::open( fileName.c_str(), O_RDONLY );
+
+	if ( fileDescriptor < 0 )
+	{
+		std::cerr << "Error: File doesn't exist!" << std::endl;
+		return false;
+	}
+
+	struct stat status;
+
+	if ( fstat( fileDescriptor, &status ) != 0 || status.st_size < ( off_t ) sizeof( NNetBinaryHeader ) )
+	{
+		std::cerr << "Error: Unknown file format!" << std::endl;
+		::close( fileDescriptor );
+		return false;
+	}
+
+	mappingSize = status.st_size;
+	mapping = mmap( NULL, mappingSize, PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+
+	::close( fileDescriptor );
+
+	if ( mapping == MAP_FAILED )
+	{
+		std::cerr << "Error: Can't map file!" << std::endl;
+		mapping = NULL;
+		mappingSize = 0;
+		return false;
+	}
+
+	/*-----------------------------------------
+	   Error Handling for Header Information
+	------------------------------------------*/
+
+	const NNetBinaryHeader *header = ( const NNetBinaryHeader* ) mapping;
+
+	bool valid = true;
+
+	if ( std::memcmp( header->magic, binaryMagic, 8 ) != 0 )
+	{
+		std::cerr << "Error: Unknown file format!" << std::endl;
+		valid = false;
+	}
+	else if ( header->version > binaryVersion )
+	{
+		std::cerr << "Error: File is made by newer version of this program!" << std::endl;
+		valid = false;
+	}
+	else if ( header->byteOrder != byteOrderMark )
+	{
+		std::cerr << "Error: File has wrong byte order!" << std::endl;
+		valid = false;
+	}
+	else if ( header->fileSize > mappingSize ||
+	          header->numberOfCells >= 0xffffffffu || header->numberOfConnections >= 0xffffffffu ||
+	          header->inputOffset % 8 || header->outputOffset % 8 || header->rowStartOffset % 8 ||
+	          header->targetOffset % 8 || header->weightOffset % 8 ||
+	          header->inputOffset + 4 * header->numberOfInputs > header->fileSize ||
+	          header->outputOffset + 4 * header->numberOfOutputs > header->fileSize ||
+	          header->rowStartOffset + 4 * ( header->numberOfCells + 1 ) > header->fileSize ||
+	          header->targetOffset + 4 * header->numberOfConnections > header->fileSize ||
+	          header->weightOffset + 8 * header->numberOfConnections > header->fileSize )
+	{
+		std::cerr << "Error: File is corrupted!" << std::endl;
+		valid = false;
+	}
+
+	if ( !valid )
+	{
+		close();
+		return false;
+	}
+
+	/*-----------------------------------------
+	   Error Handling for Topology
+	------------------------------------------*/
+
+	unsigned int numberOfCells = this->numberOfCells();
+	const unsigned int *rowStart = this->rowStart();
+	const unsigned int *targets = this->targets();
+
+	valid = rowStart[ 0 ] == 0 && rowStart[ numberOfCells ] == numberOfConnections();
+
+	for ( unsigned int i = 0; valid && i < numberOfCells; i++ )
+	{
+		valid = rowStart[ i ] <= rowStart[ i + 1 ];
+	}
+
+	for ( unsigned int e = 0; valid && e < numberOfConnections(); e++ )
+	{
+		valid = targets[ e ] < numberOfCells;
+	}
+
+	for ( unsigned int i = 0; valid && i < numberOfInputs(); i++ )
+	{
+		valid = inputs()[ i ] < numberOfCells;
+	}
+
+	for ( unsigned int i = 0; valid && i < numberOfOutputs(); i++ )
+	{
+		valid = outputs()[ i ] < numberOfCells;
+	}
+
+	if ( !valid )
+	{
+		std::cerr << "Error: File is corrupted!" << std::endl;
+		close();
+		return false;
+	}
+
+	/*-----------------------------------------
+	   Compile, the weights are not copied
+	------------------------------------------*/
+
+	std::vector <unsigned int> inputList( inputs(), inputs() + numberOfInputs() );
+	std::vector <unsigned int> outputList( outputs(), outputs() + numberOfOutputs() );
+
+	plan.compile( numberOfCells, inputList, outputList, rowStart, targets, NULL );
+	plan.bindWeights( weights() );
+
+	return true;
+}
+
+void MappedNNet::close()
+{
+	if ( mapping != NULL )
+	{
+		munmap( mapping, mappingSize );
+	}
+
+	mapping = NULL;
+	mappingSize = 0;
+
+	plan = NNetPlan();
+}
+
+const NNetPlan &MappedNNet::getPlan() const
+{
+	return plan;
+}
+
+const unsigned int MappedNNet::numberOfCells() const
+{
+	return mapping == NULL ? 0 : ( ( const NNetBinaryHeader* ) mapping ) ->numberOfCells;
+}
+
+const unsigned int MappedNNet::numberOfConnections() const
+{
+	return mapping == NULL ? 0 : ( ( const NNetBinaryHeader* ) mapping ) ->numberOfConnections;
+}
+
+const unsigned int MappedNNet::numberOfInputs() const
+{
+	return mapping == NULL ? 0 : ( ( const NNetBinaryHeader* ) mapping ) ->numberOfInputs;
+}
+
+const unsigned int MappedNNet::numberOfOutputs() const
+{
+	return mapping == NULL ? 0 : ( ( const NNetBinaryHeader* ) mapping ) ->numberOfOutputs;
+}
+
+const unsigned int *MappedNNet::inputs() const
+{
+	return ( const unsigned int* ) ( ( const char* ) mapping + ( ( const NNetBinaryHeader* ) mapping ) ->inputOffset );
+}
+
+const unsigned int *MappedNNet::outputs() const
+{
+	return ( const unsigned int* ) ( ( const char* ) mapping + ( ( const NNetBinaryHeader* ) mapping ) ->outputOffset );
+}
+
+const unsigned int *MappedNNet::rowStart() const
+{
+	return ( const unsigned int* ) ( ( const char* ) mapping + ( ( const NNetBinaryHeader* ) mapping ) ->rowStartOffset );
+}
+
+const unsigned int *MappedNNet::targets() const
+{
+	return ( const unsigned int* ) ( ( const char* ) mapping + ( ( const NNetBinaryHeader* ) mapping ) ->targetOffset );
+}
+
+const double *MappedNNet::weights() const
+{
+	return ( const double* ) ( ( const char* ) mapping + ( ( const NNetBinaryHeader* ) mapping ) ->weightOffset );
+}
+
+/*--------------------------------------------
+	IEEE half precision conversion
+----------------------------------------------*/
+
+static unsigned short floatToHalf( double value )
+{
+	unsigned short sign = value < 0 ? 0x8000 : 0;
+	double a = std::min( fabs( value ), 65504.0 );
+
+	if ( a == 0 ) return sign;
+
+	int exponent = 0;
+	frexp( a, &exponent );
+	exponent--;
+
+	if ( exponent < -14 )
+	{
+		// subnormal, rounds to the smallest normal number if necessary
+		return sign | ( unsigned short ) nearbyint( ldexp( a, 24 ) );
+	}
+
+	double mantissa = nearbyint( ldexp( a, 10 - exponent ) );
+
+	if ( mantissa == 2048 )
+	{
+		mantissa = 1024;
+		exponent++;
+	}
+
+	if ( exponent > 15 ) return sign | 0x7bff;
+
+	return sign | ( unsigned short ) ( ( exponent + 15 ) << 10 ) | ( unsigned short ) ( mantissa - 1024 );
+}
+
+static inline float halfToFloat( unsigned short h )
+{
+	/*--------------------------------------------
+		Shift exponent and mantissa into place
+		and rebias by a multiplication with
+		2^112 (handles subnormal numbers), no
+		branches, i.e. vectorizable
+	----------------------------------------------*/
+
+	union { uint32_t u; float f; } magnitude, result;
+
+	magnitude.u = ( uint32_t ) ( h & 0x7fff ) << 13;
+	magnitude.f *= 5.192296858534827628530496e33f;
+	result.u = magnitude.u | ( ( uint32_t ) ( h & 0x8000 ) << 16 );
+
+	return result.f;
+}
+
+static const unsigned int noSender = 0xffffffff;
+
+QuantizationReport::QuantizationReport()
+{
+	numberOfSamples = 0;
+	maxError = 0;
+	meanError = 0;
+	rmsError = 0;
+	relativeError = 0;
+	agreement = 0;
+	referenceBytes = 0;
+	quantizedBytes = 0;
 }
 
-bool NNet::readHeaderSection( std::ifstream  &f, std::vector <std::string> &headerList )
+void QuantizationReport::print( std::ostream &out ) const
 {
-	/*-----------------------------------------
-		  Read Header Information
-	------------------------------------------*/
+	out << "Samples:        " << numberOfSamples << std::endl;
+	out << "Max error:      " << maxError << " (relative " << relativeError << ")" << std::endl;
+	out << "Mean error:     " << meanError << std::endl;
+	out << "RMS error:      " << rmsError << std::endl;
+	out << "Agreement:      " << agreement * 100 << " %" << std::endl;
+	out << "Memory:         " << quantizedBytes << " bytes (double: " << referenceBytes << " bytes)" << std::endl;
+}
 
-	while ( !f.eof() )
-	{
-		std::string tmpStr;
-		f >> tmpStr;
-		headerList.push_back( tmpStr );
-		if ( tmpStr == "</header>" ) break;
-	}
+QuantizedNNet::QuantizedNNet()
+{
+	_format = INT8;
+	activationScale = 1;
+}
 
-	/*-----------------------------------------
-	   Error Handling for Header Information
-	------------------------------------------*/
+bool QuantizedNNet::quantize( const NNet &net, Format format, Granularity granularity,
+                              const double *samples, unsigned int numberOfSamples )
+{
+	const NNetPlan &plan = net.getPlan();
 
-	if ( headerList[ 0 ] != "<header>" )
+	if ( !plan.feedForward() )
 	{
-		std::cerr << "Error: Unknown file format!" << std::endl;
+		std::cerr << "Error: Only feed forward nets can be quantized!" << std::endl;
 		return false;
 	}
 
-	if ( headerList[ headerList.size() - 1 ] != "</header>" )
+	if ( plan.numberOfConnections() > 0 && plan.weightData() == NULL )
 	{
-		std::cerr << "Error: Missing </header>!" << std::endl;
+		std::cerr << "Error: Net has no weights!" << std::endl;
 		return false;
 	}
 
-	if ( headerList[ 1 ] != "#NNet-File" )
-	{
-		std::cerr << "Error: Unknown file format!" << std::endl;
-		return false;
-	}
+	const unsigned int numberOfCells = plan.numberOfCells();
+	const double *w = plan.weightData();
+
+	_format = format;
+	activation = plan.activation;
+	order = plan.order;
+	inputs = plan.inputs;
+	outputs = plan.outputs;
+
+	/*--------------------------------------------
+		Incoming connections of each cell,
+		sorted by sender (only cells in order
+		send signals)
+	----------------------------------------------*/
+
+	std::vector <unsigned int> position( numberOfCells, noSender );
 
-	if ( atof( headerList[ 2 ].c_str() ) == 0 )
+	for ( unsigned int i = 0; i < order.size(); i++ )
 	{
-		std::cerr << "Error: Can't verify version of file format!" << std::endl;
-		return false;
+		position[ order[ i ] ] = i;
 	}
-	else
+
+	std::vector <unsigned int> count( order.size() + 1, 0 );
+
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
 	{
-		if ( atof( headerList[ 2 ].c_str() ) > 0.1 )
+		if ( position[ cell ] == noSender ) continue;
+
+		for ( unsigned int e = plan.rowStart[ cell ]; e < plan.rowStart[ cell + 1 ]; e++ )
 		{
-			std::cerr << "Error: File is made by newer version of this program!" << std::endl;
-			return false;
+			count[ position[ plan.targets[ e ] ] + 1 ] ++;
 		}
 	}
-	return true;
-}
 
-bool NNet::readInputSection( std::ifstream &f )
-{
-	std::vector <std::string> inputStrList;
-	/*-----------------------------------------
-		   Read Input-Cell Indices
-	------------------------------------------*/
+	weightStart.assign( order.size() + 1, 0 );
 
-	while ( !f.eof() )
+	for ( unsigned int i = 0; i < order.size(); i++ )
 	{
-		std::string tmpStr;
-		f >> tmpStr;
-		inputStrList.push_back( tmpStr );
-		if ( tmpStr == "</inputs>" ) break;
+		weightStart[ i + 1 ] = weightStart[ i ] + count[ i + 1 ];
 	}
 
+	std::vector <unsigned int> edgeSenders( weightStart.back() );
+	std::vector <double> edgeWeights( weightStart.back() );
+	std::vector <unsigned int> fill( weightStart.begin(), weightStart.end() - 1 );
 
-	if ( inputStrList[ 0 ] != "<inputs>" )
-	{
-		std::cerr << "Error: Input section missing!" << std::endl;
-		return false;
-	}
-	if ( inputStrList[ inputStrList.size() - 1 ] != "</inputs>" )
+	for ( unsigned int cell = 0; cell < numberOfCells; cell++ )
 	{
-		std::cerr << "Error: Missing </inputs>!" << std::endl;
-		return false;
-	}
+		if ( position[ cell ] == noSender ) continue;
 
-	for ( unsigned int i = 1;i < inputStrList.size() - 1;i++ )
-	{
-		int tmpVal = atoi( inputStrList[ i ].c_str() );
-		if (( inputStrList[ i ] != "0" ) && ( tmpVal == 0 ) )
+		for ( unsigned int e = plan.rowStart[ cell ]; e < plan.rowStart[ cell + 1 ]; e++ )
 		{
-			std::cerr << "Error: Entry " << i << " in \"<inputs> </inputs>\" - Section is not a valid integer number!" << std::endl;
-			return false;
+			unsigned int k = fill[ position[ plan.targets[ e ] ] ] ++;
+			edgeSenders[ k ] = cell;
+			edgeWeights[ k ] = w[ e ];
 		}
-		inputList.push_back( tmpVal );
 	}
 
-	return true;
-}
-
-bool NNet::readOutputSection( std::ifstream &f )
-{
-	std::vector <std::string> outputStrList;
+	/*--------------------------------------------
+		Senders: consecutive cells or index
+		array
+	----------------------------------------------*/
 
-	/*-----------------------------------------
-		   Read Output-Cell Indices
-	------------------------------------------*/
+	firstSender.assign( order.size(), noSender );
+	senderStart.assign( order.size() + 1, 0 );
+	senders.clear();
+	sends.assign( order.size(), 0 );
 
-	while ( !f.eof() )
+	for ( unsigned int i = 0; i < order.size(); i++ )
 	{
-		std::string tmpStr;
-		f >> tmpStr;
-		outputStrList.push_back( tmpStr );
-		if ( tmpStr == "</outputs>" ) break;
-	}
+		unsigned int begin = weightStart[ i ];
+		unsigned int end = weightStart[ i + 1 ];
 
+		bool consecutive = begin < end;
 
-	if ( outputStrList[ 0 ] != "<outputs>" )
-	{
-		std::cerr << "Error: Output section missing!" << std::endl;
-		return false;
+		for ( unsigned int e = begin + 1; e < end && consecutive; e++ )
+		{
+			consecutive = edgeSenders[ e ] == edgeSenders[ begin ] + ( e - begin );
+		}
+
+		if ( consecutive )
+		{
+			firstSender[ i ] = edgeSenders[ begin ];
+		}
+		else
+		{
+			senders.insert( senders.end(), edgeSenders.begin() + begin, edgeSenders.begin() + end );
+		}
+
+		senderStart[ i + 1 ] = senders.size();
+
+		sends[ i ] = plan.rowStart[ order[ i ] ] < plan.rowStart[ order[ i ] + 1 ];
 	}
-	if ( outputStrList[ outputStrList.size() - 1 ] != "</outputs>" )
+
+	inputSlot.assign( numberOfCells, noSender );
+
+	for ( unsigned int i = 0; i < inputs.size(); i++ )
 	{
-		std::cerr << "Error: Missing </outputs>!" << std::endl;
-		return false;
+		inputSlot[ inputs[ i ] ] = i;
 	}
 
-	for ( unsigned int i = 1;i < outputStrList.size() - 1;i++ )
+	sums.assign( numberOfCells, 0.0f );
+	activations8.assign( numberOfCells, 0 );
+	activations.assign( numberOfCells, 0.0f );
+
+	weights8.clear();
+	weights16.clear();
+	scales.clear();
+
+	/*--------------------------------------------
+		FLOAT16
+	----------------------------------------------*/
+
+	if ( format == FLOAT16 )
 	{
-		int tmpVal = atoi( outputStrList[ i ].c_str() );
-		if (( outputStrList[ i ] != "0" ) && ( tmpVal == 0 ) )
+		weights16.resize( edgeWeights.size() );
+
+		for ( unsigned int e = 0; e < edgeWeights.size(); e++ )
 		{
-			std::cerr << "Error: Entry " << i << " in \"<outputs> </outputs>\" - Section is not a valid integer number!" << std::endl;
-			return false;
+			weights16[ e ] = floatToHalf( edgeWeights[ e ] );
 		}
-		outputList.push_back( tmpVal );
+
+		return true;
 	}
 
-	return true;
-}
+	/*--------------------------------------------
+		INT8: scale factors of the weights
+	----------------------------------------------*/
 
-bool NNet::readConnectionSection( std::ifstream &f )
-{
-	std::vector <std::string> connectionStrList;
-	/*-----------------------------------------
-		Read Connection Information
-	------------------------------------------*/
+	std::vector <double> maxWeight( order.size(), 0.0 );
 
-	while ( !f.eof() )
+	for ( unsigned int i = 0; i < order.size(); i++ )
 	{
-		std::string tmpStr;
-		f >> tmpStr;
-		if ( tmpStr[ 0 ] == '#' )
-		{
-			getline( f, tmpStr );
-		}
-		else
+		for ( unsigned int e = weightStart[ i ]; e < weightStart[ i + 1 ]; e++ )
 		{
-			connectionStrList.push_back( tmpStr );
+			maxWeight[ i ] = std::max( maxWeight[ i ], fabs( edgeWeights[ e ] ) );
 		}
-		if ( tmpStr == "</connections>" ) break;
 	}
 
-	if ( connectionStrList[ 0 ] != "<connections>" )
+	if ( granularity == PER_LAYER )
 	{
-		std::cerr << "Error: Connections section missing!" << std::endl;
-		return false;
+		// layer = longest distance from the input cells
+		std::vector <unsigned int> depth( order.size(), 0 );
+		std::vector <double> maxLayerWeight( order.size(), 0.0 );
+
+		for ( unsigned int i = 0; i < order.size(); i++ )
+		{
+			for ( unsigned int e = weightStart[ i ]; e < weightStart[ i + 1 ]; e++ )
+			{
+				depth[ i ] = std::max( depth[ i ], depth[ position[ edgeSenders[ e ] ] ] + 1 );
+			}
+			maxLayerWeight[ depth[ i ] ] = std::max( maxLayerWeight[ depth[ i ] ], maxWeight[ i ] );
+		}
+
+		for ( unsigned int i = 0; i < order.size(); i++ )
+		{
+			maxWeight[ i ] = maxLayerWeight[ depth[ i ] ];
+		}
 	}
-	if ( connectionStrList[ connectionStrList.size() - 1 ] != "</connections>" )
+
+	scales.resize( order.size() );
+	weights8.resize( edgeWeights.size() );
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
 	{
-		std::cerr << "Error: Missing </connections>!" << std::endl;
-		return false;
+		double scale = maxWeight[ i ] > 0 ? maxWeight[ i ] / 127 : 1;
+
+		for ( unsigned int e = weightStart[ i ]; e < weightStart[ i + 1 ]; e++ )
+		{
+			double q = nearbyint( edgeWeights[ e ] / scale );
+			weights8[ e ] = ( signed char ) std::max( -127.0, std::min( 127.0, q ) );
+		}
+
+		scales[ i ] = ( float ) scale;
 	}
 
 	/*--------------------------------------------
-		Convert connectionList to
-		netList
+		INT8: scale factor of the activations
+	----------------------------------------------*/
 
-		Start with i = 1 because first
-		entry is <connections> tag.
+	double maxActivation = 1;
 
-		Stop with < connectionList.size() - 2
-		because size is one too much and
-		last entry is </conections> tag.
+	if ( samples != NULL && numberOfSamples > 0 )
+	{
+		NNetContext context( plan );
 
-		This concerns also most of the
-		following for-loops
-	----------------------------------------------*/
+		maxActivation = 0;
 
-	if (( connectionStrList.size() - 2 ) % 3 != 0 )
+		for ( unsigned int n = 0; n < numberOfSamples; n++ )
+		{
+			context.setInputs( samples + n * inputs.size() );
+			context.sendSignals();
+
+			for ( unsigned int i = 0; i < order.size(); i++ )
+			{
+				if ( !sends[ i ] ) continue;
+
+				maxActivation = std::max( maxActivation, fabs( activation( context.activation( order[ i ] ) ) ) );
+			}
+		}
+
+		if ( maxActivation == 0 ) maxActivation = 1;
+	}
+	else if ( activation.function() == Activation::RELU )
 	{
-		std::cerr << "Error: Wrong number of Entries in \"<connections> </connections>\" - Section!" << std::endl;
+		std::cerr << "Error: Calibration samples are required for relu!" << std::endl;
 		return false;
 	}
 
-	for ( unsigned int i = 1;i < connectionStrList.size() - 2;i += 3 )
+	activationScale = ( float ) ( maxActivation / 127 );
+
+	return true;
+}
+
+void QuantizedNNet::forwardInt8( const double *values )
+{
+	const float inverseScale = 1.0f / activationScale;
+
+	for ( unsigned int i = 0; i < order.size(); i++ )
 	{
-		int tmpVal = atoi( connectionStrList[ i ].c_str() );
-		if (( connectionStrList[ i ] != "0" ) && ( tmpVal == 0 ) )
+		const unsigned int cell = order[ i ];
+		const unsigned int begin = weightStart[ i ];
+		const unsigned int n = weightStart[ i + 1 ] - begin;
+
+		float sum = inputSlot[ cell ] != noSender ? ( float ) values[ inputSlot[ cell ] ] : 0.0f;
+
+		if ( n > 0 )
 		{
-			std::cerr << "Error: Entry " << i << " in \"<connections> </connections>\" - Section is not a valid integer number!" << std::endl;
-			return false;
+			const signed char *w = &weights8[ begin ];
+			int32_t acc = 0;
+
+			if ( firstSender[ i ] != noSender )
+			{
+				const signed char *x = &activations8[ firstSender[ i ] ];
+
+				#pragma omp simd reduction(+:acc)
+				for ( unsigned int k = 0; k < n; k++ )
+				{
+					acc += ( int32_t ) w[ k ] * ( int32_t ) x[ k ];
+				}
+			}
+			else
+			{
+				const unsigned int *s = &senders[ senderStart[ i ] ];
 
+				for ( unsigned int k = 0; k < n; k++ )
+				{
+					acc += ( int32_t ) w[ k ] * ( int32_t ) activations8[ s[ k ] ];
+				}
+			}
+
+			sum += ( float ) acc * scales[ i ] * activationScale;
 		}
-		tmpVal = atoi( connectionStrList[ i + 1 ].c_str() );
-		if (( connectionStrList[ i + 1 ] != "0" ) && ( tmpVal == 0 ) )
+
+		sums[ cell ] = sum;
+
+		if ( sends[ i ] )
 		{
-			std::cerr << "Error: Entry " << i + 1 << " in \"<connections> </connections>\" - Section is not a valid integer number!" << std::endl;
-			return false;
+			float q = nearbyintf( ( float ) activation( sum ) * inverseScale );
+			activations8[ cell ] = ( signed char ) std::max( -127.0f, std::min( 127.0f, q ) );
 		}
-		double tmpVal2 = atof( connectionStrList[ i + 2 ].c_str() );
-		if (( connectionStrList[ i + 2 ] != "0" ) && ( tmpVal2 == 0 ) )
+	}
+}
+
+void QuantizedNNet::forwardFloat16( const double *values )
+{
+	for ( unsigned int i = 0; i < order.size(); i++ )
+	{
+		const unsigned int cell = order[ i ];
+		const unsigned int begin = weightStart[ i ];
+		const unsigned int n = weightStart[ i + 1 ] - begin;
+
+		float sum = inputSlot[ cell ] != noSender ? ( float ) values[ inputSlot[ cell ] ] : 0.0f;
+
+		if ( n > 0 )
 		{
-			std::cerr << "Error: Entry " << i + 2 << " in \"<connections> </connections>\" - Section is not a valid floating point number!" << std::endl;
-			return false;
+			const unsigned short *w = &weights16[ begin ];
+			float acc = 0;
+
+			if ( firstSender[ i ] != noSender )
+			{
+				const float *x = &activations[ firstSender[ i ] ];
+
+				#pragma omp simd reduction(+:acc)
+				for ( unsigned int k = 0; k < n; k++ )
+				{
+					acc += halfToFloat( w[ k ] ) * x[ k ];
+				}
+			}
+			else
+			{
+				const unsigned int *s = &senders[ senderStart[ i ] ];
+
+				for ( unsigned int k = 0; k < n; k++ )
+				{
+					acc += halfToFloat( w[ k ] ) * activations[ s[ k ] ];
+				}
+			}
+
+			sum += acc;
 		}
 
-		// 		netConnection tmpConnection;
-		// 		tmpConnection(connectionStrList[ i ],connectionStrList[ i + 1 ],connectionStrList[ i + 2 ]);
-		connectionList.push_back( netConnection( connectionStrList[ i ], connectionStrList[ i + 1 ], connectionStrList[ i + 2 ] ) );
-	}
+		sums[ cell ] = sum;
 
-	return true;
+		if ( sends[ i ] )
+		{
+			activations[ cell ] = ( float ) activation( sum );
+		}
+	}
 }
 
-const int NNet::getNumberOfCells() const
+void QuantizedNNet::sendSignals( const double *inputs, double *outputs, unsigned int numberOfSamples )
 {
-	/*--------------------------------------------
-		Get number of cells
-	----------------------------------------------*/
+	const unsigned int numberOfInputs = this->inputs.size();
+	const unsigned int numberOfOutputs = this->outputs.size();
 
-	int numberOfCells = 0;
-
-	for ( unsigned int i = 0; i < connectionList.size();i++ )
+	for ( unsigned int n = 0; n < numberOfSamples; n++ )
 	{
-		if ( numberOfCells < connectionList[ i ].sender )
+		if ( _format == INT8 )
 		{
-			numberOfCells = connectionList[ i ].sender;
+			forwardInt8( inputs + n * numberOfInputs );
 		}
-		if ( numberOfCells < connectionList[ i ].receiver )
+		else
 		{
-			numberOfCells = connectionList[ i ].receiver;
+			forwardFloat16( inputs + n * numberOfInputs );
 		}
-	}
 
-	for ( unsigned int i = 0; i < inputList.size();i++ )
-	{
-		if ( numberOfCells < inputList[ i ] )
+		for ( unsigned int j = 0; j < numberOfOutputs; j++ )
 		{
-			numberOfCells = inputList[ i ];
+			outputs[ n * numberOfOutputs + j ] = sums[ this->outputs[ j ] ];
 		}
 	}
+}
 
-	for ( unsigned int i = 0; i < outputList.size();i++ )
+QuantizationReport QuantizedNNet::compare( const NNet &reference, const double *inputs, unsigned int numberOfSamples )
+{
+	QuantizationReport report;
+
+	const unsigned int numberOfInputs = this->inputs.size();
+	const unsigned int numberOfOutputs = this->outputs.size();
+
+	NNetContext context( reference );
+
+	std::vector <double> values( numberOfOutputs );
+
+	double sumError = 0;
+	double sumSquaredError = 0;
+	double maxReference = 0;
+	unsigned int agreements = 0;
+
+	for ( unsigned int n = 0; n < numberOfSamples; n++ )
 	{
-		if ( numberOfCells < outputList[ i ] )
+		context.setInputs( inputs + n * numberOfInputs );
+		context.sendSignals();
+
+		sendSignals( inputs + n * numberOfInputs, &values[ 0 ], 1 );
+
+		unsigned int best = 0;
+		unsigned int bestReference = 0;
+
+		for ( unsigned int j = 0; j < numberOfOutputs; j++ )
 		{
-			numberOfCells = outputList[ i ];
+			double error = fabs( values[ j ] - context.output( j ) );
+
+			report.maxError = std::max( report.maxError, error );
+			sumError += error;
+			sumSquaredError += error * error;
+			maxReference = std::max( maxReference, fabs( context.output( j ) ) );
+
+			if ( values[ j ] > values[ best ] ) best = j;
+			if ( context.output( j ) > context.output( bestReference ) ) bestReference = j;
 		}
+
+		if ( best == bestReference ) agreements++;
 	}
 
-	return numberOfCells + 1;
+	unsigned int numberOfValues = numberOfSamples * numberOfOutputs;
+
+	report.numberOfSamples = numberOfSamples;
+
+	if ( numberOfValues > 0 )
+	{
+		report.meanError = sumError / numberOfValues;
+		report.rmsError = sqrt( sumSquaredError / numberOfValues );
+		report.agreement = ( double ) agreements / numberOfSamples;
+	}
+
+	report.relativeError = maxReference > 0 ? report.maxError / maxReference : 0;
+
+	const NNetPlan &plan = reference.getPlan();
+
+	report.referenceBytes = plan.numberOfConnections() * ( sizeof( double ) + sizeof( unsigned int ) )
+	                        + plan.rowStart.size() * sizeof( unsigned int );
+	report.quantizedBytes = memoryUsage();
+
+	return report;
 }
 
-void NNet::generateCells( unsigned int numberOfCells )
+const QuantizedNNet::Format QuantizedNNet::format() const
 {
-	/*--------------------------------------------
-		Store cells in NNet::allCells
-	----------------------------------------------*/
+	return _format;
+}
 
-	//std::vector <Cell*> cellList;
+const unsigned int QuantizedNNet::numberOfInputs() const
+{
+	return inputs.size();
+}
 
-	for ( unsigned int i = 0;i < numberOfCells;i++ )
-	{
-		Cell *tmpCell = new Cell;
-		tmpCell->netIndex = i;
-		this->allCells.push_back( tmpCell );
-	}
+const unsigned int QuantizedNNet::numberOfOutputs() const
+{
+	return outputs.size();
+}
+
+const unsigned long QuantizedNNet::memoryUsage() const
+{
+	return ( weightStart.size() + firstSender.size() + senderStart.size() + senders.size() ) * sizeof( unsigned int )
+	       + weights8.size() * sizeof( signed char ) + weights16.size() * sizeof( unsigned short )
+	       + scales.size() * sizeof( float );
+}
+
+NNetInput::NNetInput( std::string fileName )
+{
+	// Specify file type and version
+	HeaderTag *header = new HeaderTag();
+	header->setFileType( "NNetInput-File" );
+	header->setVersion( 0.1 );
+
+	field = new DoubleField( "data" );
+
+	// Define format, i.e. add tags
+	addElement( header );
+	addElement( field );
+
+	load( fileName );
+}
+
+const double NNetInput::getValue( int i ) const
+{
+	return field->element( i )->getValue();
+}
+
+
+/*--------------------------------------------
+	Binary dataset format
+----------------------------------------------*/
+
+static const char datasetMagic[ 8 ] = { '#', 'N', 'N', 'e', 't', 'D', 'a', 't' };
+static const uint32_t datasetVersion = 1;
+
+struct NNetDatasetHeader
+{
+	char magic[ 8 ];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint64_t numberOfSamples;
+	uint64_t numberOfInputs;
+	uint64_t numberOfOutputs;
+	uint64_t inputOffset;
+	uint64_t targetOffset;
+	uint64_t fileSize;
+};
+
+// both matrices start at a cache line
+static uint64_t align64( uint64_t value )
+{
+	return ( value + 63 ) & ~( uint64_t ) 63;
 }
 
-void NNet::storeInputCells()
+NNetDataset::NNetDataset()
 {
-	/*--------------------------------------------
-		Store input cells
-	----------------------------------------------*/
+	memory = NULL;
+	mapping = NULL;
 
-	for ( unsigned int i = 0;i < inputList.size();i++ )
-	{
-		this->inputCells.push_back( this->allCells[ inputList[ i ] ] );
-	}
+	create( 0, 0 );
 }
 
-void NNet::storeOutputCells()
+NNetDataset::NNetDataset( unsigned int numberOfInputs, unsigned int numberOfOutputs )
 {
-	/*--------------------------------------------
-		Store output cells
-	----------------------------------------------*/
+	memory = NULL;
+	mapping = NULL;
 
-	for ( unsigned int i = 0;i < outputList.size();i++ )
-	{
-		this->outputCells.push_back( this->allCells[ outputList[ i ] ] );
-	}
+	create( numberOfInputs, numberOfOutputs );
 }
 
-void NNet::connectCells()
+NNetDataset::~NNetDataset()
 {
-	/*--------------------------------------------
-		Connect cells
-	----------------------------------------------*/
+	close();
+}
 
-	for ( unsigned int i = 0; i < connectionList.size();i++ )
+void NNetDataset::create( unsigned int numberOfInputs, unsigned int numberOfOutputs )
+{
+	close();
+
+	inputsPerSample = numberOfInputs;
+	outputsPerSample = numberOfOutputs;
+}
+
+void NNetDataset::close()
+{
+	if ( mapping != NULL )
 	{
-		this->allCells[ connectionList[ i ].sender ] ->connect( this->allCells[ connectionList[ i ].receiver ], connectionList[ i ].weight );
-//  		std::cout << "Connect: " << connectionList[ i ].sender << " -> " << connectionList[ i ].receiver << std::endl;
+		munmap( mapping, mappingSize );
 	}
+
+	free( memory );
+
+	memory = NULL;
+	capacity = 0;
+	mapping = NULL;
+	mappingSize = 0;
+	samples = 0;
+	inputData = NULL;
+	targetData = NULL;
 }
 
-bool NNet::generateNet( std::vector<int>inputs, std::vector<int>outputs, std::vector<netConnection>connections )
+void NNetDataset::reserve( unsigned int numberOfSamples )
 {
-	this->inputList = inputs;
-	this->outputList = outputs;
-	this->connectionList = connections;
+	if ( mapping != NULL || numberOfSamples <= capacity ) return;
 
-	int numberOfCells = this->getNumberOfCells();
+	/*-----------------------------------------
+		  New block with both matrices
+	------------------------------------------*/
 
-	this->generateCells( numberOfCells );
+	size_t targetOffset = align64( ( uint64_t ) numberOfSamples * inputsPerSample * sizeof( double ) );
+	size_t bytes = targetOffset + ( size_t ) numberOfSamples * outputsPerSample * sizeof( double );
 
-	this->storeInputCells();
+	void *block = NULL;
 
-	this->storeOutputCells();
+	if ( posix_memalign( &block, 64, std::max( bytes, ( size_t ) 64 ) ) != 0 )
+	{
+		std::cerr << "Error: Not enough memory!" << std::endl;
+		return;
+	}
 
-	this->connectCells();
+	double *newInputs = ( double* ) block;
+	double *newTargets = ( double* ) ( ( char* ) block + targetOffset );
 
-	return true;
-}
+	if ( samples > 0 )
+	{
+		std::memcpy( newInputs, inputData, ( size_t ) samples * inputsPerSample * sizeof( double ) );
+		std::memcpy( newTargets, targetData, ( size_t ) samples * outputsPerSample * sizeof( double ) );
+	}
 
+	free( memory );
 
+	memory = newInputs;
+	capacity = numberOfSamples;
+	inputData = newInputs;
+	targetData = newTargets;
+}
 
-bool NNet::loadNet( std::string fileName )
+bool NNetDataset::addSample( const double *inputs, const double *targets )
 {
-	// List with header informations
-	std::vector <std::string> headerList;
-
-	// The file stream
-	std:: ifstream f( fileName.c_str() );
-
-	if ( !f )
+	if ( mapping != NULL )
 	{
-		std::cerr << "Error: File doesn't exist!" << std::endl;
+		std::cerr << "Error: Dataset is read-only!" << std::endl;
 		return false;
-	};
+	}
 
-	if ( !this->readHeaderSection( f, headerList ) ) return false;
+	if ( samples == capacity )
+	{
+		reserve( std::max( 2 * capacity, 1024u ) );
 
-	if ( !this->readInputSection( f ) ) return false;
+		if ( samples == capacity ) return false;
+	}
 
-	if ( !this->readOutputSection( f ) ) return false;
+	double *row = memory + ( size_t ) samples * inputsPerSample;
+	std::copy( inputs, inputs + inputsPerSample, row );
 
-	if ( !this->readConnectionSection( f ) ) return false;
+	row = const_cast<double*> ( targetData ) + ( size_t ) samples * outputsPerSample;
 
-	f.close();
+	if ( targets != NULL )
+	{
+		std::copy( targets, targets + outputsPerSample, row );
+	}
+	else
+	{
+		std::fill( row, row + outputsPerSample, 0.0 );
+	}
 
-	generateNet( inputList, outputList, connectionList );
+	samples++;
 
 	return true;
 }
 
-void NNet::writeHeaderSection( std::ofstream &f, double version ) const
+bool NNetDataset::addSample( const NNetInput &input, const double *targets )
 {
-	/*-----------------------------------------
-		  Write Header-Section
-	------------------------------------------*/
+	std::vector <double> values( inputsPerSample );
 
-	f << "<header>\n";
-	f << "#NNet-File " << version;
-	f << "\n</header>\n";
+	for ( unsigned int i = 0; i < inputsPerSample; i++ )
+	{
+		values[ i ] = input.getValue( i );
+	}
 
+	return addSample( values.empty() ? NULL : &values[ 0 ], targets );
 }
 
-void NNet::writeInputSection( std::ofstream &f ) const
+bool NNetDataset::loadData( std::string fileName, unsigned int numberOfInputs, unsigned int numberOfOutputs )
 {
-	/*-----------------------------------------
-		  Write Input-Section
-	------------------------------------------*/
+	create( numberOfInputs, numberOfOutputs );
 
-	f << "<inputs>\n";
+	TextReader reader;
 
-	for ( unsigned int i = 0;i < this->inputList.size();i++ )
+	if ( !reader.open( fileName ) )
 	{
-		f << this->inputList[ i ] << " ";
+		std::cerr << "Error: File doesn't exist!" << std::endl;
+		return false;
 	}
 
-	f << "\n</inputs>\n";
-
-}
+	if ( numberOfInputs + numberOfOutputs == 0 )
+	{
+		std::cerr << "Error: Samples without values!" << std::endl;
+		return false;
+	}
 
-void NNet::writeOutputSection( std::ofstream &f ) const
-{
 	/*-----------------------------------------
-		  Write Output-Section
+		  One row after the other, the values
+		  are parsed in place
 	------------------------------------------*/
 
-	f << "<outputs>\n";
+	std::vector <double> row( numberOfInputs + numberOfOutputs );
+	unsigned int column = 0;
 
-	for ( unsigned int i = 0;i < this->outputList.size();i++ )
+	while ( reader.next() )
 	{
-		f << this->outputList[ i ] << " ";
+		if ( reader.token() [ 0 ] == '#' )
+		{
+			reader.skipLine();
+			continue;
+		}
+
+		if ( !reader.toDouble( row[ column ] ) )
+		{
+			std::cerr << "Error: File is corrupted!" << std::endl;
+			close();
+			return false;
+		}
+
+		if ( ++column == row.size() )
+		{
+			if ( !addSample( &row[ 0 ], numberOfOutputs > 0 ? &row[ numberOfInputs ] : NULL ) )
+			{
+				close();
+				return false;
+			}
+
+			column = 0;
+		}
 	}
 
-	f << "\n</outputs>\n";
+	if ( column != 0 )
+	{
+		std::cerr << "Error: File is corrupted!" << std::endl;
+		close();
+		return false;
+	}
+
+	return true;
 }
 
-void NNet::writeConnectionSection( std::ofstream &f ) const
+bool NNetDataset::saveBinaryData( std::string fileName ) const
 {
 	/*-----------------------------------------
-		  Write Connection-Section
+		  Layout of the file
 	------------------------------------------*/
 
-	f << "<connections>\n";
+	NNetDatasetHeader header;
 
-	int weightIndex = 0;
-	int senderTmp = 0;
+	std::memset( &header, 0, sizeof( header ) );
+	std::memcpy( header.magic, datasetMagic, 8 );
+	header.version = datasetVersion;
+	header.byteOrder = byteOrderMark;
+	header.numberOfSamples = samples;
+	header.numberOfInputs = inputsPerSample;
+	header.numberOfOutputs = outputsPerSample;
 
-	for ( unsigned int i = 0;i < this->connectionList.size();i++ )
-	{
-		int sender = this->connectionList[ i ].sender;
-		int receiver = this->connectionList[ i ].receiver;
+	uint64_t inputBytes = 8 * header.numberOfSamples * header.numberOfInputs;
+	uint64_t targetBytes = 8 * header.numberOfSamples * header.numberOfOutputs;
 
-		if ( senderTmp != sender )
-		{
-			weightIndex = 0;
-			senderTmp = sender;
-		}
+	header.inputOffset = align64( sizeof( header ) );
+	header.targetOffset = align64( header.inputOffset + inputBytes );
+	header.fileSize = header.targetOffset + targetBytes;
 
-		f << sender << " " << receiver
-		<< " " << this->allCells[ sender ] ->weights[ weightIndex ] << std::endl;
+	/*-----------------------------------------
+		  Write sections
+	------------------------------------------*/
 
-// 		std::cout << sender << " " << receiver
-// 		<< " " << this->allCells[ sender ] ->weights[ weightIndex ] << std::endl;
+	std::ofstream f( fileName.c_str(), std::ios::out | std::ios::binary );
 
-		weightIndex++;
+	if ( !f )
+	{
+		std::cerr << "Error: Can't write file!" << std::endl;
+		return false;
 	}
 
-	f << "</connections>\n";
-}
+	const char padding[ 64 ] = { 0 };
 
-bool NNet::saveNet( std::string fileName )
-{
+	f.write( ( const char* ) &header, sizeof( header ) );
 
-	// The file stream
-	std::ofstream f( fileName.c_str(), std::ios::out );
+	f.write( padding, header.inputOffset - sizeof( header ) );
+	f.write( ( const char* ) inputData, inputBytes );
 
-	this->writeHeaderSection( f, 0.1 );
-	this->writeInputSection( f );
-	this->writeOutputSection( f );
-	this->writeConnectionSection( f );
+	f.write( padding, header.targetOffset - header.inputOffset - inputBytes );
+	f.write( ( const char* ) targetData, targetBytes );
 
 	f.close();
 
+	if ( !f )
+	{
+		std::cerr << "Error: Can't write file!" << std::endl;
+		return false;
+	}
+
 	return true;
 }
 
-Cell * NNet::input( int i )
+bool NNetDataset::openBinaryData( std::string fileName )
 {
-	return this->inputCells[ i ];
-}
+	close();
 
-Cell * NNet::output( int i )
-{
-	return this->outputCells[ i ];
-}
+	int fileDescriptor = ::open( fileName.c_str(), O_RDONLY );
 
-const int NNet::numberOfConnections() const
-{
-	return connectionList.size();
-}
+	if ( fileDescriptor < 0 )
+	{
+		std::cerr << "Error: File doesn't exist!" << std::endl;
+		return false;
+	}
 
-void NNet::setWeights( std::vector<double>newWeights )
-{
-	int indexOffset = 0;
+	struct stat status;
 
-	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+	if ( fstat( fileDescriptor, &status ) != 0 || status.st_size < ( off_t ) sizeof( NNetDatasetHeader ) )
 	{
-		for ( unsigned int j = 0; j < this->allCells[ i ] ->weights.size(); j++ )
-		{
-			this->allCells[ i ] ->weights[ j ] = newWeights[ j + indexOffset ];
-		}
-		indexOffset += this->allCells[ i ] ->weights.size();
+		std::cerr << "Error: Unknown file format!" << std::endl;
+		::close( fileDescriptor );
+		return false;
 	}
-}
 
-NNet::~ NNet()
-{
-	//delete memory of all cells
-	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+	mappingSize = status.st_size;
+	mapping = mmap( NULL, mappingSize, PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+
+	::close( fileDescriptor );
+
+	if ( mapping == MAP_FAILED )
 	{
-		if ( allCells[i] != NULL )
-		{
-			delete allCells[ i ];
-			allCells[i] = NULL;
-		}
+		std::cerr << "Error: Can't map file!" << std::endl;
+		mapping = NULL;
+		mappingSize = 0;
+		return false;
 	}
-}
 
-void NNet::setMemory( bool value )
-{
-	enableMemory = value;
-}
+	/*-----------------------------------------
+	   Error Handling for Header Information
+	------------------------------------------*/
 
-void NNet::reset()
-{
-	//Save activation values of all input cells
-	std::vector <double> tmpActivations;
+	const NNetDatasetHeader *header = ( const NNetDatasetHeader* ) mapping;
 
-	for ( unsigned int i = 0; i < this->inputCells.size();i++ )
+	bool valid = true;
+
+	if ( std::memcmp( header->magic, datasetMagic, 8 ) != 0 )
 	{
-		tmpActivations.push_back( this->inputCells[ i ] ->finalOutput() );
+		std::cerr << "Error: Unknown file format!" << std::endl;
+		valid = false;
 	}
-
-	// Reset activations of all cells
-	for ( unsigned int i = 0; i < this->allCells.size();i++ )
+	else if ( header->version > datasetVersion )
 	{
-		this->allCells[ i ] ->firstInput( 0 );
+		std::cerr << "Error: File is made by newer version of this program!" << std::endl;
+		valid = false;
+	}
+	else if ( header->byteOrder != byteOrderMark )
+	{
+		std::cerr << "Error: File has wrong byte order!" << std::endl;
+		valid = false;
+	}
+	else if ( header->fileSize > mappingSize ||
+	          header->numberOfSamples >= 0xffffffffu ||
+	          header->numberOfInputs >= 0xffffffffu || header->numberOfOutputs >= 0xffffffffu ||
+	          header->inputOffset % 8 || header->targetOffset % 8 ||
+	          ( header->numberOfInputs > 0 && header->numberOfSamples > mappingSize / 8 / header->numberOfInputs ) ||
+	          ( header->numberOfOutputs > 0 && header->numberOfSamples > mappingSize / 8 / header->numberOfOutputs ) ||
+	          header->inputOffset + 8 * header->numberOfSamples * header->numberOfInputs > header->fileSize ||
+	          header->targetOffset + 8 * header->numberOfSamples * header->numberOfOutputs > header->fileSize )
+	{
+		std::cerr << "Error: File is corrupted!" << std::endl;
+		valid = false;
 	}
 
-	//restore Activation of output cells as they are
-	//resetted if memory disabled
-	for ( unsigned int i = 0; i < this->inputCells.size();i++ )
+	if ( !valid )
 	{
-		this->inputCells[ i ] ->firstInput( tmpActivations[ i ] ) ;
+		close();
+		return false;
 	}
+
+	samples = header->numberOfSamples;
+	inputsPerSample = header->numberOfInputs;
+	outputsPerSample = header->numberOfOutputs;
+
+	inputData = ( const double* ) ( ( const char* ) mapping + header->inputOffset );
+	targetData = ( const double* ) ( ( const char* ) mapping + header->targetOffset );
+
+	return true;
 }
 
-void NNet::setInputs( NNetInput &input )
+bool NNetDataset::convertData( std::string textFileName, std::string binaryFileName,
+                               unsigned int numberOfInputs, unsigned int numberOfOutputs )
 {
-	for ( int i = 0; i < inputCells.size();i++ )
-	{
-		inputCells[i]->firstInput( input.getValue( i ) );
-	}
+	NNetDataset data;
+
+	if ( !data.loadData( textFileName, numberOfInputs, numberOfOutputs ) ) return false;
+
+	return data.saveBinaryData( binaryFileName );
 }
 
-NNetInput::NNetInput( std::string fileName )
+const unsigned int NNetDataset::numberOfSamples() const
 {
-	// Specify file type and version
-	HeaderTag *header = new HeaderTag();
-	header->setFileType( "NNetInput-File" );
-	header->setVersion( 0.1 );
+	return samples;
+}
 
-	field = new DoubleField( "data" );
+const unsigned int NNetDataset::numberOfInputs() const
+{
+	return inputsPerSample;
+}
 
-	// Define format, i.e. add tags
-	addElement( header );
-	addElement( field );
+const unsigned int NNetDataset::numberOfOutputs() const
+{
+	return outputsPerSample;
+}
 
-	load( fileName );
+const bool NNetDataset::isMapped() const
+{
+	return mapping != NULL;
 }
 
-const double NNetInput::getValue( int i ) const
+const double *NNetDataset::inputs() const
 {
-	return field->element( i )->getValue();
+	return inputData;
 }
 
+const double *NNetDataset::inputs( unsigned int n ) const
+{
+	return inputData + ( size_t ) n * inputsPerSample;
+}
+
+const double *NNetDataset::targets() const
+{
+	return targetData;
+}
+
+const double *NNetDataset::targets( unsigned int n ) const
+{
+	return targetData + ( size_t ) n * outputsPerSample;
+}
@@ -65,3 +65,85 @@ int randInt( int x, int y )
 {
 	return rand() % ( y - x + 1 ) + x;
 }
+
+/**
+ * Constructor.
+ *
+ * @param seed seed value
+ * @param streamIndex index of the sub stream
+ */
+RandStream::RandStream( unsigned long seed, unsigned long streamIndex )
+{
+	this->seed( seed, streamIndex );
+}
+
+/**
+ * Reinitializes the stream.
+ *
+ * Seed and stream index are scrambled (splitmix64 finalizer), so that
+ * neighbouring seeds and indices give uncorrelated sequences.
+ * @param seed seed value
+ * @param streamIndex index of the sub stream
+ */
+void RandStream::seed( unsigned long seed, unsigned long streamIndex )
+{
+	unsigned long long z = ( unsigned long long ) seed * 0x9E3779B97F4A7C15ULL
+	                       + ( unsigned long long ) streamIndex + 0x632BE59BD9B4E019ULL;
+
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+	z = z ^ ( z >> 31 );
+
+	// xorshift must not be initialized with zero
+	state = ( z == 0 ) ? 0x2545F4914F6CDD1DULL : z;
+}
+
+/**
+ * Returns a raw random number.
+ *
+ * xorshift64* generator, upper 32 bits are returned.
+ * @return value ( 0 <= value < 2^32 )
+ */
+unsigned long RandStream::next()
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return ( unsigned long ) ( ( state * 0x2545F4914F6CDD1DULL ) >> 32 );
+}
+
+/**
+ * Returns a random number.
+ *
+ * @return double value ( 0 <= value < 1 )
+ */
+double RandStream::randFloat()
+{
+	return next() / 4294967296.0;
+}
+
+/**
+ * Returns a random number.
+ *
+ * @param x minimum random value
+ * @param y maximum random value
+ * @return double value ( x <= value <= y )
+ */
+double RandStream::randFloat( int x, int y )
+{
+	unsigned long tmp = next();
+	y -= 1;
+	return ( int ) ( tmp % ( unsigned long ) ( y - x + 1 ) ) + x + tmp / 4294967296.0;
+}
+
+/**
+ * Returns a random number.
+ *
+ * @param x minimum random value
+ * @param y maximum random value
+ * @return integer value ( x <= value <= y )
+ */
+int RandStream::randInt( int x, int y )
+{
+	return ( int ) ( next() % ( unsigned long ) ( y - x + 1 ) ) + x;
+}
@@ -0,0 +1,283 @@
+/***************************************************************************
+*   Copyright (C) 2006 by Michael Hoffer                                  *
+*   info@michaelhoffer.de                                                 *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU Library General Public License as       *
+*   published by the Free Software Foundation; either version 2 of the    *
+*   License, or (at your option) any later version.                       *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU Library General Public     *
+*   License along with this program; if not, write to the                 *
+*   Free Software Foundation, Inc.,                                       *
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+***************************************************************************/
+
+#include "libsurrogate.h"
+#include <cmath>
+#include <librand.h>
+#include <genutil.h>
+
+NNetSurrogate::NNetSurrogate( unsigned int numberOfHiddenCells, unsigned int maxSamples,
+                              double ridge, unsigned long seed )
+{
+	this->numberOfGenes = 0;
+	this->numberOfHiddenCells = numberOfHiddenCells;
+	this->maxSamples = maxSamples;
+	this->ridge = ridge;
+	this->seed = seed;
+
+	nextSample = 0;
+	targetMean = 0;
+	isTrained = false;
+}
+
+void NNetSurrogate::createNet( unsigned int numberOfGenes )
+{
+	/*--------------------------------------------
+		Input cells 0 .. numberOfGenes (the last
+		one is the bias cell), followed by the
+		hidden cells and the output cell
+	----------------------------------------------*/
+
+	this->numberOfGenes = numberOfGenes;
+
+	unsigned int numberOfInputs = numberOfGenes + 1;
+
+	std::vector<int> layerSize;
+	layerSize.push_back( numberOfHiddenCells );
+
+	net.createNet( numberOfInputs, 1, layerSize );
+
+	RandStream stream( seed );
+
+	// inputs are sigmoid values in (0,1), keep the hidden activations
+	// away from saturation
+	double range = 4.0 / sqrt( ( double ) numberOfInputs );
+
+	weights.resize( net.numberOfConnections() );
+
+	for ( unsigned int i = 0; i < numberOfInputs * numberOfHiddenCells; i++ )
+	{
+		weights[ i ] = ( 2 * stream.randFloat() - 1 ) * range;
+	}
+
+	for ( unsigned int i = numberOfInputs * numberOfHiddenCells; i < weights.size(); i++ )
+	{
+		weights[ i ] = 0;
+	}
+
+	net.setWeights( weights );
+
+	mean.assign( numberOfGenes, 0 );
+	scale.assign( numberOfGenes, 1 );
+}
+
+void NNetSurrogate::addSample( const std::vector <double> &genes, double fitness )
+{
+	if ( numberOfGenes == 0 )
+	{
+		createNet( genes.size() );
+	}
+
+	GEN_ASSERT( genes.size() == numberOfGenes, 0 );
+
+	if ( genes.size() != numberOfGenes ) return;
+
+	if ( samples.size() < maxSamples )
+	{
+		samples.push_back( genes );
+		targets.push_back( fitness );
+	}
+	else
+	{
+		samples[ nextSample ] = genes;
+		targets[ nextSample ] = fitness;
+		nextSample = ( nextSample + 1 ) % maxSamples;
+	}
+}
+
+void NNetSurrogate::sendSignals( const std::vector <double> &genes )
+{
+	for ( unsigned int i = 0; i < numberOfGenes; i++ )
+	{
+		net.input( i ) ->firstInput( ( genes[ i ] - mean[ i ] ) * scale[ i ] );
+	}
+
+	// bias
+	net.input( numberOfGenes ) ->firstInput( 1 );
+
+	net.sendSignals();
+}
+
+void NNetSurrogate::train()
+{
+	unsigned int n = samples.size();
+	unsigned int h = numberOfHiddenCells;
+
+	if ( n == 0 ) return;
+
+	/*--------------------------------------------
+		Normalization of genes and targets
+	----------------------------------------------*/
+
+	for ( unsigned int j = 0; j < numberOfGenes; j++ )
+	{
+		double sum = 0;
+		double sqrSum = 0;
+
+		for ( unsigned int i = 0; i < n; i++ )
+		{
+			sum += samples[ i ][ j ];
+			sqrSum += samples[ i ][ j ] * samples[ i ][ j ];
+		}
+
+		mean[ j ] = sum / n;
+
+		double variance = sqrSum / n - mean[ j ] * mean[ j ];
+
+		scale[ j ] = variance > 1e-12 ? 1 / sqrt( variance ) : 1;
+	}
+
+	targetMean = 0;
+
+	for ( unsigned int i = 0; i < n; i++ )
+	{
+		targetMean += targets[ i ];
+	}
+
+	targetMean /= n;
+
+	/*--------------------------------------------
+		Normal equations
+		( H^T H + ridge * n * I ) w = H^T y
+	----------------------------------------------*/
+
+	std::vector <double> a( h * h, 0 );
+	std::vector <double> b( h, 0 );
+	std::vector <double> hidden( h );
+
+	unsigned int firstHiddenCell = numberOfGenes + 1;
+
+	for ( unsigned int i = 0; i < n; i++ )
+	{
+		sendSignals( samples[ i ] );
+
+		for ( unsigned int j = 0; j < h; j++ )
+		{
+			hidden[ j ] = net.allCells[ firstHiddenCell + j ] ->output();
+		}
+
+		double y = targets[ i ] - targetMean;
+
+		for ( unsigned int j = 0; j < h; j++ )
+		{
+			b[ j ] += hidden[ j ] * y;
+
+			for ( unsigned int k = 0; k <= j; k++ )
+			{
+				a[ j * h + k ] += hidden[ j ] * hidden[ k ];
+			}
+		}
+	}
+
+	for ( unsigned int j = 0; j < h; j++ )
+	{
+		a[ j * h + j ] += ridge * n;
+	}
+
+	/*--------------------------------------------
+		Cholesky decomposition (lower triangle)
+	----------------------------------------------*/
+
+	for ( unsigned int j = 0; j < h; j++ )
+	{
+		double d = a[ j * h + j ];
+
+		for ( unsigned int k = 0; k < j; k++ )
+		{
+			d -= a[ j * h + k ] * a[ j * h + k ];
+		}
+
+		if ( d <= 0 )
+		{
+			std::cerr << "Error: Surrogate training failed (matrix not positive definite)!" << std::endl;
+			return;
+		}
+
+		a[ j * h + j ] = sqrt( d );
+
+		for ( unsigned int i = j + 1; i < h; i++ )
+		{
+			double v = a[ i * h + j ];
+
+			for ( unsigned int k = 0; k < j; k++ )
+			{
+				v -= a[ i * h + k ] * a[ j * h + k ];
+			}
+
+			a[ i * h + j ] = v / a[ j * h + j ];
+		}
+	}
+
+	// forward substitution
+	for ( unsigned int j = 0; j < h; j++ )
+	{
+		double v = b[ j ];
+
+		for ( unsigned int k = 0; k < j; k++ )
+		{
+			v -= a[ j * h + k ] * b[ k ];
+		}
+
+		b[ j ] = v / a[ j * h + j ];
+	}
+
+	// backward substitution
+	for ( int j = h - 1; j >= 0; j-- )
+	{
+		double v = b[ j ];
+
+		for ( unsigned int k = j + 1; k < h; k++ )
+		{
+			v -= a[ k * h + j ] * b[ k ];
+		}
+
+		b[ j ] = v / a[ j * h + j ];
+	}
+
+	/*--------------------------------------------
+		Hidden cells are followed by the output
+		cell, their weights are stored at the end
+	----------------------------------------------*/
+
+	unsigned int offset = ( numberOfGenes + 1 ) * h;
+
+	for ( unsigned int j = 0; j < h; j++ )
+	{
+		weights[ offset + j ] = b[ j ];
+	}
+
+	net.setWeights( weights );
+
+	isTrained = true;
+}
+
+double NNetSurrogate::predict( const std::vector <double> &genes )
+{
+	if ( !isTrained || genes.size() != numberOfGenes ) return targetMean;
+
+	sendSignals( genes );
+
+	return net.output( 0 ) ->finalOutput() + targetMean;
+}
+
+const bool NNetSurrogate::trained() const
+{
+	return isTrained;
+}
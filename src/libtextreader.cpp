@@ -0,0 +1,343 @@
+/***************************************************************************
+*   Copyright (C) 2006 by Michael Hoffer                                  *
+*   info@michaelhoffer.de                                                 *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU Library General Public License as       *
+*   published by the Free Software Foundation; either version 2 of the    *
+*   License, or (at your option) any later version.                       *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU Library General Public     *
+*   License along with this program; if not, write to the                 *
+*   Free Software Foundation, Inc.,                                       *
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+***************************************************************************/
+
+#include "libtextreader.h"
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+
+static inline bool isSpace( char c )
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool isDigit( char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+TextReader::TextReader( unsigned int bufferSize )
+{
+	file = NULL;
+	endOfFile = true;
+	capacity = bufferSize > 0 ? bufferSize : 1;
+	buffer.resize( capacity + 1 );
+	position = 0;
+	end = 0;
+	tokenBegin = 0;
+	tokenLength = 0;
+	lineEnd = false;
+	buffer[ 0 ] = '\0';
+}
+
+TextReader::~ TextReader()
+{
+	close();
+}
+
+bool TextReader::open( const std::string &fileName )
+{
+	close();
+
+	file = fopen( fileName.c_str(), "rb" );
+
+	if ( file == NULL ) return false;
+
+	endOfFile = false;
+	position = 0;
+	end = 0;
+	tokenBegin = 0;
+	tokenLength = 0;
+	lineEnd = false;
+
+	return true;
+}
+
+void TextReader::close()
+{
+	if ( file != NULL )
+	{
+		fclose( file );
+		file = NULL;
+	}
+
+	endOfFile = true;
+}
+
+bool TextReader::fill()
+{
+	if ( endOfFile ) return false;
+
+	/*--------------------------------------------
+		Keep the unread part
+	----------------------------------------------*/
+
+	if ( position > 0 )
+	{
+		std::memmove( &buffer[ 0 ], &buffer[ position ], end - position );
+		end -= position;
+		position = 0;
+	}
+
+	// a single token fills the whole buffer
+	if ( end == capacity )
+	{
+		capacity *= 2;
+		buffer.resize( capacity + 1 );
+	}
+
+	size_t bytes = fread( &buffer[ end ], 1, capacity - end, file );
+
+	if ( bytes < capacity - end ) endOfFile = true;
+
+	end += bytes;
+
+	return bytes > 0;
+}
+
+bool TextReader::next()
+{
+	/*--------------------------------------------
+		Skip whitespace
+	----------------------------------------------*/
+
+	for ( ;; )
+	{
+		while ( position < end && isSpace( buffer[ position ] ) ) position++;
+
+		if ( position < end ) break;
+
+		if ( !fill() )
+		{
+			tokenLength = 0;
+			buffer[ tokenBegin = 0 ] = '\0';
+			return false;
+		}
+	}
+
+	/*--------------------------------------------
+		Find the end of the token, the buffer is
+		refilled if it ends inside the token
+	----------------------------------------------*/
+
+	size_t scan = position;
+
+	for ( ;; )
+	{
+		while ( scan < end && !isSpace( buffer[ scan ] ) ) scan++;
+
+		if ( scan < end ) break;
+
+		size_t offset = scan - position;
+
+		if ( !fill() ) break;
+
+		scan = position + offset;
+	}
+
+	tokenBegin = position;
+	tokenLength = scan - position;
+
+	lineEnd = scan < end && buffer[ scan ] == '\n';
+	position = scan < end ? scan + 1 : scan;
+
+	// overwrites the separator (or uses the spare byte)
+	buffer[ scan ] = '\0';
+
+	return true;
+}
+
+void TextReader::skipLine()
+{
+	if ( lineEnd )
+	{
+		lineEnd = false;
+		return;
+	}
+
+	for ( ;; )
+	{
+		while ( position < end && buffer[ position ] != '\n' ) position++;
+
+		if ( position < end )
+		{
+			position++;
+			return;
+		}
+
+		if ( !fill() ) return;
+	}
+}
+
+const char *TextReader::token() const
+{
+	return &buffer[ tokenBegin ];
+}
+
+unsigned int TextReader::length() const
+{
+	return tokenLength;
+}
+
+bool TextReader::is( const char *str ) const
+{
+	return std::strcmp( token(), str ) == 0;
+}
+
+bool TextReader::toInt( int &value ) const
+{
+	const char *c = token();
+
+	bool negative = false;
+
+	if ( *c == '-' || *c == '+' )
+	{
+		negative = *c == '-';
+		c++;
+	}
+
+	if ( !isDigit( *c ) ) return false;
+
+	long long result = 0;
+
+	for ( ; isDigit( *c ); c++ )
+	{
+		result = result * 10 + ( *c - '0' );
+
+		if ( result > ( long long ) INT_MAX + 1 ) return false;
+	}
+
+	if ( *c != '\0' ) return false;
+
+	if ( negative ) result = -result;
+
+	if ( result > INT_MAX ) return false;
+
+	value = ( int ) result;
+
+	return true;
+}
+
+bool TextReader::toDouble( double &value ) const
+{
+	/*--------------------------------------------
+		Fast path: if the decimal mantissa is
+		smaller than 2^53 and the decimal exponent
+		is at most 22, mantissa and power of ten
+		are exact doubles and one multiplication
+		or division gives the correctly rounded
+		result
+	----------------------------------------------*/
+
+	static const double powersOfTen[ 23 ] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const char *c = token();
+
+	bool negative = false;
+
+	if ( *c == '-' || *c == '+' )
+	{
+		negative = *c == '-';
+		c++;
+	}
+
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+
+	for ( ; isDigit( *c ); c++, digits++ )
+	{
+		if ( mantissa > 0 || *c != '0' ) significantDigits++;
+		mantissa = mantissa * 10 + ( *c - '0' );
+	}
+
+	if ( *c == '.' )
+	{
+		for ( c++; isDigit( *c ); c++, digits++ )
+		{
+			if ( mantissa > 0 || *c != '0' ) significantDigits++;
+			mantissa = mantissa * 10 + ( *c - '0' );
+			exponent--;
+		}
+	}
+
+	bool fastPath = digits > 0 && significantDigits <= 19;
+
+	if ( fastPath && ( *c == 'e' || *c == 'E' ) )
+	{
+		c++;
+
+		bool negativeExponent = false;
+
+		if ( *c == '-' || *c == '+' )
+		{
+			negativeExponent = *c == '-';
+			c++;
+		}
+
+		if ( !isDigit( *c ) ) return false;
+
+		int e = 0;
+
+		for ( ; isDigit( *c ) && e < 10000; c++ ) e = e * 10 + ( *c - '0' );
+
+		exponent += negativeExponent ? -e : e;
+	}
+
+	if ( fastPath && *c == '\0' && mantissa <= ( 1ULL << 53 ) && exponent >= -22 && exponent <= 22 )
+	{
+		double result = ( double ) mantissa;
+
+		if ( exponent < 0 )
+		{
+			result /= powersOfTen[ -exponent ];
+		}
+		else
+		{
+			result *= powersOfTen[ exponent ];
+		}
+
+		value = negative ? -result : result;
+
+		return true;
+	}
+
+	/*--------------------------------------------
+		Everything else (many digits, large
+		exponents, inf, nan, ...)
+	----------------------------------------------*/
+
+	if ( tokenLength == 0 ) return false;
+
+	char *tokenEnd = NULL;
+
+	double result = strtod( token(), &tokenEnd );
+
+	if ( tokenEnd != token() + tokenLength ) return false;
+
+	value = result;
+
+	return true;
+}